@@ -0,0 +1,132 @@
+/*
+ * anc.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: halvard
+ *
+ *  Description: adaptive noise cancellation with a normalised LMS filter
+ *
+ *  A reference channel that carries the contaminating vibration (one of the
+ *  IMU's own channels, or an external signal such as a tachometer-derived
+ *  sine fed through anc_set_external_ref()) is filtered by one
+ *  arm_lms_norm_q15/q31 instance per accel axis. The filter output is the
+ *  estimate of the reference's contribution to that axis, and the error
+ *  (axis minus estimate) replaces the axis in imu_t. The reference axis
+ *  itself is left untouched.
+ *
+ *  Samples are processed one at a time, so the cleaned output has no extra
+ *  latency; CMSIS copies numTaps-1 state words per call for that.
+ *  Coefficient and state buffers live in the scratch arena while the stage
+ *  is enabled.
+ */
+
+#ifndef INC_ANC_H_
+#define INC_ANC_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "imu.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define ANC_MAX_TAPS        32
+
+// Float <-> fixed point scaling: full sensor range, so nothing clips
+#define ANC_ACCEL_FULL_SCALE (16.0f * 9.81f)    // [m/s^2]
+#define ANC_GYRO_FULL_SCALE  2000.0f            // [dps]
+#define ANC_EXT_FULL_SCALE   1.0f
+
+// Coefficients are stored as 1.31 (1.15) << ANC_POST_SHIFT, so the filter
+// can model a reference-to-axis gain of up to +-2^ANC_POST_SHIFT
+#define ANC_POST_SHIFT      2
+
+// Time constant of the DC tracker that keeps gravity and offsets out of the
+// filter, in samples (about 0.06 Hz corner at 100 Hz)
+#define ANC_DC_SAMPLES      256
+
+// Time constant of the convergence metrics, in samples (power of two)
+#define ANC_METRIC_SAMPLES  64
+// Residual/input power ratio that counts as converged (-10 dB)
+#define ANC_CONVERGED_RATIO 0.1f
+
+// AX..GZ are the imu_channel() indices
+typedef enum {
+    ANC_REF_AX = 0,
+    ANC_REF_AY,
+    ANC_REF_AZ,
+    ANC_REF_GX,
+    ANC_REF_GY,
+    ANC_REF_GZ,
+    ANC_REF_EXT,                // anc_set_external_ref()
+    ANC_REF_COUNT
+} anc_ref_t;
+
+/**
+ * @brief Settings applied by anc_enable(). Exposed as CLI variables.
+ */
+typedef struct {
+    float mu;                   // normalised step size, 0 < mu < 1
+    int taps;                   // 1..ANC_MAX_TAPS
+    int ref;                    // anc_ref_t
+    int qbits;                  // 15 or 31
+} anc_config_t;
+
+extern anc_config_t anc_config;
+
+typedef struct {
+    float in_rms;               // axis before cancellation (AC part)
+    float out_rms;              // axis after cancellation (AC part)
+    float atten_db;             // 20 log10(out_rms / in_rms)
+    uint32_t converged_at;      // sample count when out/in power first fell
+                                // below ANC_CONVERGED_RATIO, 0 if not yet
+} anc_axis_metrics_t;
+
+typedef struct {
+    anc_config_t active;        // settings of the running filters
+    uint32_t samples;
+    uint32_t cycles_last;       // DWT cycles of one anc_process() call
+    uint32_t cycles_min;
+    uint32_t cycles_max;
+    uint32_t cycles_avg;
+    anc_axis_metrics_t axis[3];
+    bool axis_active[3];        // false for the reference axis
+} anc_metrics_t;
+
+/**
+ * @brief (Re)starts the stage with anc_config, zeroing the coefficients.
+ * @return 0 on success, 1 if the config is invalid or the arena is busy
+ */
+int anc_enable(void);
+
+/**
+ * @brief Stops the stage and releases its scratch memory.
+ */
+void anc_disable(void);
+
+bool anc_enabled(void);
+
+/**
+ * @brief Latest value of the external reference (ANC_REF_EXT), in units
+ * of ANC_EXT_FULL_SCALE. Held until the next call.
+ */
+void anc_set_external_ref(float value);
+
+/**
+ * @brief Cancels the reference from the accel axes of one sample in place.
+ * Does nothing while the stage is disabled.
+ * @return 0
+ */
+int anc_process(imu_t *imu);
+
+void anc_get_metrics(anc_metrics_t *metrics);
+
+const char *anc_ref_name(int ref);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INC_ANC_H_ */
@@ -0,0 +1,97 @@
+/*
+ * autorange.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: halvard
+ *
+ *  Description: accelerometer and gyroscope full-scale auto-ranging
+ *
+ *  Watches how close each sample's raw counts come to saturation and
+ *  switches the ranges through imu_set_range(), which writes only the
+ *  config bytes that change:
+ *
+ *  - up: a sample at `up` of full scale or more moves one range up; a
+ *    clipped sample (-32768 or 32767 on any axis) goes straight to the
+ *    widest range, since its true size is unknown;
+ *  - down: once every sample for `hold_ms` would have stayed below `down`
+ *    of full scale at the next finer range, it moves one range down.
+ *
+ *  up > down keeps it from toggling. The defaults bring a resting sensor
+ *  (1 g on one axis) back to +-2 g. A switch is written right after a
+ *  read and applies from the next sample on; imu_process() tags every
+ *  sample with the range it was read at (imu_range_t, published with the
+ *  sample), so the scaling of each sample is exact across a switch.
+ *
+ *  Recordings have fixed ranges: while replaying only clips and dwell
+ *  are counted. With the FIFO enabled the backend refuses to switch (the
+ *  queued samples would be decoded at the new scale); refusals are
+ *  counted as failed.
+ */
+
+#ifndef INC_AUTORANGE_H_
+#define INC_AUTORANGE_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "imu.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define AUTORANGE_RANGES        4       // range codes 0..3
+
+/**
+ * @brief Settings, exposed as CLI variables and applied by autorange_enable().
+ */
+typedef struct {
+    bool accel;                 // auto-range the accelerometer
+    bool gyro;                  // auto-range the gyroscope
+    float up;                   // fraction of full scale that switches up
+    float down;                 // fraction of the finer full scale to switch down
+    int hold_ms;                // time below `down` before switching down
+    bool log;                   // print every switch
+} autorange_config_t;
+
+extern autorange_config_t autorange_config;
+
+typedef struct {
+    uint32_t samples;           // since enabled
+    uint8_t range;              // current range code
+    uint32_t switches;
+    uint32_t clips;             // clip events: runs of clipped samples
+    uint32_t clipped;           // clipped samples
+    uint32_t dwell[AUTORANGE_RANGES];   // samples read at each range
+} autorange_sensor_t;
+
+typedef struct {
+    autorange_sensor_t accel;
+    autorange_sensor_t gyro;
+    uint32_t failed;            // switches the backend refused
+    uint16_t rate_hz;           // sample rate, for dwell times
+} autorange_summary_t;
+
+/**
+ * @brief Starts auto-ranging with autorange_config from the current ranges.
+ * @return 0 on success, 1 if the config is invalid
+ */
+int autorange_enable(void);
+
+void autorange_disable(void);
+
+bool autorange_enabled(void);
+
+/**
+ * @brief Checks the sample imu_process() just read, switches if needed.
+ * @return 1 when a range was switched (for the next sample), 0 otherwise
+ */
+int autorange_process(const imu_t *imu);
+
+void autorange_get_summary(autorange_summary_t *summary);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INC_AUTORANGE_H_ */
@@ -0,0 +1,90 @@
+/*
+ * boot.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: halvard
+ *
+ *  Description: boot-phase timing from reset to the first sample
+ *
+ *  boot_start() is the first thing main() does: it starts DWT->CYCCNT from
+ *  0 (so micros() counts from there too), and every boot_mark() ends the
+ *  phase named after the call before it. Phases before SystemClock_Config()
+ *  run on the 8 MHz HSI, so each one is converted at the core clock it
+ *  started with (SystemCoreClock at the previous mark). The startup code
+ *  before main() (.data/.bss init, SystemInit) isn't covered.
+ *
+ *  Most of the boot is the MPU6050 waiting: the reset poll and the settle
+ *  time after it are 100+ ms of mpu6050_interface_delay_ms(). Init that
+ *  doesn't need the sensor is handed to boot_defer() and runs at the start
+ *  of the next such wait (boot_wait_ms()) instead of back to back with it;
+ *  the time it took is taken off the wait and shown as hidden.
+ */
+
+#ifndef INC_BOOT_H_
+#define INC_BOOT_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define BOOT_PHASES             8       // marks kept, later ones are dropped
+#define BOOT_JOBS               4       // deferred init jobs
+
+typedef struct {
+    const char *name;
+    uint32_t us;                // duration
+    uint32_t end_us;            // since boot_start()
+} boot_phase_t;
+
+/**
+ * @brief Starts the DWT counter from 0; call first in main().
+ */
+void boot_start(void);
+
+/**
+ * @brief Ends the phase since the previous mark. The name must be a literal.
+ */
+void boot_mark(const char *name);
+
+/**
+ * @brief Queues init work for the next sensor wait. Runs at the latest in
+ * boot_run_deferred().
+ */
+void boot_defer(void (*job)(void));
+
+/**
+ * @brief Blocking wait that runs the deferred jobs first and only waits for
+ * what is left (mpu6050_interface_delay_ms()).
+ */
+void boot_wait_ms(uint32_t ms);
+
+/**
+ * @brief Runs any deferred jobs no wait has picked up yet.
+ */
+void boot_run_deferred(void);
+
+/**
+ * @return 0 if the phase exists, 1 past the last mark
+ */
+int boot_get_phase(uint8_t index, boot_phase_t *phase);
+
+/**
+ * @brief Time from boot_start() to the last mark and deferred job time
+ * that ran inside sensor waits, us.
+ */
+void boot_get_total(uint32_t *total_us, uint32_t *hidden_us);
+
+/**
+ * @brief One line, "boot 312.4 ms: HAL_Init 0.1, clock 1.5, ..." without
+ * line end.
+ */
+void boot_format(char *buf, size_t size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INC_BOOT_H_ */
@@ -0,0 +1,133 @@
+/*
+ * capture.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: halvard
+ *
+ *  Description: pre-trigger event capture of raw IMU frames
+ *
+ *  While armed, every sample's raw register frame (imu_last_raw()) goes
+ *  into a ring of CAPTURE_RING_FRAMES. A trigger freezes the pre-trigger
+ *  part, the next post-trigger samples complete the window, and the window
+ *  stays frozen until the capture is re-armed. Triggers:
+ *
+ *  - threshold: | |a| - 1 g | above `threshold` g, checked on every sample
+ *    (squared, no sqrt);
+ *  - CLI: `capture trigger`.
+ *
+ *  capture_trigger() only latches the source, so it is safe from any
+ *  interrupt; the window is cut at the next sample.
+ *
+ *  The window is streamed as an .imur recording (imu_replay.h) followed by
+ *  its CRC-32, little endian, after a text line giving the total length:
+ *
+ *      capture: <n> bytes\r\n<header><frames><crc32>
+ *
+ *  so `tools/imu_replay.py extract` can cut it out of a console log and the
+ *  result replays like any recording. The stream starts at the sample after
+ *  capture_stream() (after the CLI prompt) and is fed from capture_process()
+ *  with at most what the UART TX ring can take without waiting, so
+ *  acquisition never blocks on it. Other console output during the dump
+ *  (logs, typing) ends up inside it, and the CRC will reject it.
+ *
+ *  Frames keep the range they were read at (imu_range_t, auto-ranging
+ *  may switch mid-window), and the window is streamed at the widest range
+ *  in it: finer frames are rounded to that scale, which an .imur header
+ *  can describe and which still holds the peaks that caused the switch.
+ *
+ *  Windows are set in ms and converted at the sample rate of the trigger
+ *  (pipeline_rate_hz()); 200 ms + 200 ms at 100 Hz is 41 frames. The ring
+ *  holds CAPTURE_RING_FRAMES, so longer windows or faster rates are
+ *  clipped at the trigger (the summary shows what was kept).
+ */
+
+#ifndef INC_CAPTURE_H_
+#define INC_CAPTURE_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "imu.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define CAPTURE_RING_FRAMES     64      // 14 B each, in .ram_buffers
+#define CAPTURE_STREAM_CHUNK    128     // max bytes queued per sample
+
+typedef enum {
+    CAPTURE_OFF = 0,
+    CAPTURE_ARMED,              // filling the pre-trigger ring
+    CAPTURE_POST,               // triggered, collecting post-trigger frames
+    CAPTURE_FROZEN,             // window complete
+    CAPTURE_STREAMING,          // window being sent, back to FROZEN after
+} capture_state_t;
+
+typedef enum {
+    CAPTURE_TRIGGER_NONE = 0,
+    CAPTURE_TRIGGER_THRESHOLD,
+    CAPTURE_TRIGGER_CLI,
+} capture_trigger_t;
+
+/**
+ * @brief Settings, exposed as CLI variables and applied when armed.
+ */
+typedef struct {
+    int pre_ms;                 // window before the trigger
+    int post_ms;                // window after the trigger
+    float threshold;            // [g] deviation of |a| from 1 g, 0 = off
+} capture_config_t;
+
+extern capture_config_t capture_config;
+
+typedef struct {
+    capture_state_t state;
+    capture_trigger_t trigger;  // source of the frozen window
+    uint32_t samples;           // since armed
+    uint32_t trigger_sample;    // sample number of the trigger frame
+    uint16_t pre;               // frames kept before / after the trigger
+    uint16_t post;
+    float peak;                 // [g] largest |a| in the window
+    uint16_t rate_hz;           // sample rate of the window
+    uint32_t streamed;          // bytes of the current/last stream
+    uint32_t stream_size;
+} capture_summary_t;
+
+/**
+ * @brief (Re)arms the capture with capture_config, dropping any window.
+ * @return 0 on success, 1 if the config is invalid or doesn't fit the ring
+ * at the current rate
+ */
+int capture_enable(void);
+
+void capture_disable(void);
+
+bool capture_enabled(void);
+
+/**
+ * @brief Latches a trigger; taken at the next sample if armed. ISR-safe.
+ */
+void capture_trigger(capture_trigger_t source);
+
+/**
+ * @brief Records one sample and advances the stream, if any.
+ * @return 1 when a window was just completed, 0 otherwise
+ */
+int capture_process(const imu_t *imu);
+
+/**
+ * @brief Streams the frozen window from the next sample on (see above).
+ * @return 0 on success, 1 if there is no complete window
+ */
+int capture_stream(void);
+
+void capture_get_summary(capture_summary_t *summary);
+
+const char *capture_trigger_name(capture_trigger_t source);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INC_CAPTURE_H_ */
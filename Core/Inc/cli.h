@@ -98,4 +98,9 @@ void cli_init(const cli_config_t *config);
  */
 void cli_update(void);
 
+/**
+ * @brief Runs one command line as if it had been typed (no echo, no history)
+ */
+void cli_execute(const char *cmd);
+
 #endif /* INC_CLI_H_ */
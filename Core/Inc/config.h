@@ -16,6 +16,20 @@ extern "C" {
 
 #define ENABLE_LOGGING
 
+// I2C transaction tracer behind the `i2ctrace` command (i2c_trace.h)
+//#define ENABLE_I2C_TRACE
+
+// IMU backend, IMU_BACKEND_MPU6050 unless set here (see imu_backend.h)
+//#define IMU_BACKEND IMU_BACKEND_SIM
+
+// Code run from SRAM instead of flash (MEM_RAMFUNC in mem_sections.h),
+// 1 = copied to RAM at startup. Costs RAM for the code and a veneer per
+// call between the two; compare with `bench hot` before and after.
+#define RAMFUNC_ISR     1   // FSYNC edge interrupt
+#define RAMFUNC_DECODE  1   // sample read, scaling and NED mapping
+#define RAMFUNC_FILTER  1   // per-sample PID step, quaternion update
+#define RAMFUNC_CLI     0   // command lookup, only runs per typed line
+
 #ifdef __cplusplus
 }
 #endif
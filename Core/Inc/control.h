@@ -0,0 +1,141 @@
+/*
+ * control.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: halvard
+ *
+ *  Description: fixed-rate PID loops from IMU attitude/rates to TIM3 PWM
+ *
+ *  Up to CONTROL_MAX_LOOPS arm_pid_f32 or arm_pid_q31 instances run on
+ *  every `div`-th sample, straight from pipeline_process(): the sample
+ *  clock (the main loop's 10 ms tick, or the recording during replay)
+ *  triggers them, so the loop rate is pipeline_rate_hz() / div and they run
+ *  before the analysis stages. Loop i reads its input, subtracts it from
+ *  the setpoint and drives PWM channel i (pwm.h):
+ *
+ *      e = (setpoint - input) / full_scale       per unit, clamped to +-1
+ *      u = PID(e)                                clamped to +-1
+ *      duty = 0.5 + 0.5 u
+ *
+ *  Gains are per unit of the input's full scale and per step: ki and kd
+ *  are the discrete integral and derivative gains at the loop rate. The
+ *  PID output (the integrator of CMSIS's incremental form) is clamped to
+ *  +-1, which doubles as anti-windup. q31 gains are stored as
+ *  k / 2^CONTROL_Q31_SHIFT, so they must satisfy
+ *  2|kp| + |ki| + 4|kd| < 2^CONTROL_Q31_SHIFT - 1 to keep the q31
+ *  increment from wrapping.
+ *
+ *  Setpoints and gains are read live every step (a gain change reloads
+ *  the PID coefficients without resetting its state); the number of loops,
+ *  their inputs, the divider and the number format are applied by
+ *  control_enable().
+ *
+ *  Latency is measured end to end with DWT, from the start of the
+ *  imu_process() call that read the sample to the last compare register
+ *  write. The PWM output follows at the next timer update, at most one
+ *  PWM period later.
+ */
+
+#ifndef INC_CONTROL_H_
+#define INC_CONTROL_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "imu.h"
+#include "pwm.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define CONTROL_MAX_LOOPS       PWM_CHANNELS
+
+// Inputs besides the imu_channel() indices: tilt from the accelerometer
+#define CONTROL_INPUT_ROLL      IMU_CHANNELS        // [deg]
+#define CONTROL_INPUT_PITCH     (IMU_CHANNELS + 1)  // [deg]
+#define CONTROL_INPUTS          (IMU_CHANNELS + 2)
+
+// Full scale of the per-unit error
+#define CONTROL_ACCEL_FULL_SCALE (16.0f * 9.81f)    // [m/s^2]
+#define CONTROL_GYRO_FULL_SCALE  2000.0f            // [dps]
+#define CONTROL_ANGLE_FULL_SCALE 180.0f             // [deg]
+
+#define CONTROL_Q31_SHIFT       5
+
+typedef struct {
+    int input;                  // imu_channel() index or CONTROL_INPUT_*
+    float setpoint;             // input units
+    float kp;                   // per unit, per step
+    float ki;
+    float kd;
+} control_loop_config_t;
+
+/**
+ * @brief Settings, exposed as CLI variables. Setpoints and gains are read
+ * every step, everything else is applied by control_enable().
+ */
+typedef struct {
+    int loops;                  // 1..CONTROL_MAX_LOOPS, loop i drives PWM channel i
+    int div;                    // run every div-th sample, 1..100
+    int qbits;                  // 0 (arm_pid_f32) or 31 (arm_pid_q31)
+    bool log;                   // print every step
+    control_loop_config_t loop[CONTROL_MAX_LOOPS];
+} control_config_t;
+
+extern control_config_t control_config;
+
+typedef struct {
+    uint32_t steps;             // control steps since enable
+    float input[CONTROL_MAX_LOOPS];  // last input, input units
+    float output[CONTROL_MAX_LOOPS]; // last PID output u, -1..1
+    uint32_t latency;           // sample to last PWM write, DWT cycles
+    uint32_t latency_max;
+    uint32_t latency_avg;
+    uint32_t period_min;        // between the samples of consecutive steps
+    uint32_t period_max;
+    uint32_t gains_rejected;    // live gain changes outside the q31 range
+} control_summary_t;
+
+/**
+ * @brief (Re)starts the loops with control_config, resetting their state.
+ * Starts TIM3 PWM at PWM_DEFAULT_FREQ_HZ, outputs at 50% until the first step.
+ * @return 0 on success, 1 if the config is invalid
+ */
+int control_enable(void);
+
+/**
+ * @brief Stops the loops and drives their PWM outputs low.
+ */
+void control_disable(void);
+
+bool control_enabled(void);
+
+/**
+ * @brief Runs one control step on every div-th sample.
+ * @return 1 when the loops ran, 0 otherwise or when disabled
+ */
+int control_process(const imu_t *imu);
+
+void control_get_summary(control_summary_t *summary);
+
+/**
+ * @brief Settings of the running loops.
+ */
+void control_get_active(control_config_t *config);
+
+/**
+ * @brief Value of a control input for one sample, input units.
+ */
+float control_input(const imu_t *imu, int input);
+
+/**
+ * @brief Short name of a control input ("ax".."gz", "roll", "pitch").
+ */
+const char *control_input_name(int input);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INC_CONTROL_H_ */
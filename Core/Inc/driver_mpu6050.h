@@ -585,6 +585,20 @@ uint8_t mpu6050_irq_handler(mpu6050_handle_t *handle);
  */
 uint8_t mpu6050_init(mpu6050_handle_t *handle);
 
+/**
+ * @brief     initialize the handle for a chip that is already configured
+ * @param[in] *handle pointer to an mpu6050 handle structure
+ * @return    status code
+ *            - 0 success
+ *            - 1 iic initialization failed
+ *            - 2 handle is NULL
+ *            - 3 linked functions is NULL
+ *            - 5 id is invalid
+ * @note      same as mpu6050_init without the device reset, so the registers
+ *            keep what the last init wrote (warm restart of the mcu only)
+ */
+uint8_t mpu6050_init_keep_config(mpu6050_handle_t *handle);
+
 /**
  * @brief     close the chip
  * @param[in] *handle pointer to an mpu6050 handle structure
@@ -85,6 +85,17 @@ extern "C"{
  */
 uint8_t mpu6050_basic_init(mpu6050_address_t addr_pin);
 
+/**
+ * @brief     basic example attach to a chip that is already configured
+ * @param[in] addr_pin iic device address
+ * @return    status code
+ *            - 0 success
+ *            - 1 attach failed
+ * @note      mpu6050_init_keep_config, no reset and no register writes, see
+ *            imu_backend_mpu6050_init()
+ */
+uint8_t mpu6050_basic_attach(mpu6050_address_t addr_pin);
+
 /**
  * @brief  basic example deinit
  * @return status code
@@ -94,6 +105,13 @@ uint8_t mpu6050_basic_init(mpu6050_address_t addr_pin);
  */
 uint8_t mpu6050_basic_deinit(void);
 
+/**
+ * @brief  basic example handle
+ * @return pointer to the handle set up by mpu6050_basic_init
+ * @note   for register access beyond the basic example (imu_backend_mpu6050.c)
+ */
+mpu6050_handle_t *mpu6050_basic_handle(void);
+
 /**
  * @brief      basic example read
  * @param[out] *g pointer to a converted data buffer
@@ -0,0 +1,65 @@
+/*
+ * dsp_bench.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: halvard
+ *
+ *  Description: cycle benchmarks of the CMSIS-DSP kernels on IMU-shaped data
+ *
+ *  Every kernel runs on three axes (one block per axis, SoA layout) for
+ *  block sizes 8..512 in its q15, q31 and f32 variant, and the result is
+ *  printed as one table of DWT cycles per sample. All buffers and instances
+ *  come from the scratch arena, so a size that does not fit is reported as
+ *  "-" instead of costing permanent RAM.
+ *
+ *  On the host build DWT runs at the 72 MHz equivalent of wall time, so host
+ *  numbers rank the variants but are not target cycle counts.
+ */
+
+#ifndef INC_DSP_BENCH_H_
+#define INC_DSP_BENCH_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+// Timed repetitions per cell (the minimum is reported)
+#define DSP_BENCH_DEFAULT_REPS 5
+
+// Fixed-point RFFTs pull in the 8192-entry realCoefA/B tables (32 KB for
+// q15, 64 KB for q31), which do not fit the F103RB flash next to the
+// firmware. Enabled on the host build only.
+#ifndef DSP_BENCH_FIXED_RFFT
+#define DSP_BENCH_FIXED_RFFT 0
+#endif
+
+/**
+ * @brief Line output used for the result table (e.g. the CLI puts function).
+ */
+typedef void (*dsp_bench_out_t)(const char *s);
+
+/**
+ * @brief Runs every kernel/variant/block size and prints the table.
+ * @param out  Output function, called once per line
+ * @param reps Timed repetitions per cell (0 selects DSP_BENCH_DEFAULT_REPS)
+ * @return 0 on success, 1 if the scratch arena is held by another user
+ */
+int dsp_bench_run(dsp_bench_out_t out, uint32_t reps);
+
+/**
+ * @brief Times one call of each per-sample hot path function and prints
+ * where it runs from (RAM or flash, see the RAMFUNC_* switches in config.h).
+ * Build once with a group on and once off to compare.
+ * @param out  Output function, called once per line
+ * @param reps Timed calls per function (0 selects DSP_BENCH_DEFAULT_REPS)
+ * @return 0
+ */
+int dsp_bench_hot(dsp_bench_out_t out, uint32_t reps);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INC_DSP_BENCH_H_ */
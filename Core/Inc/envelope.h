@@ -0,0 +1,114 @@
+/*
+ * envelope.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: halvard
+ *
+ *  Description: envelope spectrum of one IMU channel (bearing-fault analysis)
+ *
+ *  One stage chaining the classic envelope analysis, all in q31:
+ *
+ *      channel -> band-pass (arm_biquad_cascade_df1_q31, HP + LP section)
+ *              -> rectify (arm_abs_q31)
+ *              -> low-pass + decimate by `dec` (arm_fir_decimate_q31)
+ *              -> mean removal, Hann window, FFT of n envelope samples
+ *              -> magnitude spectrum and its largest peaks
+ *
+ *  The FFT is arm_cfft_q31 on the real envelope (imaginary parts zero),
+ *  not arm_rfft_q31: the q31 RFFT references the 8192-entry realCoefA/B
+ *  tables (64 KB) for every length, which do not fit the F103RB flash.
+ *  The CFFT needs only the twiddle and bit-reversal tables of its own
+ *  length, which also provide the Hann window.
+ *
+ *  Filters are designed for the pipeline sample rate when the stage is
+ *  enabled, and redesigned if that rate changes (replay of a recording made
+ *  at another rate). All buffers live in the scratch arena; with n = 256
+ *  the stage needs about 3 KB of it.
+ */
+
+#ifndef INC_ENVELOPE_H_
+#define INC_ENVELOPE_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "imu.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define ENVELOPE_MAX_DEC        16
+#define ENVELOPE_FIR_TAPS       24
+#define ENVELOPE_PEAKS          3
+
+// Float -> q31 scaling of the input channel: full sensor range
+#define ENVELOPE_ACCEL_FULL_SCALE (16.0f * 9.81f)   // [m/s^2]
+#define ENVELOPE_GYRO_FULL_SCALE  2000.0f           // [dps]
+
+/**
+ * @brief Settings applied by envelope_enable(). Exposed as CLI variables.
+ */
+typedef struct {
+    int channel;                // imu_channel() index
+    float band_lo;              // band-pass edges [Hz], 0 < lo < hi < 0.45 fs
+    float band_hi;
+    int dec;                    // decimation factor, 1..ENVELOPE_MAX_DEC
+    int n;                      // FFT length, 64, 128 or 256
+    bool log;                   // print every spectrum's peaks
+} envelope_config_t;
+
+extern envelope_config_t envelope_config;
+
+typedef struct {
+    float freq;                 // [Hz]
+    float amp;                  // envelope amplitude at freq, channel units
+} envelope_peak_t;
+
+typedef struct {
+    uint32_t spectra;           // spectra computed since enable
+    float bin_hz;               // spectrum resolution, 0 before the first
+    envelope_peak_t peak[ENVELOPE_PEAKS]; // largest first, amp 0 if unused
+    uint32_t chain_cycles;      // filter chain, DWT cycles per input sample
+    uint32_t fft_cycles;        // window + FFT + magnitude + peak search
+    uint32_t ram_bytes;         // scratch arena bytes held by the stage
+} envelope_summary_t;
+
+/**
+ * @brief (Re)starts the stage with envelope_config.
+ * @return 0 on success, 1 if the config is invalid or the arena is busy
+ */
+int envelope_enable(void);
+
+/**
+ * @brief Stops the stage and releases its scratch memory.
+ */
+void envelope_disable(void);
+
+bool envelope_enabled(void);
+
+/**
+ * @brief Feeds one sample of the configured channel.
+ * @return 1 when a new spectrum is available, 0 otherwise or when disabled
+ */
+int envelope_process(const imu_t *imu);
+
+void envelope_get_summary(envelope_summary_t *summary);
+
+/**
+ * @brief Settings of the running stage (envelope_config at enable time).
+ */
+void envelope_get_active(envelope_config_t *config);
+
+/**
+ * @brief Amplitude of one bin of the last spectrum, channel units.
+ * @param bin 0..n/2
+ * @return 0 if out of range or no spectrum yet
+ */
+float envelope_bin(uint32_t bin);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INC_ENVELOPE_H_ */
@@ -0,0 +1,66 @@
+/*
+ * fifo_decode.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: halvard
+ *
+ *  Description: word-wise decode of big-endian MPU6050 FIFO packets
+ *
+ *  The sensor stores every sample big-endian. Instead of building each
+ *  int16 from two byte loads, a shift and an OR, the decoders load 32-bit
+ *  words and swap the bytes of both halves at once (REV16), so one load and
+ *  one swap yield two samples. DMP quaternion words are swapped whole (REV).
+ *  The words are unaligned loads when a packet isn't a multiple of 4 bytes,
+ *  which the Cortex-M3 handles in hardware for LDR.
+ *
+ *  Samples are written straight to per-axis arrays. stride is the distance
+ *  between two frames in elements: 1 for plain SoA arrays, 3 for the
+ *  driver's int16_t (*)[3], sizeof(imu_raw_t) / 2 for imu_raw_t.
+ */
+
+#ifndef INC_FIFO_DECODE_H_
+#define INC_FIFO_DECODE_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+#define FIFO_RAW_FRAME_BYTES    12      // accel xyz, gyro xyz
+
+// DMP packet contents, in FIFO order
+#define FIFO_DMP_QUAT           0x01    // 4 x int32 q30, 16 bytes
+#define FIFO_DMP_ACCEL          0x02    // 6 bytes
+#define FIFO_DMP_GYRO           0x04    // 6 bytes
+#define FIFO_DMP_GESTURE        0x08    // tap/orient, 4 bytes, skipped
+
+typedef struct {
+    int16_t *acc[3];            // set for the fields decoded
+    int16_t *gyr[3];
+    int32_t *quat[4];           // DMP packets only
+    uint16_t stride;            // acc/gyr elements from one frame to the next
+    uint16_t quat_stride;
+} fifo_out_t;
+
+/**
+ * @return Bytes of one DMP packet with these fields, 0 if none
+ */
+uint16_t fifo_dmp_packet_bytes(uint8_t fields);
+
+/**
+ * @brief Decodes 12-byte accel + gyro frames (FIFO_EN 0x78).
+ */
+void fifo_decode_raw(const uint8_t *buf, uint16_t frames, const fifo_out_t *out);
+
+/**
+ * @brief Decodes DMP packets with the given FIFO_DMP_* fields. Fields not
+ * in the packet are left alone.
+ */
+void fifo_decode_dmp(const uint8_t *buf, uint16_t frames, uint8_t fields, const fifo_out_t *out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INC_FIFO_DECODE_H_ */
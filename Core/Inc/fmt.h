@@ -0,0 +1,58 @@
+/*
+ * fmt.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: halvard
+ *
+ *  Description: allocation-free formatted output (printf subset)
+ *
+ *  Supported conversions: %d %i %u %x %X %c %s %p %% and %f.
+ *  Flags '-', '0', '+', ' ', field width, precision and the 'l'/'h'
+ *  length modifiers are honoured. %f is formatted in fixed point from a
+ *  single-precision value (max 6 fractional digits), so no soft-double
+ *  printf or heap is linked in.
+ */
+
+#ifndef INC_FMT_H_
+#define INC_FMT_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdarg.h>
+#include <stddef.h>
+
+/**
+ * @brief Character sink used by fmt_vformat().
+ * @param c   Character to emit
+ * @param ctx User context passed through from fmt_vformat()
+ */
+typedef void (*fmt_sink_t)(char c, void *ctx);
+
+/**
+ * @brief Formats into an arbitrary sink, one character at a time.
+ * @return Number of characters emitted.
+ */
+int fmt_vformat(fmt_sink_t sink, void *ctx, const char *format, va_list args);
+
+/**
+ * @brief snprintf replacement. Always NUL-terminates when size > 0.
+ * @return Number of characters that would have been written (excluding NUL).
+ */
+int fmt_vsnprintf(char *buf, size_t size, const char *format, va_list args);
+int fmt_snprintf(char *buf, size_t size, const char *format, ...);
+
+/**
+ * @brief atof replacement that does not pull in newlib strtod (which
+ * allocates through Balloc).
+ * @param s   String to parse ("-1.25", "3", ".5", "1e-3")
+ * @param end Optional, set to the first unparsed character
+ */
+float fmt_strtof(const char *s, const char **end);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INC_FMT_H_ */
@@ -0,0 +1,119 @@
+/*
+ * fsync.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: halvard
+ *
+ *  Description: FSYNC external sync, sample tagging and edge timestamps
+ *
+ *  An external trigger (camera shutter, encoder index, ...) is wired to
+ *  both the MPU6050 FSYNC pin and PA8 (Arduino D7) on the MCU:
+ *
+ *  - the MPU6050 latches the edge and replaces the LSB of TEMP_OUT_L in
+ *    the next sample it takes with it (EXT_SYNC_SET), so the sample
+ *    coinciding with the trigger is tagged in the data itself, also in
+ *    recordings and capture windows (raw temp & 1; the temperature loses
+ *    1/340 degC);
+ *  - the PA8 EXTI interrupt (FSYNC_Pin, set up by CubeMX in gpio.c) takes
+ *    DWT->CYCCNT at the same edge; EXTI9_5_IRQHandler() passes it to
+ *    fsync_edge(), which drops it while FSYNC is disabled.
+ *
+ *  fsync_process() pairs each tagged sample with the pending edge before
+ *  its read and queues a sync event: IMU sample number, edge and read
+ *  timestamps. read - edge is how long before the read the trigger came,
+ *  which places it within the sample period, so other sensors stamped
+ *  with DWT can be aligned to the IMU stream to better than one sample.
+ *  The chip's own FSYNC interrupt (mpu6050_set_fsync_interrupt()) is not
+ *  needed for this, the INT pin stays free.
+ *
+ *  Edges with no tagged sample within two sample periods count as missed
+ *  (FSYNC not wired, sensor sampling slower than the trigger); tags with
+ *  no edge as orphans, still reported with edge 0. At most one edge per
+ *  sample can be resolved, as on the chip. Replay is ignored: a recording's
+ *  temperature LSBs have no edges to pair with.
+ */
+
+#ifndef INC_FSYNC_H_
+#define INC_FSYNC_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "imu.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define FSYNC_EDGES             4       // edges pending a tagged sample
+#define FSYNC_EVENTS            8       // sync events kept for readers
+
+typedef struct {
+    uint32_t sample;            // imu_sample seq of the tagged sample
+    uint32_t edge;              // DWT->CYCCNT at the MCU edge, 0 if none
+    uint32_t read;              // DWT->CYCCNT when the sample was read
+} fsync_event_t;
+
+typedef struct {
+    uint32_t next;              // event number of the next event to read
+    uint32_t lost;              // events overwritten before this reader got them
+} fsync_reader_t;
+
+/**
+ * @brief Settings, exposed as CLI variables.
+ */
+typedef struct {
+    bool log;                   // print every sync event
+} fsync_config_t;
+
+extern fsync_config_t fsync_config;
+
+typedef struct {
+    bool enabled;
+    uint32_t edges;             // MCU edges seen
+    uint32_t events;            // tagged samples
+    uint32_t missed;            // edges no sample was tagged for
+    uint32_t orphans;           // tags without an edge
+    float offset_us;            // read - edge of the last matched event
+    float offset_min_us;
+    float offset_max_us;
+} fsync_summary_t;
+
+/**
+ * @brief Sets EXT_SYNC_SET to TEMP_OUT_L and starts taking PA8 edges.
+ * @return 0 on success, 1 if the sensor config failed
+ */
+int fsync_enable(void);
+
+/**
+ * @brief Turns FSYNC latching off again (MPU6050_BASIC_DEFAULT_EXTERN_SYNC).
+ */
+void fsync_disable(void);
+
+/**
+ * @brief Records an edge; called from EXTI9_5_IRQHandler() on FSYNC_Pin.
+ * @param cycles DWT->CYCCNT at the edge
+ */
+void fsync_edge(uint32_t cycles);
+
+/**
+ * @brief Checks the sample imu_process() just read for the FSYNC tag.
+ * @return 1 when a sync event was queued, 0 otherwise
+ */
+int fsync_process(const imu_t *imu);
+
+void fsync_reader_init(fsync_reader_t *reader);
+
+/**
+ * @brief Oldest sync event the reader hasn't seen.
+ * @return 0 if an event was copied, 1 if there is none
+ */
+int fsync_read(fsync_reader_t *reader, fsync_event_t *event);
+
+void fsync_get_summary(fsync_summary_t *summary);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INC_FSYNC_H_ */
@@ -0,0 +1,110 @@
+/*
+ * health.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: halvard
+ *
+ *  Description: streaming sensor-health checks on every IMU sample
+ *
+ *  imu_process() runs health_check() on each sample right after the read,
+ *  before it is published, so the IMU_HEALTH_* flags travel with the sample
+ *  in imu_t (snapshots, stages, imulog). Each check keeps a few running
+ *  values per channel and costs the same on every sample:
+ *
+ *  - stuck: the raw count of an axis hasn't changed for `stuck` samples.
+ *    A live MPU6050 has several LSB of noise, so an unchanged count means
+ *    a frozen register or a dead axis. The count, not the converted value:
+ *    a range switch or a new calibration changes only the latter;
+ *  - saturated: an axis reads the rail (-32768 or 32767) in this sample;
+ *  - noise: the noise floor, mean square of the sample-to-sample change,
+ *    is tracked with a 1/32 exponential average and compared to a baseline
+ *    learned over the first `learn` samples. Outside baseline / noise^2 ..
+ *    baseline * noise^2 (noise is an RMS ratio) the channel is flagged;
+ *  - rate: the time since the previous sample (DWT) is off the learned
+ *    interval by more than `rate` of it: a missed read, a stall, or
+ *    samples read twice.
+ *
+ *  IMU_HEALTH_LEARNING is set while the baselines are learned; noise and
+ *  rate aren't checked then. A replayed recording is checked too, except
+ *  its rate. FIFO samples (imu_drain()) have no read time of their own,
+ *  so they skip the rate check as well. imu_init() and imu_configure()
+ *  start learning over, health_reset() does it on demand (after moving
+ *  the sensor to a quieter or noisier mount, for instance).
+ */
+
+#ifndef INC_HEALTH_H_
+#define INC_HEALTH_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "imu.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Settings, exposed as CLI variables and applied by health_reset().
+ */
+typedef struct {
+    int stuck;                  // samples without change that flag an axis, 0 off
+    float noise;                // noise floor RMS ratio to the baseline, 0 off
+    float rate;                 // interval deviation, fraction, 0 off
+    int learn;                  // samples to learn the baselines from
+    bool log;                   // print every change of the flags
+} health_config_t;
+
+extern health_config_t health_config;
+
+typedef struct {
+    uint32_t stuck;             // times the axis got stuck
+    uint32_t saturated;         // samples at the rail
+    uint32_t noisy;             // times the noise floor left the band
+    float baseline;             // learned noise floor RMS, [m/s^2] or [dps]
+    float floor;                // current noise floor RMS
+} health_channel_t;
+
+typedef struct {
+    uint32_t samples;           // since the last reset
+    uint8_t flags;              // IMU_HEALTH_* of the last sample
+    uint8_t stuck_mask;         // channel bits (imu_channel_name() order)
+    uint8_t noise_mask;
+    health_channel_t channel[IMU_CHANNELS];
+    uint32_t interval_us;       // learned sample interval
+    uint32_t late;              // intervals over the band (missed samples)
+    uint32_t early;             // intervals under the band
+} health_summary_t;
+
+/**
+ * @brief Clears all statistics and learns the baselines again with
+ * health_config.
+ * @return 0 on success, 1 if the config is invalid (state is kept)
+ */
+int health_reset(void);
+
+void health_enable(bool enable);
+
+bool health_enabled(void);
+
+/**
+ * @brief Checks one sample and sets imu->health.
+ * @param raw    Counts the sample was decoded from
+ * @param cycles DWT->CYCCNT at the read
+ * @param timed  cycles is the read time of this sample (rate check)
+ */
+void health_check(imu_t *imu, const imu_raw_t *raw, uint32_t cycles, bool timed);
+
+void health_get_summary(health_summary_t *summary);
+
+/**
+ * @brief Flag names, "stuck,noise" or "ok", into buf.
+ */
+void health_format(uint8_t flags, char *buf, size_t size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INC_HEALTH_H_ */
@@ -0,0 +1,114 @@
+/*
+ * i2c_trace.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: halvard
+ *
+ *  Description: I2C transaction tracer for the MPU6050 bus interface
+ *
+ *  With ENABLE_I2C_TRACE (config.h) every mpu6050_interface_iic_read() and
+ *  _write() records register, length, direction, DWT start cycle, duration
+ *  and HAL status into a ring of the last I2C_TRACE_RECORDS transactions,
+ *  and adds to per-register counters (transactions, bytes, errors, total
+ *  and worst cycles). The `i2ctrace` command prints both; "i2ctrace run
+ *  <command>" counts what a single command costs on the bus, e.g. how many
+ *  transactions a read-modify-write mpu6050_set_*() really does.
+ *
+ *  Without ENABLE_I2C_TRACE the hooks expand to nothing: no code, no data
+ *  in the interface, and this module compiles to an empty stub.
+ */
+
+#ifndef INC_I2C_TRACE_H_
+#define INC_I2C_TRACE_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "config.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define I2C_TRACE_RECORDS       32      // last transactions kept, power of two
+#define I2C_TRACE_REGS          32      // distinct register/direction pairs counted
+
+#define I2C_TRACE_WRITE         0x01    // record flags
+#define I2C_TRACE_ERROR         0x02    // HAL status other than HAL_OK
+
+typedef struct {
+    uint32_t start;             // DWT->CYCCNT before the transfer
+    uint32_t cycles;            // duration, DWT cycles
+    uint16_t len;
+    uint8_t reg;
+    uint8_t flags;              // I2C_TRACE_*
+} i2c_trace_record_t;
+
+typedef struct {
+    uint8_t reg;
+    uint8_t write;
+    uint16_t errors;
+    uint32_t count;
+    uint32_t bytes;
+    uint32_t cycles;            // total
+    uint32_t max;               // worst single transaction
+} i2c_trace_stat_t;
+
+typedef struct {
+    uint32_t count;             // transactions since the last clear
+    uint32_t bytes;
+    uint32_t cycles;
+    uint32_t errors;
+    uint32_t untracked;         // transactions on registers past I2C_TRACE_REGS
+    uint8_t regs;               // valid entries in the per-register table
+} i2c_trace_summary_t;
+
+#ifdef ENABLE_I2C_TRACE
+
+#include "main.h"
+
+#define I2C_TRACE_BEGIN(start)                  const uint32_t start = DWT->CYCCNT
+#define I2C_TRACE_END(start, flags, reg, len, status) \
+    i2c_trace_record((start), (uint8_t)((flags) | (((status) != HAL_OK) ? I2C_TRACE_ERROR : 0)), (reg), (len))
+
+/**
+ * @brief Records one transaction, called by the I2C_TRACE_END() hook.
+ */
+void i2c_trace_record(uint32_t start, uint8_t flags, uint8_t reg, uint16_t len);
+
+#else
+
+#define I2C_TRACE_BEGIN(start)
+#define I2C_TRACE_END(start, flags, reg, len, status)   ((void)0)
+
+#endif
+
+/**
+ * @brief true when the tracer is compiled in.
+ */
+bool i2c_trace_available(void);
+
+/**
+ * @brief Empties the ring and the per-register table.
+ */
+void i2c_trace_clear(void);
+
+void i2c_trace_get_summary(i2c_trace_summary_t *summary);
+
+/**
+ * @brief Per-register entry, in order of first use.
+ * @return 0 if copied, 1 past the last entry
+ */
+int i2c_trace_get_stat(uint8_t index, i2c_trace_stat_t *stat);
+
+/**
+ * @brief Recorded transaction, 0 the newest.
+ * @return 0 if copied, 1 if the ring doesn't reach back that far
+ */
+int i2c_trace_get_record(uint32_t age, i2c_trace_record_t *record);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INC_I2C_TRACE_H_ */
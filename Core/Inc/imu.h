@@ -14,14 +14,64 @@
 extern "C" {
 #endif
 
+#include "imu_backend.h"
+
+#include <stdint.h>
+
+// Sensor-health flags of a sample (see health.h)
+#define IMU_HEALTH_STUCK        0x01    // an axis hasn't changed for a while
+#define IMU_HEALTH_SATURATED    0x02    // an axis is at the rail
+#define IMU_HEALTH_NOISE        0x04    // a noise floor is off its baseline
+#define IMU_HEALTH_RATE         0x08    // read off the learned interval
+#define IMU_HEALTH_LEARNING     0x10    // baselines not learned yet
+
 typedef struct imu_t
 {
     float acc[3]; // [m/s^2]
     float gyr[3]; // [dps]
+    uint8_t health; // IMU_HEALTH_* flags
 } imu_t;
 
+// Full-scale setting a sample was read at. switches counts the scale
+// changes in the sample stream so far, so two samples were read at the
+// same scale exactly when their switches match; consumers holding raw
+// counts across samples (capture) rescale on a change.
+typedef struct imu_range_t
+{
+    uint8_t accel;      // AFS_SEL 0=2g..3=16g
+    uint8_t gyro;       // FS_SEL 0=250..3=2000 dps
+    uint16_t switches;
+} imu_range_t;
+
+// Channel index used by the processing stages: acc x/y/z, then gyr x/y/z
+#define IMU_CHANNELS 6
+
+// Raw samples imu_drain() fetches from the backend per call (stack)
+#define IMU_DRAIN_CHUNK 8
+
+// The sensor is the IMU_BACKEND selected at build time (imu_backend.h)
 int imu_init(imu_t *imu);
 int imu_process(imu_t *imu);
+// Backend settings (ranges, rate, FIFO); 0 on success
+int imu_configure(const imu_backend_config_t *cfg);
+// One raw frame to a sample at the current range, as imu_process() does
+void imu_decode(const imu_raw_t *raw, imu_t *imu);
+// Up to max FIFO samples into imu[], converted like imu_process(); 0 on success
+int imu_drain(imu_t *imu, uint16_t max, uint16_t *count);
+const char *imu_backend_name(void);
+float imu_channel(const imu_t *imu, int channel);
+const char *imu_channel_name(int channel);
+// DWT->CYCCNT when the last imu_process() call started reading the sample
+uint32_t imu_sample_cycles(void);
+// Sensor-frame counts behind the last imu_process() sample, with the range
+// they were read at
+void imu_last_raw(imu_raw_t *raw, imu_range_t *range);
+// Switches the full scales from the next imu_process() sample on, writing
+// only the registers that change; 1 while replaying or if the backend
+// can't (FIFO enabled: queued samples would be decoded at the new scale)
+int imu_set_range(uint8_t accel, uint8_t gyro);
+// Range codes the next sample will be read at
+void imu_get_range(uint8_t *accel, uint8_t *gyro);
 //void imu_deinit(void); /* Can be ignored as library only sets mpu6050 to sleep on deinit */
 
 #ifdef __cplusplus
@@ -0,0 +1,126 @@
+/*
+ * imu_backend.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: halvard
+ *
+ *  Description: IMU backend interface with compile-time selection
+ *
+ *  A backend is one sensor (or stand-in) behind six operations: init,
+ *  configure, a range switch, a burst read of the current sample, decode
+ *  of raw counts to g/dps in the sensor frame, and a FIFO drain. imu.c is written against
+ *  this interface only; the NED mapping, replay and everything after stay
+ *  backend-independent.
+ *
+ *  The backend is chosen at build time with IMU_BACKEND (config.h, or -D
+ *  on the command line). Each backend header provides its operations as
+ *  an initializer, IMU_BACKEND_<NAME>_OPS, and imu.c instantiates exactly
+ *  one of them as a `static const imu_backend_t`. With the table const and
+ *  its initializer visible, the compiler folds every call through it into
+ *  a direct call (from -O1 on), so the hot path has no indirection and the
+ *  other backends are never referenced, hence not linked.
+ *
+ *  Adding a backend: a header with its prototypes and _OPS initializer, a
+ *  .c file, an IMU_BACKEND_* id and a case in the selection below.
+ */
+
+#ifndef INC_IMU_BACKEND_H_
+#define INC_IMU_BACKEND_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "config.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define IMU_BACKEND_MPU6050     1   // LibDriver MPU6050 over I2C1
+#define IMU_BACKEND_SIM         2   // synthetic motion, no bus access
+
+#ifndef IMU_BACKEND
+#define IMU_BACKEND             IMU_BACKEND_MPU6050
+#endif
+
+/**
+ * @brief One sample in raw counts, sensor frame. temp is 0 for backends
+ * (or FIFO modes) without a temperature reading.
+ */
+typedef struct {
+    int16_t acc[3];
+    int16_t gyr[3];
+    int16_t temp;
+} imu_raw_t;
+
+/**
+ * @brief Measurement settings applied by configure().
+ */
+typedef struct {
+    uint16_t rate_hz;           // output data rate
+    uint8_t accel_range_g;      // 2, 4, 8 or 16
+    uint16_t gyro_range_dps;    // 250, 500, 1000 or 2000
+    bool fifo;                  // queue accel + gyro in the FIFO for drain()
+} imu_backend_config_t;
+
+typedef struct {
+    const char *name;
+
+    /**
+     * @brief Brings the sensor up with the backend's defaults.
+     * @return 0 on success, 1 on error
+     */
+    int (*init)(void);
+
+    /**
+     * @brief Applies cfg; decode() uses its ranges from then on.
+     * @return 0 on success, 1 if unsupported or the bus failed (the
+     * previous settings may be partly replaced)
+     */
+    int (*configure)(const imu_backend_config_t *cfg);
+
+    /**
+     * @brief Switches the full scales (range codes 0..3) and nothing else,
+     * as cheaply as the sensor allows; decode() follows from the next
+     * read() on.
+     * @return 0 on success, 1 if the FIFO is enabled (its queued samples
+     * were taken at the old scale) or the bus failed
+     */
+    int (*set_range)(uint8_t accel, uint8_t gyro);
+
+    /**
+     * @brief Reads the current output registers in one burst.
+     * @return 0 on success, 1 on error
+     */
+    int (*read)(imu_raw_t *raw);
+
+    /**
+     * @brief Raw counts to [g] and [dps], sensor frame.
+     */
+    void (*decode)(const imu_raw_t *raw, float acc[3], float gyr[3]);
+
+    /**
+     * @brief Reads up to max queued samples, oldest first.
+     * @param count Samples stored in raw
+     * @return 0 on success (count may be 0), 1 on error or FIFO not enabled
+     */
+    int (*drain)(imu_raw_t *raw, uint16_t max, uint16_t *count);
+
+    void (*deinit)(void);
+} imu_backend_t;
+
+#if IMU_BACKEND == IMU_BACKEND_MPU6050
+#include "imu_backend_mpu6050.h"
+#define IMU_BACKEND_OPS         IMU_BACKEND_MPU6050_OPS
+#elif IMU_BACKEND == IMU_BACKEND_SIM
+#include "imu_backend_sim.h"
+#define IMU_BACKEND_OPS         IMU_BACKEND_SIM_OPS
+#else
+#error "Unknown IMU_BACKEND"
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INC_IMU_BACKEND_H_ */
@@ -0,0 +1,66 @@
+/*
+ * imu_backend_mpu6050.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: halvard
+ *
+ *  Description: MPU6050 IMU backend (LibDriver, I2C1)
+ *
+ *  init() is mpu6050_basic_init() with its defaults (±2 g, ±2000 dps,
+ *  50 Hz, DLPF 3, FIFO off). read() is a single 14-byte burst from
+ *  ACCEL_XOUT_H, and decode() uses the ranges cached by the last
+ *  configure(), so a sample costs one bus transaction instead of the
+ *  driver's three config reads plus the burst. drain() reads 12-byte
+ *  accel + gyro frames once configure() enabled the FIFO. set_range()
+ *  works from cached copies of GYRO_CONFIG/ACCEL_CONFIG and writes only
+ *  the bytes that change, in one transaction. The chip applies a new
+ *  range from its next internal sample (1 ms at most), so a switch right
+ *  after a read is in effect by the next read.
+ *
+ *  Warm restart: a cold init keeps an image of the configuration registers
+ *  it leaves behind in RAM that survives an MCU reset. The next init
+ *  bulk-reads those registers (two bursts) and, if they still match,
+ *  only attaches to the chip: no reset, no reprogramming, no settle
+ *  delays, sampling is back in well under a millisecond of bus time. Any
+ *  difference (power cycle, a range or FIFO change since, a DMP load)
+ *  falls back to the full init.
+ */
+
+#ifndef INC_IMU_BACKEND_MPU6050_H_
+#define INC_IMU_BACKEND_MPU6050_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "imu_backend.h"
+
+int imu_backend_mpu6050_init(void);
+int imu_backend_mpu6050_configure(const imu_backend_config_t *cfg);
+int imu_backend_mpu6050_set_range(uint8_t accel, uint8_t gyro);
+int imu_backend_mpu6050_read(imu_raw_t *raw);
+void imu_backend_mpu6050_decode(const imu_raw_t *raw, float acc[3], float gyr[3]);
+int imu_backend_mpu6050_drain(imu_raw_t *raw, uint16_t max, uint16_t *count);
+void imu_backend_mpu6050_deinit(void);
+
+/**
+ * @brief true if the last init() found the chip configured and kept it.
+ */
+bool imu_backend_mpu6050_warm(void);
+
+#define IMU_BACKEND_MPU6050_OPS {                   \
+    .name = "MPU6050",                              \
+    .init = imu_backend_mpu6050_init,               \
+    .configure = imu_backend_mpu6050_configure,     \
+    .set_range = imu_backend_mpu6050_set_range,     \
+    .read = imu_backend_mpu6050_read,               \
+    .decode = imu_backend_mpu6050_decode,           \
+    .drain = imu_backend_mpu6050_drain,             \
+    .deinit = imu_backend_mpu6050_deinit,           \
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INC_IMU_BACKEND_MPU6050_H_ */
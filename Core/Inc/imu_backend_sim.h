@@ -0,0 +1,64 @@
+/*
+ * imu_backend_sim.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: halvard
+ *
+ *  Description: simulated IMU backend, synthetic motion without a bus
+ *
+ *  A free-running sensor clocked by HAL_GetTick(): at rate_hz it produces
+ *  a slow roll oscillation, IMU_SIM_ROLL_AMPLITUDE degrees at
+ *  IMU_SIM_ROLL_HZ, with the matching gravity vector and gyro rate plus a
+ *  few counts of deterministic noise, quantised to the configured ranges.
+ *  read() returns the latest sample, drain() every sample since the last
+ *  drain (up to a FIFO's worth, the rest is lost like on the chip).
+ *
+ *  Useful to bring up the pipeline without hardware (on target or host);
+ *  the host's register-level model (Host/Src/mpu6050_sim.c) stays the way
+ *  to exercise the real driver.
+ */
+
+#ifndef INC_IMU_BACKEND_SIM_H_
+#define INC_IMU_BACKEND_SIM_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "imu_backend.h"
+
+#define IMU_SIM_ROLL_AMPLITUDE  10.0f   // [deg]
+#define IMU_SIM_ROLL_HZ         0.5f
+#define IMU_SIM_FIFO_SAMPLES    85      // 1024-byte FIFO of 12-byte frames
+
+int imu_backend_sim_init(void);
+int imu_backend_sim_configure(const imu_backend_config_t *cfg);
+int imu_backend_sim_set_range(uint8_t accel, uint8_t gyro);
+int imu_backend_sim_read(imu_raw_t *raw);
+void imu_backend_sim_decode(const imu_raw_t *raw, float acc[3], float gyr[3]);
+int imu_backend_sim_drain(imu_raw_t *raw, uint16_t max, uint16_t *count);
+void imu_backend_sim_deinit(void);
+
+/**
+ * @brief Adds a half-sine shock of peak g on sensor z over the next
+ * `samples` samples, clipped at the range like the real sensor (for
+ * exercising capture and auto-ranging).
+ */
+void imu_backend_sim_shock(float g, uint16_t samples);
+
+#define IMU_BACKEND_SIM_OPS {                       \
+    .name = "IMU sim",                              \
+    .init = imu_backend_sim_init,                   \
+    .configure = imu_backend_sim_configure,         \
+    .set_range = imu_backend_sim_set_range,         \
+    .read = imu_backend_sim_read,                   \
+    .decode = imu_backend_sim_decode,               \
+    .drain = imu_backend_sim_drain,                 \
+    .deinit = imu_backend_sim_deinit,               \
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INC_IMU_BACKEND_SIM_H_ */
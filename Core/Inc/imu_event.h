@@ -0,0 +1,105 @@
+/*
+ * imu_event.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: halvard
+ *
+ *  Description: timestamped sensor event queue (DMP gestures, pedometer,
+ *  MPU6050 interrupts)
+ *
+ *  The driver callbacks (mpu6050_interface_receive_callback(),
+ *  _dmp_tap_callback(), _dmp_orient_callback()) only queue a 12-byte event
+ *  with a HAL_GetTick() stamp: no formatting, no console, no bus access,
+ *  so they cost the same from an interrupt as from the main loop and the
+ *  DMP can run at full rate. The pedometer has no callback; its counter
+ *  lives in DMP memory and is read from the main loop every `step_ms`
+ *  (imu_event_poll_steps()), queueing a STEPS event when it moved.
+ *
+ *  The queue is a broadcast ring of IMU_EVENT_QUEUE events: every consumer
+ *  (CLI, console telemetry, a flash log) has its own reader and sees every
+ *  event, at its own pace. The producer never waits; a reader that falls
+ *  more than the ring behind loses the oldest events and counts them.
+ *  Pushing and reading mask interrupts for the 12-byte copy only.
+ */
+
+#ifndef INC_IMU_EVENT_H_
+#define INC_IMU_EVENT_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define IMU_EVENT_QUEUE         32      // events, power of two, in .ram_buffers
+
+typedef enum {
+    IMU_EVENT_TAP = 1,          // code: MPU6050_DMP_TAP_*, value: tap count
+    IMU_EVENT_ORIENT,           // code: MPU6050_DMP_ORIENT_*
+    IMU_EVENT_STEPS,            // value: pedometer step count
+    IMU_EVENT_MOTION,           // motion interrupt
+    IMU_EVENT_FIFO_OVERFLOW,    // FIFO overflow interrupt
+} imu_event_type_t;
+
+typedef struct {
+    uint32_t tick;              // HAL_GetTick() [ms] when queued
+    uint32_t value;
+    uint16_t seq;               // low bits of the queue position
+    uint8_t type;               // imu_event_type_t
+    uint8_t code;
+} imu_event_t;
+
+typedef struct {
+    uint32_t next;              // queue position of the next event to read
+    uint32_t lost;              // events overwritten before this reader got them
+} imu_event_reader_t;
+
+/**
+ * @brief Settings, exposed as CLI variables.
+ */
+typedef struct {
+    int step_ms;                // pedometer poll interval, 0 = off
+    bool log;                   // print every event on the console
+} imu_event_config_t;
+
+extern imu_event_config_t imu_event_config;
+
+/**
+ * @brief Queues an event. Any context, never blocks.
+ */
+void imu_event_push(imu_event_type_t type, uint8_t code, uint32_t value);
+
+/**
+ * @brief Starts a reader at the end of the queue (new events only).
+ */
+void imu_event_reader_init(imu_event_reader_t *reader);
+
+/**
+ * @brief Oldest event the reader hasn't seen.
+ * @return 0 if an event was copied, 1 if there is none
+ */
+int imu_event_read(imu_event_reader_t *reader, imu_event_t *event);
+
+/**
+ * @brief Reads the DMP pedometer if step_ms elapsed and queues STEPS when
+ * the count changed. Main loop only (bus access); no-op without the DMP.
+ */
+void imu_event_poll_steps(void);
+
+/**
+ * @brief Events queued since boot.
+ */
+uint32_t imu_event_count(void);
+
+/**
+ * @brief One line of text, e.g. "1234 ms tap z up x2", without line end.
+ */
+void imu_event_format(const imu_event_t *event, char *buf, size_t size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INC_IMU_EVENT_H_ */
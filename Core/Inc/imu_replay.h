@@ -0,0 +1,131 @@
+/*
+ * imu_replay.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: halvard
+ *
+ *  Description: deterministic replay of recorded MPU6050 register frames
+ *
+ *  While a recording is open, imu_process() takes its samples from the
+ *  recording instead of the sensor, so the whole processing chain runs on
+ *  repeatable input. Recordings are the raw 14-byte ACCEL_XOUT_H..GYRO_ZOUT_L
+ *  bursts as read from the bus, behind a small header:
+ *
+ *      offset  size  field
+ *      0       4     magic "IMUR"
+ *      4       1     version (1)
+ *      5       1     accel range, ACCEL_CONFIG AFS_SEL (0=2g .. 3=16g)
+ *      6       1     gyro range, GYRO_CONFIG FS_SEL (0=250 .. 3=2000 dps)
+ *      7       1     frame size (14)
+ *      8       2     sample rate in Hz (little endian)
+ *      10      2     reserved
+ *      12      4     frame count (little endian)
+ *      16      ...   frames, registers in bus order (big endian)
+ *
+ *  On the host recordings come from files (tools/imu_replay.py creates
+ *  them); on target from the REPLAY flash slot defined in the linker script,
+ *  programmed separately, e.g. st-flash write rec.imur 0x0801E000.
+ */
+
+#ifndef INC_IMU_REPLAY_H_
+#define INC_IMU_REPLAY_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "imu.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define IMU_REPLAY_VERSION     1
+#define IMU_REPLAY_HEADER_SIZE 16
+#define IMU_REPLAY_FRAME_SIZE  14
+
+typedef enum {
+    IMU_REPLAY_MAX_SPEED = 0,   // back to back, for throughput and checksums
+    IMU_REPLAY_REALTIME         // paced at the recorded sample rate
+} imu_replay_pace_t;
+
+typedef struct {
+    uint32_t samples;           // samples pushed through imu_process()
+    uint32_t elapsed_us;
+    uint32_t samples_per_s;
+    uint32_t crc;               // CRC-32 over acc and gyr of every sample
+} imu_replay_stats_t;
+
+/**
+ * @brief Called after every replayed sample, for stages downstream of
+ * imu_process() that should see the recording too. Runs after the
+ * checksum, so stages may modify the sample in place.
+ */
+typedef void (*imu_replay_sink_t)(imu_t *imu, void *ctx);
+
+/**
+ * @brief Validates a recording and routes imu_process() to it.
+ * @param image Recording (header + frames), must stay valid until closed
+ * @param size  Size of image in bytes
+ * @return 0 on success, 1 if the header is invalid or frames are missing
+ */
+int imu_replay_open(const uint8_t *image, size_t size);
+
+/**
+ * @brief Routes imu_process() back to the sensor.
+ */
+void imu_replay_close(void);
+
+bool imu_replay_active(void);
+uint32_t imu_replay_remaining(void);
+uint16_t imu_replay_rate_hz(void);
+
+/**
+ * @brief Next frame converted to g and dps with the recorded ranges, using
+ * the same scale factors as the MPU6050 driver.
+ * @return 0 on success, 1 at the end of the recording
+ */
+int imu_replay_read(float accel_g[3], float gyro_dps[3]);
+
+/**
+ * @brief Counts and range codes of the frame imu_replay_read() returned last.
+ * @return 0 on success, 1 if no frame was read yet
+ */
+int imu_replay_last_frame(imu_raw_t *raw, uint8_t *accel_range, uint8_t *gyro_range);
+
+/**
+ * @brief Plays the open recording from its current position to the end.
+ * @param imu   Output of imu_process(), checksummed after every sample
+ * @param pace  Max speed or recorded sample rate
+ * @param sink  Optional downstream stage, may be NULL
+ * @param ctx   Passed to sink
+ * @param stats Filled with sample count, timing and checksum
+ * @return 0 on success, 1 if no recording is open or imu_process() failed
+ */
+int imu_replay_run(imu_t *imu, imu_replay_pace_t pace, imu_replay_sink_t sink, void *ctx,
+                   imu_replay_stats_t *stats);
+
+/**
+ * @brief Recording in the REPLAY flash slot.
+ * @return 0 and the slot bounds, 1 if there is no slot (host build
+ * without imu_replay_set_flash_slot())
+ */
+int imu_replay_flash_slot(const uint8_t **image, size_t *size);
+
+#ifdef HOST_BUILD
+/**
+ * @brief Host stand-in for programming the REPLAY slot.
+ */
+void imu_replay_set_flash_slot(const uint8_t *image, size_t size);
+#endif
+
+/**
+ * @brief CRC-32 (IEEE 802.3), start with crc = 0.
+ */
+uint32_t imu_replay_crc32(uint32_t crc, const void *data, size_t len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INC_IMU_REPLAY_H_ */
@@ -0,0 +1,92 @@
+/*
+ * imu_sample.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: halvard
+ *
+ *  Description: tear-free publication of the latest IMU sample
+ *
+ *  One producer (imu_process(), wherever it runs: main loop or an
+ *  interrupt) publishes every sample; any number of readers (CLI,
+ *  telemetry, fusion, in any context) take snapshots. Neither side locks
+ *  or masks interrupts.
+ *
+ *  Two slots and a sequence count: the writer fills the slot the readers
+ *  are not pointed at, slot[(seq + 1) & 1], and only then bumps seq. A
+ *  reader copies slot[seq & 1] and checks seq again; its slot can only
+ *  have been overwritten if the writer published twice in the meantime
+ *  (seq moved by 2 or more), and then it retries. So:
+ *
+ *  - a reader preempting the writer copies the previous, complete sample
+ *    and never waits for the writer (a plain seqlock would spin forever
+ *    there, since the writer can't run until the reader returns);
+ *  - a writer preempting a reader costs that reader a retry only if it
+ *    publishes twice during one copy, i.e. practically never at 100 Hz.
+ *
+ *  A single producer context is assumed; two concurrent writers would
+ *  need a lock. The host build exposes a preemption hook called between
+ *  every copied word, so tests can run the other side at any point.
+ */
+
+#ifndef INC_IMU_SAMPLE_H_
+#define INC_IMU_SAMPLE_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "imu.h"
+
+#include <stdint.h>
+
+typedef struct {
+    imu_t imu;
+    imu_range_t range;          // full scale the sample was read at
+    uint32_t seq;               // 1 for the first published sample
+    uint32_t cycles;            // DWT->CYCCNT when it was read
+} imu_sample_t;
+
+typedef struct {
+    uint32_t published;
+    uint32_t snapshots;
+    uint32_t retries;           // snapshots copied again after two publishes
+    uint32_t retries_max;       // retries of a single snapshot
+} imu_sample_stats_t;
+
+/**
+ * @brief Publishes a sample. Producer only, never blocks.
+ * @param range  Range tag of the sample (imu_last_raw())
+ * @param cycles DWT->CYCCNT at the read (imu_sample_cycles())
+ */
+void imu_sample_publish(const imu_t *imu, const imu_range_t *range, uint32_t cycles);
+
+/**
+ * @brief Consistent copy of the latest published sample.
+ * @return 0 on success, 1 if nothing was published yet
+ */
+int imu_sample_snapshot(imu_sample_t *out);
+
+/**
+ * @brief Counters; snapshot counts may miss increments from readers
+ * running concurrently.
+ */
+void imu_sample_get_stats(imu_sample_stats_t *stats);
+
+#ifdef HOST_BUILD
+/**
+ * @brief Called after every word copied, writer != 0 inside publish.
+ * Tests call the other side from here to simulate preemption.
+ */
+extern void (*imu_sample_preempt_hook)(int writer);
+
+/**
+ * @brief Forgets all samples and counters.
+ */
+void imu_sample_reset(void);
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INC_IMU_SAMPLE_H_ */
@@ -0,0 +1,53 @@
+/*
+ * mem_sections.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: halvard
+ *
+ *  Description: placement attributes for the large static buffers and for
+ *               code run from RAM
+ *
+ *  The linker script collects these into dedicated NOLOAD output sections
+ *  so tools/map_report.py can attribute them, and so startup code doesn't
+ *  spend time zeroing buffers that are always written before being read.
+ */
+
+#ifndef INC_MEM_SECTIONS_H_
+#define INC_MEM_SECTIONS_H_
+
+#include "config.h"
+
+/**
+ * Large buffers that are fully initialized by their owner before use
+ * (DMA targets, rings, line buffers). Not zeroed at startup, so anything
+ * whose flags or pointers may be read before its init stays in .bss.
+ * The name ends up in the input section name, so statics are still
+ * attributable in the map file.
+ */
+#define MEM_RAM_BUFFER(name)   __attribute__((section(".ram_buffers." #name), aligned(4)))
+
+/**
+ * The shared scratch arena (see scratch.h). Not zeroed at startup.
+ */
+#define MEM_SCRATCH(name)      __attribute__((section(".scratch." #name), aligned(8)))
+
+/**
+ * A function run from SRAM: at 72 MHz flash needs two wait states, which
+ * the prefetch buffer only hides for straight-line code. .RamFunc is part
+ * of .data in the linker script, so the startup copy loop moves it along
+ * with the initialized variables. group is one of the RAMFUNC_* switches in
+ * config.h; a group set to 0 stays in flash. noinline keeps the body from
+ * being inlined back into a caller in flash. Calls between flash and RAM
+ * are out of BL range and go through a linker veneer, so place callees
+ * with their callers.
+ */
+#if defined(HOST_BUILD)
+#define MEM_RAMFUNC(group, name)
+#else
+#define MEM_RAMFUNC(group, name)    MEM_RAMFUNC_(group, name)
+#define MEM_RAMFUNC_(group, name)   MEM_RAMFUNC_##group(name)
+#define MEM_RAMFUNC_0(name)
+#define MEM_RAMFUNC_1(name)         __attribute__((section(".RamFunc." #name), noinline))
+#endif
+
+#endif /* INC_MEM_SECTIONS_H_ */
@@ -0,0 +1,113 @@
+/*
+ * mfcc.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: halvard
+ *
+ *  Description: MFCC feature vectors of one IMU channel (machine-state fingerprints)
+ *
+ *  Frames of n samples (50% hop) of one channel go through the CMSIS-DSP
+ *  MFCC kernel, arm_mfcc_q15 or arm_mfcc_q31:
+ *
+ *      mean removal -> Hann window -> |FFT| -> mel filter bank -> log
+ *                   -> DCT-II, first `coeffs` outputs
+ *
+ *  The resulting cepstrum is a compact fingerprint of the vibration
+ *  spectrum's shape; c0 tracks the overall level. Each frame's vector is
+ *  kept in the summary for consumers on the board, printed when `log` is
+ *  set, and compared with a stored reference vector (mfcc_set_reference()).
+ *
+ *  The kernel is built with ARM_MFCC_CFFT_BASED: its default RFFT path
+ *  references the 8192-entry realCoefA/B tables for every length, which do
+ *  not fit the F103RB flash next to the firmware. The CFFT instance is
+ *  copied from the arm_const_structs entry of the one length in use, so
+ *  only those twiddle tables are linked.
+ *
+ *  Window, mel filters and DCT matrix are computed when the stage is
+ *  enabled (and again if the pipeline rate changes) into the scratch
+ *  arena, instead of the generated const tables CMSIS ships examples with.
+ *  With n = 128, 16 mels and 12 coefficients the stage needs about 2 KB of
+ *  the arena in q15 and 4 KB in q31.
+ */
+
+#ifndef INC_MFCC_H_
+#define INC_MFCC_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "imu.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define MFCC_MAX_MELS           32
+#define MFCC_MAX_COEFFS         16
+
+// Float -> fixed point scaling of the input channel: full sensor range
+#define MFCC_ACCEL_FULL_SCALE   (16.0f * 9.81f)     // [m/s^2]
+#define MFCC_GYRO_FULL_SCALE    2000.0f             // [dps]
+
+/**
+ * @brief Settings applied by mfcc_enable(). Exposed as CLI variables.
+ */
+typedef struct {
+    int channel;                // imu_channel() index
+    int n;                      // frame and FFT length, 64, 128 or 256
+    int mels;                   // mel filters, 2..MFCC_MAX_MELS and <= n/2
+    int coeffs;                 // cepstral coefficients kept, 1..MFCC_MAX_COEFFS and <= mels
+    int qbits;                  // 15 (arm_mfcc_q15) or 31 (arm_mfcc_q31)
+    bool log;                   // print every feature vector
+} mfcc_config_t;
+
+extern mfcc_config_t mfcc_config;
+
+typedef struct {
+    uint32_t frames;            // feature vectors computed since enable
+    float features[MFCC_MAX_COEFFS]; // last vector, c0 first, natural log units
+    bool reference;             // a reference vector is stored
+    float distance;             // Euclidean distance c1.. to the reference
+    uint32_t cycles;            // DWT cycles of the last frame
+    uint32_t cycles_max;
+    uint32_t ram_bytes;         // scratch arena bytes held by the stage
+} mfcc_summary_t;
+
+/**
+ * @brief (Re)starts the stage with mfcc_config. Drops the reference.
+ * @return 0 on success, 1 if the config is invalid or the arena is busy
+ */
+int mfcc_enable(void);
+
+/**
+ * @brief Stops the stage and releases its scratch memory.
+ */
+void mfcc_disable(void);
+
+bool mfcc_enabled(void);
+
+/**
+ * @brief Feeds one sample of the configured channel.
+ * @return 1 when a new feature vector is available, 0 otherwise or when disabled
+ */
+int mfcc_process(const imu_t *imu);
+
+void mfcc_get_summary(mfcc_summary_t *summary);
+
+/**
+ * @brief Settings of the running stage (mfcc_config at enable time).
+ */
+void mfcc_get_active(mfcc_config_t *config);
+
+/**
+ * @brief Stores the last feature vector as the reference later frames are
+ * compared with (e.g. captured while the machine runs normally).
+ * @return 0 on success, 1 if no frame has been computed yet
+ */
+int mfcc_set_reference(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INC_MFCC_H_ */
@@ -0,0 +1,45 @@
+/*
+ * pipeline.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: halvard
+ *
+ *  Description: processing stages run on every IMU sample
+ *
+ *  The main loop and the replay command both hand each sample from
+ *  imu_process() to pipeline_process(), which runs the optional stages
+ *  (each a no-op while disabled) in order and prints the console
+ *  telemetry that is switched on.
+ */
+
+#ifndef INC_PIPELINE_H_
+#define INC_PIPELINE_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "imu.h"
+
+#include <stdint.h>
+
+// Rate of the main loop's imu_process() calls
+#define PIPELINE_DEFAULT_RATE_HZ 100
+
+/**
+ * @brief Runs all stages on one sample, in place.
+ */
+void pipeline_process(imu_t *imu);
+
+/**
+ * @brief Sample rate the stages convert lags and periods with. The replay
+ * command switches it to the recording's rate for the duration.
+ */
+void pipeline_set_rate_hz(uint16_t rate_hz);
+uint16_t pipeline_rate_hz(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INC_PIPELINE_H_ */
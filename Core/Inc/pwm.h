@@ -0,0 +1,56 @@
+/*
+ * pwm.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: halvard
+ *
+ *  Description: four-channel PWM output on TIM3
+ *
+ *  TIM3 CH1..CH4 in PWM mode 1 on their default pins PA6, PA7, PB0 and PB1
+ *  (Arduino D12, D11, A3 and morpho CN10-24 on the Nucleo). The timer is
+ *  set up with registers here rather than through CubeMX: the HAL TIM
+ *  driver is not part of this project, and the pins must stay unassigned
+ *  in f103rb.ioc. Compare registers are preloaded, so a new duty takes
+ *  effect at the next counter update, up to one PWM period after
+ *  pwm_set().
+ *
+ *  The host build links Host/Src/pwm_sim.c instead, which only records
+ *  the duties.
+ */
+
+#ifndef INC_PWM_H_
+#define INC_PWM_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+#define PWM_CHANNELS        4
+#define PWM_TICK_HZ         1000000U    // counter clock, 1 us resolution
+#define PWM_DEFAULT_FREQ_HZ 1000U
+
+/**
+ * @brief Starts TIM3 at freq_hz with all outputs low. Safe to call again
+ * to change the frequency; duties are reset to 0.
+ * @return 0 on success, 1 if freq_hz is out of range (16 Hz .. 100 kHz)
+ */
+int pwm_init(uint32_t freq_hz);
+
+/**
+ * @brief Sets one channel's duty cycle, clamped to 0..1.
+ * @param channel 0..PWM_CHANNELS-1 (TIM3 CH1..CH4)
+ */
+void pwm_set(int channel, float duty);
+
+/**
+ * @brief Duty cycle last written to channel, 0 if out of range.
+ */
+float pwm_duty(int channel);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INC_PWM_H_ */
@@ -0,0 +1,111 @@
+/*
+ * quat.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: halvard
+ *
+ *  Description: batched quaternion attitude integration from gyro samples
+ *
+ *  Attitude quaternions are float32_t[4] / q31_t[4] in CMSIS order
+ *  {w, x, y, z}. Body rates come as one batch in SoA layout (gx[n], gy[n],
+ *  gz[n], as decoded from a FIFO burst) and every sample is applied through
+ *  the exponential map:
+ *
+ *      dq = exp(w dt / 2) = {cos(|w| dt/2), sin(|w| dt/2) w / |w|}
+ *      q  = q (x) dq
+ *
+ *  sin/cos come from CMSIS's table-based arm_sin_cos_f32/q31, which take
+ *  degrees (f32) or a q31 fraction of 180 degrees, the same unit as the
+ *  half angle here. The batch API first builds all dq of the batch in a
+ *  work buffer, chains them, and renormalises once at the end; the
+ *  per-sample API does the same for one sample and renormalises every
+ *  time, and is what the batch is benchmarked against (`bench dsp`, rows
+ *  quat and quat1).
+ *
+ *  Renormalisation is the first-order step q *= (3 - |q|^2) / 2, exact to
+ *  second order in the drift and free of sqrt and division; a unit
+ *  quaternion drifts by ~1e-7 (f32) per product, far inside its range.
+ *
+ *  q31 gyro samples are fractions of QUAT_GYRO_FULL_SCALE and the batch
+ *  takes the half-angle scale from quat_half_angle_scale_q31(dt) instead
+ *  of dt. The q31 product saturates, so a batch stays valid for any
+ *  length.
+ */
+
+#ifndef INC_QUAT_H_
+#define INC_QUAT_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "arm_math_types.h"
+
+#include <stdint.h>
+
+#define QUAT_GYRO_FULL_SCALE    2000.0f     // [dps] of a q31 rate of 1.0
+
+/**
+ * @brief Exponential map of a batch: dq[4i..4i+3] = exp(w_i dt / 2).
+ * @param gx,gy,gz Body rates [dps], n each
+ * @param dt       Sample period [s]
+ * @param dq       Output, 4n
+ */
+void quat_expmap_f32(const float32_t *gx, const float32_t *gy, const float32_t *gz,
+                     uint32_t n, float32_t dt, float32_t *dq);
+
+/**
+ * @brief Integrates a batch of n gyro samples into q and renormalises.
+ * @param q    Attitude, updated in place
+ * @param work 4n floats
+ */
+void quat_integrate_f32(float32_t *q, const float32_t *gx, const float32_t *gy,
+                        const float32_t *gz, uint32_t n, float32_t dt, float32_t *work);
+
+/**
+ * @brief Integrates one gyro sample into q and renormalises.
+ */
+void quat_update_f32(float32_t *q, float32_t gx, float32_t gy, float32_t gz, float32_t dt);
+
+/**
+ * @brief First-order renormalisation of n quaternions, in place.
+ */
+void quat_normalize_f32(float32_t *q, uint32_t n);
+
+/**
+ * @brief Half-angle scale for the q31 functions: a q31 rate of 1.0 turns by
+ * QUAT_GYRO_FULL_SCALE * dt / 2 degrees per sample, as a fraction of 180.
+ * @param dt Sample period [s], below 90 / QUAT_GYRO_FULL_SCALE
+ */
+q31_t quat_half_angle_scale_q31(float32_t dt);
+
+/**
+ * @brief q31 exponential map of a batch.
+ * @param gx,gy,gz Body rates, fractions of QUAT_GYRO_FULL_SCALE
+ * @param scale    quat_half_angle_scale_q31(dt)
+ * @param dq       Output, 4n
+ */
+void quat_expmap_q31(const q31_t *gx, const q31_t *gy, const q31_t *gz,
+                     uint32_t n, q31_t scale, q31_t *dq);
+
+/**
+ * @brief q31 batch integration, see quat_integrate_f32().
+ * @param work 4n words
+ */
+void quat_integrate_q31(q31_t *q, const q31_t *gx, const q31_t *gy, const q31_t *gz,
+                        uint32_t n, q31_t scale, q31_t *work);
+
+void quat_update_q31(q31_t *q, q31_t gx, q31_t gy, q31_t gz, q31_t scale);
+
+void quat_normalize_q31(q31_t *q, uint32_t n);
+
+/**
+ * @brief r = a (x) b, saturating. r may alias neither a nor b.
+ */
+void quat_product_q31(const q31_t *a, const q31_t *b, q31_t *r);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INC_QUAT_H_ */
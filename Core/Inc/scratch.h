@@ -0,0 +1,74 @@
+/*
+ * scratch.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: halvard
+ *
+ *  Description: shared scratch arena for work buffers with disjoint lifetimes
+ *
+ *  Work buffers that are only needed while one analysis mode is active
+ *  (FFT and filter work buffers, benchmark inputs, ...) are overlaid on one
+ *  static region instead of each owning its own RAM.
+ *  Ownership is exclusive: a second owner gets NULL until the first one
+ *  releases, which turns an accidental lifetime overlap into a visible
+ *  error instead of silent corruption.
+ */
+
+#ifndef INC_SCRATCH_H_
+#define INC_SCRATCH_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Size of the overlay region in bytes (the host build uses a larger one)
+#ifndef SCRATCH_SIZE
+#define SCRATCH_SIZE 4096
+#endif
+
+/**
+ * @brief Users of the arena. Add new users here and to scratch_names[].
+ */
+typedef enum {
+    SCRATCH_OWNER_NONE = 0,
+    SCRATCH_OWNER_DSP,          // FFT / analysis work buffers
+    SCRATCH_OWNER_ANC,          // adaptive noise cancellation filters
+    SCRATCH_OWNER_XCORR,        // cross-correlation history and work
+    SCRATCH_OWNER_ENVELOPE,     // envelope filters and spectrum
+    SCRATCH_OWNER_MFCC,         // MFCC history, tables and FFT buffer
+    SCRATCH_OWNER_COUNT
+} scratch_owner_t;
+
+/**
+ * @brief Takes exclusive ownership of the arena.
+ * @param owner Requesting user
+ * @param size  Bytes required
+ * @return 8-byte aligned pointer, or NULL if too large or owned by someone else
+ */
+void *scratch_acquire(scratch_owner_t owner, size_t size);
+
+/**
+ * @brief Releases the arena. Ignored if owner doesn't hold it.
+ */
+void scratch_release(scratch_owner_t owner);
+
+/**
+ * @brief Current owner (SCRATCH_OWNER_NONE when free).
+ */
+scratch_owner_t scratch_owner(void);
+
+/**
+ * @brief Largest size ever requested, for sizing SCRATCH_SIZE.
+ */
+size_t scratch_high_water(void);
+
+const char *scratch_owner_name(scratch_owner_t owner);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INC_SCRATCH_H_ */
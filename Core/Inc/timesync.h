@@ -0,0 +1,107 @@
+/*
+ * timesync.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: halvard
+ *
+ *  Description: two-way time sync with the host over the console UART
+ *
+ *  The host (tools/timesync.py) runs NTP-style exchanges, one CLI line and
+ *  one binary frame each:
+ *
+ *      host   -> "sync <seq> <t1> [<t4>]\r\n"
+ *      device -> "sync <seq>: 24 bytes\r\n" <t1> <t2> <t3> <crc32>
+ *
+ *  t1 is the host time the request was sent, t2 the device time the
+ *  command ran, t3 the device time just before the reply was written;
+ *  all little-endian uint64 microseconds, the CRC as in a capture dump.
+ *  t4, the host time the reply arrived, goes back with the next request,
+ *  so each exchange still takes one round trip and the device completes
+ *  exchange seq - 1 when request seq arrives:
+ *
+ *      offset = ((t2 - t1) + (t3 - t4)) / 2    device - host clock
+ *      delay  = (t4 - t1) - (t3 - t2)          round trip on the wire
+ *
+ *  Half the difference of the two one-way latencies ends up in the offset,
+ *  so only exchanges whose delay is within `gate` of the smallest in the
+ *  window count (the NTP clock filter). A line fitted through their
+ *  offsets over device time gives the offset now and the skew of the
+ *  device clock (DWT, so the HSE crystal) against the host's. Once `lock`
+ *  exchanges are in, timesync_host_us() maps device time to host time and
+ *  imulog lines are stamped with the host time of the sample read.
+ *
+ *  The fit keeps times in int64 us and only the centred sums in float
+ *  (soft-float on the M3, no double or libm but sqrtf); it runs from the
+ *  CLI, off the sample path, and the main loop keeps running between
+ *  exchanges, so the host can keep syncing while telemetry streams.
+ */
+
+#ifndef INC_TIMESYNC_H_
+#define INC_TIMESYNC_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define TIMESYNC_WINDOW         32      // exchanges the estimate is fitted over
+#define TIMESYNC_FRAME_BYTES    24      // t1, t2, t3
+
+/**
+ * @brief Settings, exposed as CLI variables and used from the next exchange.
+ */
+typedef struct {
+    int gate;                   // us over the window's minimum delay an exchange may take
+    int lock;                   // exchanges before telemetry is stamped in host time
+} timesync_config_t;
+
+extern timesync_config_t timesync_config;
+
+typedef struct {
+    uint32_t requests;          // sync lines since the last reset
+    uint32_t exchanges;         // completed with t4
+    uint32_t used;              // of the window, within the delay gate
+    uint32_t delay_min_us;      // smallest delay in the window
+    uint32_t delay_us;          // of the last exchange
+    int64_t offset_us;          // device - host clock, now
+    float skew_ppm;             // device clock rate error, > 0 fast
+    float rms_us;               // fit residual of the used exchanges
+    bool locked;
+} timesync_summary_t;
+
+/**
+ * @brief Drops all exchanges; telemetry goes back to device time.
+ */
+void timesync_reset(void);
+
+/**
+ * @brief Handles one request: completes the previous exchange with t4
+ * (has_t4), then writes the reply frame for this one.
+ * @param t2 micros() when the request was received
+ * @return 0 on success, 1 if the reply frame couldn't be written
+ */
+int timesync_request(uint32_t seq, uint64_t t1, bool has_t4, uint64_t t4, uint64_t t2);
+
+bool timesync_locked(void);
+
+/**
+ * @brief Device time (micros()) to host time, with the current offset and
+ * skew. Only meaningful when timesync_locked().
+ */
+uint64_t timesync_host_us(uint64_t device_us);
+
+/**
+ * @brief DWT->CYCCNT of a recent event (imu_sample_cycles()) on the
+ * micros() timeline.
+ */
+uint64_t timesync_cycles_us(uint32_t cycles);
+
+void timesync_get_summary(timesync_summary_t *summary);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INC_TIMESYNC_H_ */
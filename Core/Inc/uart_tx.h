@@ -0,0 +1,67 @@
+/*
+ * uart_tx.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: halvard
+ *
+ *  Description: interrupt-driven UART transmit ring
+ *
+ *  Writers copy into a static ring and return immediately; the UART TX
+ *  complete interrupt drains it. From thread mode a full ring makes the
+ *  writer wait for space, from interrupt context the excess is dropped and
+ *  counted, so an ISR can never deadlock on the console.
+ */
+
+#ifndef INC_UART_TX_H_
+#define INC_UART_TX_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "main.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Must be a power of two
+#define UART_TX_BUFFER_SIZE 1024
+
+/**
+ * @brief Binds the ring to a UART. Call once after MX_USARTx_UART_Init().
+ */
+void uart_tx_init(UART_HandleTypeDef *huart);
+
+/**
+ * @brief Queues len bytes for transmission.
+ * @return Number of bytes queued (less than len only when called from an ISR
+ * with a full ring).
+ */
+uint16_t uart_tx_write(const uint8_t *data, uint16_t len);
+
+/**
+ * @brief Bytes uart_tx_write() can queue right now without waiting, for
+ * writers that must never block (binary streams from the main loop).
+ */
+uint16_t uart_tx_space(void);
+
+/**
+ * @brief Queues a single character.
+ */
+void uart_tx_putc(char c);
+
+/**
+ * @brief Blocks until everything queued has left the ring.
+ */
+void uart_tx_flush(void);
+
+/**
+ * @brief Number of bytes dropped because the ring was full in ISR context.
+ */
+uint32_t uart_tx_dropped(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INC_UART_TX_H_ */
@@ -15,7 +15,8 @@ extern "C" {
 #endif
 
 #include "config.h"
-#include <stdio.h>
+#include <stdarg.h>
+#include <stddef.h>
 
 #define min(a,b) (((a) < (b)) ? (a) : (b))
 #define max(a,b) (((a) > (b)) ? (a) : (b))
@@ -24,6 +25,7 @@ extern "C" {
 void zeromem(void* pdata, size_t size);
 
 void print(const char* format, ...);
+void vprint(const char* format, va_list args);
 
 #ifdef __cplusplus
 }
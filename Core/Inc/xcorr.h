@@ -0,0 +1,96 @@
+/*
+ * xcorr.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: halvard
+ *
+ *  Description: sliding-block cross-correlation between two IMU channels
+ *
+ *  Estimates the delay and coherence between two channels (accel axes for
+ *  structural analysis, or accel vs gyro). Samples of both channels are
+ *  appended to a block of n samples; every n/2 samples (50 % overlap) the
+ *  block is correlated with arm_correlate_fast_opt_q15 and reduced to a
+ *  summary: the lag of the correlation peak, refined to a fraction of a
+ *  sample, and the normalised correlation at that lag.
+ *
+ *  Channel b is correlated over the centre n - 2*maxlag samples of the
+ *  block only, so every lag in +-maxlag sees the same overlap. Both blocks
+ *  are mean-removed and scaled to a fixed energy before the correlation,
+ *  which keeps the 32-bit accumulator of the fast kernel from wrapping.
+ *
+ *  History and work buffers live in the scratch arena while the stage is
+ *  enabled; only the summaries leave the stage.
+ */
+
+#ifndef INC_XCORR_H_
+#define INC_XCORR_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "imu.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define XCORR_MIN_N         16
+#define XCORR_MAX_N         512
+
+// Float -> q15 scaling of the history. Tighter than the sensor range:
+// vibration rarely exceeds it, and a clipped peak only distorts that block
+#define XCORR_ACCEL_FULL_SCALE (4.0f * 9.81f)   // [m/s^2]
+#define XCORR_GYRO_FULL_SCALE  500.0f           // [dps]
+
+/**
+ * @brief Settings applied by xcorr_enable(). Exposed as CLI variables.
+ */
+typedef struct {
+    int a;                      // imu_channel() index of the reference
+    int b;                      // imu_channel() index of the delayed channel
+    int n;                      // block length, even, XCORR_MIN_N..XCORR_MAX_N
+    int maxlag;                 // searched lag range, 1..n/4
+    bool log;                   // print every summary from pipeline_process()
+} xcorr_config_t;
+
+extern xcorr_config_t xcorr_config;
+
+typedef struct {
+    uint32_t blocks;            // summaries produced since enable
+    float lag;                  // [samples], > 0 when b lags a
+    float rho;                  // normalised correlation at the peak, -1..1
+    uint32_t cycles;            // DWT cycles of the last block
+    uint32_t cycles_max;
+} xcorr_summary_t;
+
+/**
+ * @brief (Re)starts the stage with xcorr_config.
+ * @return 0 on success, 1 if the config is invalid or the arena is busy
+ */
+int xcorr_enable(void);
+
+/**
+ * @brief Stops the stage and releases its scratch memory.
+ */
+void xcorr_disable(void);
+
+bool xcorr_enabled(void);
+
+/**
+ * @brief Appends one sample; correlates once a hop of samples is complete.
+ * @return 1 when a new summary is available, 0 otherwise or when disabled
+ */
+int xcorr_process(const imu_t *imu);
+
+void xcorr_get_summary(xcorr_summary_t *summary);
+
+/**
+ * @brief Settings of the running stage (xcorr_config at enable time).
+ */
+void xcorr_get_active(xcorr_config_t *config);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INC_XCORR_H_ */
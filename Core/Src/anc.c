@@ -0,0 +1,271 @@
+/*
+ * anc.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: halvard
+ *
+ *  Description: adaptive noise cancellation with a normalised LMS filter
+ */
+
+#include "anc.h"
+#include "scratch.h"
+#include "main.h"
+#include "arm_math.h"
+
+#include <string.h>
+
+#define ANC_AXES 3
+
+anc_config_t anc_config = {
+    .mu = 0.1f,
+    .taps = 16,
+    .ref = ANC_REF_GX,
+    .qbits = 31,
+};
+
+typedef struct {
+    float mean;
+    float var;
+} anc_ema_t;
+
+static struct {
+    bool enabled;
+    anc_config_t active;
+    bool axis_active[ANC_AXES];
+    union {
+        arm_lms_norm_instance_q31 q31[ANC_AXES];
+        arm_lms_norm_instance_q15 q15[ANC_AXES];
+    } lms;
+    float ext_ref;
+    float dc_ref;
+    float dc[ANC_AXES];
+
+    uint32_t samples;
+    uint32_t cycles_last;
+    uint32_t cycles_min;
+    uint32_t cycles_max;
+    uint64_t cycles_sum;
+    anc_ema_t in[ANC_AXES];
+    anc_ema_t out[ANC_AXES];
+    uint32_t converged_at[ANC_AXES];
+} anc;
+
+// Saturating float -> Q conversion of x / full_scale
+static q31_t anc_to_q31(float x, float full_scale)
+{
+    float v = x / full_scale * 2147483648.0f;
+    if (v >= 2147483647.0f)
+    {
+        return INT32_MAX;
+    }
+    if (v <= -2147483648.0f)
+    {
+        return INT32_MIN;
+    }
+    return (q31_t)v;
+}
+
+static q15_t anc_to_q15(float x, float full_scale)
+{
+    float v = x / full_scale * 32768.0f;
+    if (v >= 32767.0f)
+    {
+        return INT16_MAX;
+    }
+    if (v <= -32768.0f)
+    {
+        return INT16_MIN;
+    }
+    return (q15_t)v;
+}
+
+static void anc_ema_update(anc_ema_t *ema, float x)
+{
+    const float k = 1.0f / ANC_METRIC_SAMPLES;
+    ema->mean += (x - ema->mean) * k;
+    float dev = x - ema->mean;
+    ema->var += (dev * dev - ema->var) * k;
+}
+
+static float anc_reference(const imu_t *imu)
+{
+    if (anc.active.ref == ANC_REF_EXT)
+    {
+        return anc.ext_ref / ANC_EXT_FULL_SCALE;
+    }
+    float full_scale = (anc.active.ref < 3) ? ANC_ACCEL_FULL_SCALE : ANC_GYRO_FULL_SCALE;
+    return imu_channel(imu, anc.active.ref) / full_scale;
+}
+
+int anc_enable(void)
+{
+    anc_disable();
+
+    int taps = anc_config.taps;
+    if (taps < 1 || taps > ANC_MAX_TAPS || anc_config.ref < 0 || anc_config.ref >= ANC_REF_COUNT
+        || (anc_config.qbits != 15 && anc_config.qbits != 31)
+        || !(anc_config.mu > 0.0f && anc_config.mu < 1.0f))
+    {
+        return 1;
+    }
+
+    // Coefficients + state (numTaps + blockSize - 1 with blockSize 1) per axis
+    size_t word = (anc_config.qbits == 31) ? sizeof(q31_t) : sizeof(q15_t);
+    size_t per_axis = 2 * (size_t)taps * word;
+    uint8_t *mem = scratch_acquire(SCRATCH_OWNER_ANC, ANC_AXES * per_axis);
+    if (mem == NULL)
+    {
+        return 1;
+    }
+    memset(mem, 0, ANC_AXES * per_axis);
+
+    memset(&anc, 0, sizeof(anc));
+    anc.active = anc_config;
+    anc.cycles_min = UINT32_MAX;
+
+    for (int a = 0; a < ANC_AXES; a++)
+    {
+        anc.axis_active[a] = (anc.active.ref != ANC_REF_AX + a);
+
+        uint8_t *coeffs = mem + a * per_axis;
+        uint8_t *state = coeffs + (size_t)taps * word;
+        if (anc.active.qbits == 31)
+        {
+            q31_t mu = anc_to_q31(anc_config.mu, 1.0f);
+            arm_lms_norm_init_q31(&anc.lms.q31[a], (uint16_t)taps, (q31_t *)coeffs, (q31_t *)state,
+                                  mu, 1, ANC_POST_SHIFT);
+        }
+        else
+        {
+            q15_t mu = anc_to_q15(anc_config.mu, 1.0f);
+            arm_lms_norm_init_q15(&anc.lms.q15[a], (uint16_t)taps, (q15_t *)coeffs, (q15_t *)state,
+                                  mu, 1, ANC_POST_SHIFT);
+        }
+    }
+
+    anc.enabled = true;
+    return 0;
+}
+
+void anc_disable(void)
+{
+    if (anc.enabled)
+    {
+        anc.enabled = false;
+        scratch_release(SCRATCH_OWNER_ANC);
+    }
+}
+
+bool anc_enabled(void)
+{
+    return anc.enabled;
+}
+
+void anc_set_external_ref(float value)
+{
+    anc.ext_ref = value;
+}
+
+int anc_process(imu_t *imu)
+{
+    if (!anc.enabled)
+    {
+        return 0;
+    }
+
+    uint32_t start = DWT->CYCCNT;
+    const float k = 1.0f / ANC_DC_SAMPLES;
+    float ref = anc_reference(imu);
+    anc.dc_ref += (ref - anc.dc_ref) * k;
+    ref -= anc.dc_ref;
+    float cleaned[ANC_AXES];
+
+    for (int a = 0; a < ANC_AXES; a++)
+    {
+        if (!anc.axis_active[a])
+        {
+            continue;
+        }
+
+        // The filter works on the AC part only; gravity and offsets are
+        // added back, they are not something a vibration reference explains
+        anc.dc[a] += (imu->acc[a] - anc.dc[a]) * k;
+        float ac = imu->acc[a] - anc.dc[a];
+
+        if (anc.active.qbits == 31)
+        {
+            q31_t x = anc_to_q31(ref, 1.0f);
+            q31_t d = anc_to_q31(ac, ANC_ACCEL_FULL_SCALE);
+            q31_t y, e;
+            arm_lms_norm_q31(&anc.lms.q31[a], &x, &d, &y, &e, 1);
+            cleaned[a] = (float)e * (ANC_ACCEL_FULL_SCALE / 2147483648.0f) + anc.dc[a];
+        }
+        else
+        {
+            q15_t x = anc_to_q15(ref, 1.0f);
+            q15_t d = anc_to_q15(ac, ANC_ACCEL_FULL_SCALE);
+            q15_t y, e;
+            arm_lms_norm_q15(&anc.lms.q15[a], &x, &d, &y, &e, 1);
+            cleaned[a] = (float)e * (ANC_ACCEL_FULL_SCALE / 32768.0f) + anc.dc[a];
+        }
+    }
+    uint32_t cycles = DWT->CYCCNT - start;
+
+    // Metrics are kept out of the timed section
+    anc.samples++;
+    anc.cycles_last = cycles;
+    anc.cycles_min = (cycles < anc.cycles_min) ? cycles : anc.cycles_min;
+    anc.cycles_max = (cycles > anc.cycles_max) ? cycles : anc.cycles_max;
+    anc.cycles_sum += cycles;
+
+    for (int a = 0; a < ANC_AXES; a++)
+    {
+        if (!anc.axis_active[a])
+        {
+            continue;
+        }
+
+        anc_ema_update(&anc.in[a], imu->acc[a]);
+        anc_ema_update(&anc.out[a], cleaned[a]);
+        if (anc.converged_at[a] == 0 && anc.samples > ANC_METRIC_SAMPLES
+            && anc.out[a].var < ANC_CONVERGED_RATIO * anc.in[a].var)
+        {
+            anc.converged_at[a] = anc.samples;
+        }
+
+        imu->acc[a] = cleaned[a];
+    }
+
+    return 0;
+}
+
+void anc_get_metrics(anc_metrics_t *metrics)
+{
+    memset(metrics, 0, sizeof(*metrics));
+    metrics->active = anc.active;
+    metrics->samples = anc.samples;
+    if (anc.samples > 0)
+    {
+        metrics->cycles_last = anc.cycles_last;
+        metrics->cycles_min = anc.cycles_min;
+        metrics->cycles_max = anc.cycles_max;
+        metrics->cycles_avg = (uint32_t)(anc.cycles_sum / anc.samples);
+    }
+
+    for (int a = 0; a < ANC_AXES; a++)
+    {
+        metrics->axis_active[a] = anc.axis_active[a];
+        metrics->axis[a].in_rms = sqrtf(anc.in[a].var);
+        metrics->axis[a].out_rms = sqrtf(anc.out[a].var);
+        metrics->axis[a].converged_at = anc.converged_at[a];
+        if (anc.in[a].var > 0.0f && anc.out[a].var > 0.0f)
+        {
+            metrics->axis[a].atten_db = 10.0f * log10f(anc.out[a].var / anc.in[a].var);
+        }
+    }
+}
+
+const char *anc_ref_name(int ref)
+{
+    return (ref == ANC_REF_EXT) ? "ext" : imu_channel_name(ref);
+}
@@ -0,0 +1,172 @@
+/*
+ * autorange.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: halvard
+ *
+ *  Description: accelerometer and gyroscope full-scale auto-ranging
+ */
+
+#include "autorange.h"
+#include "imu_replay.h"
+#include "pipeline.h"
+
+#include <string.h>
+
+#define AUTORANGE_TOP           (AUTORANGE_RANGES - 1)
+#define AUTORANGE_FULL_SCALE    32768.0f
+
+autorange_config_t autorange_config = {
+    .accel = true,
+    .gyro = true,
+    .up = 0.9f,
+    .down = 0.6f,
+    .hold_ms = 1000,
+    .log = false,
+};
+
+typedef struct {
+    uint32_t quiet;             // samples in a row below the down threshold
+    bool clipping;              // previous sample clipped
+} autorange_track_t;
+
+static struct {
+    autorange_config_t active;
+    bool enabled;
+    int32_t up;                 // thresholds in counts at the current range
+    int32_t down;
+    uint32_t hold;              // samples
+    autorange_track_t accel;
+    autorange_track_t gyro;
+    autorange_summary_t summary;
+} ar;
+
+int autorange_enable(void)
+{
+    const autorange_config_t *cfg = &autorange_config;
+    if (cfg->down <= 0.0f || cfg->down >= cfg->up || cfg->up > 1.0f || cfg->hold_ms < 0)
+    {
+        return 1;
+    }
+
+    memset(&ar, 0, sizeof(ar));
+    ar.active = *cfg;
+    ar.up = (int32_t)(cfg->up * AUTORANGE_FULL_SCALE);
+    ar.down = (int32_t)(cfg->down * AUTORANGE_FULL_SCALE);
+    ar.summary.rate_hz = pipeline_rate_hz();
+    ar.hold = (uint32_t)cfg->hold_ms * ar.summary.rate_hz / 1000u;
+    ar.hold = (ar.hold > 0) ? ar.hold : 1;
+    imu_get_range(&ar.summary.accel.range, &ar.summary.gyro.range);
+    ar.enabled = true;
+    return 0;
+}
+
+void autorange_disable(void)
+{
+    ar.enabled = false;
+}
+
+bool autorange_enabled(void)
+{
+    return ar.enabled;
+}
+
+/**
+ * @brief Accounts one sample of a sensor and picks its next range.
+ * @param counts Raw counts of the sample, read at range `read`
+ * @param adjust Auto-ranging on for this sensor
+ * @return Range code for the next sample
+ */
+static uint8_t autorange_sensor(autorange_sensor_t *s, autorange_track_t *t, const int16_t counts[3],
+                                uint8_t read, bool adjust)
+{
+    int32_t peak = 0;
+    bool clipped = false;
+    for (int i = 0; i < 3; i++)
+    {
+        const int32_t v = counts[i];
+        clipped |= (v == 32767 || v == -32768);
+        peak = ((v < 0 ? -v : v) > peak) ? (v < 0 ? -v : v) : peak;
+    }
+
+    s->samples++;
+    s->dwell[read & AUTORANGE_TOP]++;
+    if (clipped)
+    {
+        s->clipped++;
+        s->clips += !t->clipping;
+    }
+    t->clipping = clipped;
+
+    // Counts read at another range than the current one (a switch just
+    // made, a recording) say nothing about the current range
+    const uint8_t range = s->range;
+    if (!adjust || read != range || imu_replay_active())
+    {
+        t->quiet = 0;
+        return range;
+    }
+
+    if (clipped)
+    {
+        t->quiet = 0;
+        return AUTORANGE_TOP;
+    }
+    if (peak >= ar.up && range < AUTORANGE_TOP)
+    {
+        t->quiet = 0;
+        return (uint8_t)(range + 1);
+    }
+    // Twice the counts at the next finer range
+    if (range > 0 && 2 * peak < ar.down)
+    {
+        if (++t->quiet >= ar.hold)
+        {
+            t->quiet = 0;
+            return (uint8_t)(range - 1);
+        }
+        return range;
+    }
+    t->quiet = 0;
+    return range;
+}
+
+int autorange_process(const imu_t *imu)
+{
+    (void)imu;
+    if (!ar.enabled)
+    {
+        return 0;
+    }
+
+    autorange_summary_t *s = &ar.summary;
+    imu_raw_t raw;
+    imu_range_t read;
+    imu_last_raw(&raw, &read);
+
+    // Settings changed elsewhere (imu_configure()) are the new baseline
+    imu_get_range(&s->accel.range, &s->gyro.range);
+
+    const uint8_t accel = autorange_sensor(&s->accel, &ar.accel, raw.acc, read.accel, ar.active.accel);
+    const uint8_t gyro = autorange_sensor(&s->gyro, &ar.gyro, raw.gyr, read.gyro, ar.active.gyro);
+    if (accel == s->accel.range && gyro == s->gyro.range)
+    {
+        return 0;
+    }
+    if (imu_set_range(accel, gyro) != 0)
+    {
+        s->failed++;
+        return 0;
+    }
+
+    s->accel.switches += (accel != s->accel.range);
+    s->gyro.switches += (gyro != s->gyro.range);
+    s->accel.range = accel;
+    s->gyro.range = gyro;
+    return 1;
+}
+
+void autorange_get_summary(autorange_summary_t *summary)
+{
+    *summary = ar.summary;
+}
@@ -0,0 +1,127 @@
+/*
+ * boot.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: halvard
+ *
+ *  Description: boot-phase timing from reset to the first sample
+ */
+
+#include "boot.h"
+#include "fmt.h"
+#include "main.h"
+#include "timer_module.h"
+
+static struct {
+    boot_phase_t phase[BOOT_PHASES];
+    uint8_t phases;
+    uint32_t cycles;                // DWT->CYCCNT at the last mark
+    uint32_t hz;                    // core clock since the last mark
+    uint32_t end_us;
+
+    void (*job[BOOT_JOBS])(void);
+    uint8_t jobs;
+    uint8_t jobs_run;
+    uint32_t hidden_us;
+} boot;
+
+void boot_start(void)
+{
+    timer_module_init();
+    boot.cycles = 0;
+    boot.hz = SystemCoreClock;
+}
+
+void boot_mark(const char *name)
+{
+    const uint32_t now = DWT->CYCCNT;
+    const uint32_t us = (uint32_t)((uint64_t)(now - boot.cycles) * 1000000u / boot.hz);
+
+    boot.end_us += us;
+    if (boot.phases < BOOT_PHASES)
+    {
+        boot_phase_t *p = &boot.phase[boot.phases++];
+        p->name = name;
+        p->us = us;
+        p->end_us = boot.end_us;
+    }
+    boot.cycles = now;
+    boot.hz = SystemCoreClock;
+}
+
+void boot_defer(void (*job)(void))
+{
+    if (boot.jobs < BOOT_JOBS)
+    {
+        boot.job[boot.jobs++] = job;
+    }
+    else
+    {
+        job();
+    }
+}
+
+/**
+ * @return Cycles the jobs took
+ */
+static uint32_t boot_run_jobs(void)
+{
+    const uint32_t start = DWT->CYCCNT;
+    while (boot.jobs_run < boot.jobs)
+    {
+        boot.job[boot.jobs_run++]();
+    }
+    return DWT->CYCCNT - start;
+}
+
+void boot_wait_ms(uint32_t ms)
+{
+    if (boot.jobs_run == boot.jobs)
+    {
+        HAL_Delay(ms);
+        return;
+    }
+
+    const uint32_t cycles = boot_run_jobs();
+    const uint32_t per_ms = SystemCoreClock / 1000u;
+    const uint32_t us = (uint32_t)((uint64_t)cycles * 1000u / per_ms);
+    const uint32_t done_ms = (cycles + per_ms - 1) / per_ms;
+
+    // Only what fit into the wait is hidden, the rest just ran late
+    boot.hidden_us += (us < ms * 1000u) ? us : ms * 1000u;
+    if (done_ms < ms)
+    {
+        HAL_Delay(ms - done_ms);
+    }
+}
+
+void boot_run_deferred(void)
+{
+    boot_run_jobs();
+}
+
+int boot_get_phase(uint8_t index, boot_phase_t *phase)
+{
+    if (index >= boot.phases)
+    {
+        return 1;
+    }
+    *phase = boot.phase[index];
+    return 0;
+}
+
+void boot_get_total(uint32_t *total_us, uint32_t *hidden_us)
+{
+    *total_us = boot.end_us;
+    *hidden_us = boot.hidden_us;
+}
+
+void boot_format(char *buf, size_t size)
+{
+    size_t len = (size_t)fmt_snprintf(buf, size, "boot %.1f ms:", (float)boot.end_us / 1000.0f);
+    for (uint8_t i = 0; i < boot.phases && len < size; i++)
+    {
+        len += (size_t)fmt_snprintf(buf + len, size - len, "%s %s %.1f", (i == 0) ? "" : ",",
+                                    boot.phase[i].name, (float)boot.phase[i].us / 1000.0f);
+    }
+}
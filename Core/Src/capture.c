@@ -0,0 +1,378 @@
+/*
+ * capture.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: halvard
+ *
+ *  Description: pre-trigger event capture of raw IMU frames
+ */
+
+#include "capture.h"
+#include "fmt.h"
+#include "imu_replay.h"
+#include "mem_sections.h"
+#include "pipeline.h"
+#include "uart_tx.h"
+#include "util.h"
+
+#include <math.h>
+#include <string.h>
+
+#define CAPTURE_G           9.81f           // imu_t acc is in m/s^2
+
+capture_config_t capture_config = {
+    .pre_ms = 200,
+    .post_ms = 200,
+    .threshold = 2.0f,
+};
+
+static const float capture_gyro_lsb[4] = {131.0f, 65.5f, 32.8f, 16.4f};
+
+static uint8_t capture_ring[CAPTURE_RING_FRAMES][IMU_REPLAY_FRAME_SIZE] MEM_RAM_BUFFER(capture_ring);
+
+static struct {
+    capture_config_t active;
+    uint16_t head;              // next ring slot
+    uint16_t filled;            // valid frames, up to CAPTURE_RING_FRAMES
+    uint16_t start;             // ring slot of the window's first frame
+    uint16_t post_left;
+    uint8_t ring_range[CAPTURE_RING_FRAMES];    // AFS_SEL | FS_SEL << 4 per slot
+    uint8_t accel_range;        // of the window: the widest in it
+    uint8_t gyro_range;
+    float lo2, hi2;             // threshold band on |a|^2, [m/s^2]^2
+    volatile uint8_t pending;   // capture_trigger_t latched by capture_trigger()
+
+    uint8_t header[IMU_REPLAY_HEADER_SIZE];
+    uint8_t frame[IMU_REPLAY_FRAME_SIZE];       // frame being streamed, rescaled
+    uint8_t trailer[4];         // CRC-32 of header and frames, little endian
+    uint32_t crc;
+
+    capture_summary_t summary;
+} cap;
+
+static uint16_t capture_frames(int ms, uint16_t rate_hz)
+{
+    return (uint16_t)(((uint32_t)ms * rate_hz + 999u) / 1000u);
+}
+
+static int16_t capture_be16(const uint8_t *p)
+{
+    return (int16_t)(((uint16_t)p[0] << 8) | p[1]);
+}
+
+static void capture_put_be16(uint8_t *p, int32_t v)
+{
+    v = (v > 32767) ? 32767 : ((v < -32768) ? -32768 : v);
+    p[0] = (uint8_t)((uint16_t)v >> 8);
+    p[1] = (uint8_t)v;
+}
+
+static void capture_put_frame(uint8_t *f, const imu_raw_t *raw)
+{
+    const int16_t words[7] = {raw->acc[0], raw->acc[1], raw->acc[2], raw->temp,
+                              raw->gyr[0], raw->gyr[1], raw->gyr[2]};
+    for (int i = 0; i < 7; i++)
+    {
+        f[2 * i] = (uint8_t)((uint16_t)words[i] >> 8);
+        f[2 * i + 1] = (uint8_t)words[i];
+    }
+}
+
+int capture_enable(void)
+{
+    capture_disable();
+
+    const capture_config_t *cfg = &capture_config;
+    const uint16_t rate = pipeline_rate_hz();
+    if (cfg->pre_ms < 0 || cfg->post_ms < 0 || cfg->threshold < 0.0f
+        || capture_frames(cfg->pre_ms, rate) + 1 + capture_frames(cfg->post_ms, rate) > CAPTURE_RING_FRAMES)
+    {
+        return 1;
+    }
+
+    memset(&cap, 0, sizeof(cap));
+    cap.active = *cfg;
+    if (cfg->threshold > 0.0f)
+    {
+        const float hi = (1.0f + cfg->threshold) * CAPTURE_G;
+        const float lo = (cfg->threshold < 1.0f) ? (1.0f - cfg->threshold) * CAPTURE_G : 0.0f;
+        cap.hi2 = hi * hi;
+        cap.lo2 = lo * lo;
+    }
+    cap.summary.state = CAPTURE_ARMED;
+    return 0;
+}
+
+void capture_disable(void)
+{
+    cap.summary.state = CAPTURE_OFF;
+}
+
+bool capture_enabled(void)
+{
+    return cap.summary.state != CAPTURE_OFF;
+}
+
+void capture_trigger(capture_trigger_t source)
+{
+    if (cap.pending == CAPTURE_TRIGGER_NONE)
+    {
+        cap.pending = (uint8_t)source;
+    }
+}
+
+/**
+ * @brief Cuts the window at the frame just stored.
+ */
+static void capture_fire(capture_trigger_t source)
+{
+    capture_summary_t *s = &cap.summary;
+    const uint16_t rate = pipeline_rate_hz();
+
+    // Trigger frame is the newest; keep what the ring allows around it
+    uint16_t pre = capture_frames(cap.active.pre_ms, rate);
+    uint16_t post = capture_frames(cap.active.post_ms, rate);
+    pre = (pre < cap.filled - 1) ? pre : (uint16_t)(cap.filled - 1);
+    post = (post < CAPTURE_RING_FRAMES - 1 - pre) ? post : (uint16_t)(CAPTURE_RING_FRAMES - 1 - pre);
+
+    const uint16_t trigger_slot = (uint16_t)((cap.head + CAPTURE_RING_FRAMES - 1) % CAPTURE_RING_FRAMES);
+    cap.start = (uint16_t)((trigger_slot + CAPTURE_RING_FRAMES - pre) % CAPTURE_RING_FRAMES);
+    cap.post_left = post;
+
+    s->trigger = source;
+    s->trigger_sample = s->samples;
+    s->pre = pre;
+    s->post = post;
+    s->rate_hz = rate;
+    s->streamed = 0;
+    s->stream_size = 0;
+    s->state = (post > 0) ? CAPTURE_POST : CAPTURE_FROZEN;
+}
+
+/**
+ * @brief Settles the window's range and largest |a| [g] once it is complete.
+ */
+static void capture_close_window(void)
+{
+    capture_summary_t *s = &cap.summary;
+    float peak = 0.0f;
+
+    cap.accel_range = 0;
+    cap.gyro_range = 0;
+    for (uint16_t k = 0; k <= s->pre + s->post; k++)
+    {
+        const uint16_t slot = (uint16_t)((cap.start + k) % CAPTURE_RING_FRAMES);
+        const uint8_t accel = cap.ring_range[slot] & 0x0F;
+        const uint8_t gyro = cap.ring_range[slot] >> 4;
+        cap.accel_range = (accel > cap.accel_range) ? accel : cap.accel_range;
+        cap.gyro_range = (gyro > cap.gyro_range) ? gyro : cap.gyro_range;
+
+        float a2 = 0.0f;
+        for (int i = 0; i < 3; i++)
+        {
+            const float a = (float)capture_be16(&capture_ring[slot][2 * i]) / (float)(16384 >> accel);
+            a2 += a * a;
+        }
+        peak = (a2 > peak) ? a2 : peak;
+    }
+    s->peak = sqrtf(peak);
+}
+
+/**
+ * @brief Frame k of the window at the window's range: counts read at a
+ * finer range are rounded to it (the temperature has no range).
+ */
+static void capture_window_frame(uint16_t k, uint8_t *out)
+{
+    const uint16_t slot = (uint16_t)((cap.start + k) % CAPTURE_RING_FRAMES);
+    const uint8_t *f = capture_ring[slot];
+    const uint8_t accel = cap.ring_range[slot] & 0x0F;
+    const uint8_t gyro = cap.ring_range[slot] >> 4;
+
+    memcpy(out, f, IMU_REPLAY_FRAME_SIZE);
+    if (accel != cap.accel_range)
+    {
+        // Accel scales are exact powers of two apart
+        const int shift = cap.accel_range - accel;
+        for (int i = 0; i < 3; i++)
+        {
+            capture_put_be16(&out[2 * i], ((int32_t)capture_be16(&f[2 * i]) + (1 << (shift - 1))) >> shift);
+        }
+    }
+    if (gyro != cap.gyro_range)
+    {
+        const float scale = capture_gyro_lsb[cap.gyro_range] / capture_gyro_lsb[gyro];
+        for (int i = 4; i < 7; i++)
+        {
+            capture_put_be16(&out[2 * i], (int32_t)lrintf((float)capture_be16(&f[2 * i]) * scale));
+        }
+    }
+}
+
+/**
+ * @brief Queues as much of the stream as the TX ring takes without waiting.
+ */
+static void capture_stream_step(void)
+{
+    capture_summary_t *s = &cap.summary;
+    const uint32_t frames_end = IMU_REPLAY_HEADER_SIZE + (uint32_t)(s->pre + 1 + s->post) * IMU_REPLAY_FRAME_SIZE;
+    uint16_t budget = uart_tx_space();
+    budget = (budget < CAPTURE_STREAM_CHUNK) ? budget : CAPTURE_STREAM_CHUNK;
+
+    if (s->streamed == 0)
+    {
+        if (budget < 32)
+        {
+            return;
+        }
+        char line[32];
+        budget -= (uint16_t)fmt_snprintf(line, sizeof(line), "capture: %lu bytes\r\n",
+                                         (unsigned long)s->stream_size);
+        uart_tx_write((const uint8_t *)line, (uint16_t)strlen(line));
+    }
+
+    while (budget > 0 && s->streamed < s->stream_size)
+    {
+        const uint8_t *src;
+        uint32_t n;
+        if (s->streamed < IMU_REPLAY_HEADER_SIZE)
+        {
+            src = &cap.header[s->streamed];
+            n = IMU_REPLAY_HEADER_SIZE - s->streamed;
+        }
+        else if (s->streamed < frames_end)
+        {
+            // Up to the end of the current frame
+            uint32_t off = s->streamed - IMU_REPLAY_HEADER_SIZE;
+            if (off % IMU_REPLAY_FRAME_SIZE == 0)
+            {
+                capture_window_frame((uint16_t)(off / IMU_REPLAY_FRAME_SIZE), cap.frame);
+            }
+            src = &cap.frame[off % IMU_REPLAY_FRAME_SIZE];
+            n = IMU_REPLAY_FRAME_SIZE - off % IMU_REPLAY_FRAME_SIZE;
+        }
+        else
+        {
+            // The CRC is final once the frames are out
+            if (s->streamed == frames_end)
+            {
+                for (int i = 0; i < 4; i++)
+                {
+                    cap.trailer[i] = (uint8_t)(cap.crc >> (8 * i));
+                }
+            }
+            src = &cap.trailer[s->streamed - frames_end];
+            n = s->stream_size - s->streamed;
+        }
+
+        n = (n < budget) ? n : budget;
+        uart_tx_write(src, (uint16_t)n);
+        if (s->streamed < frames_end)
+        {
+            cap.crc = imu_replay_crc32(cap.crc, src, n);
+        }
+        s->streamed += n;
+        budget -= (uint16_t)n;
+    }
+
+    if (s->streamed == s->stream_size)
+    {
+        s->state = CAPTURE_FROZEN;
+    }
+}
+
+int capture_process(const imu_t *imu)
+{
+    capture_summary_t *s = &cap.summary;
+    if (s->state == CAPTURE_STREAMING)
+    {
+        capture_stream_step();
+        return 0;
+    }
+    if (s->state != CAPTURE_ARMED && s->state != CAPTURE_POST)
+    {
+        return 0;
+    }
+
+    imu_raw_t raw;
+    imu_range_t range;
+    imu_last_raw(&raw, &range);
+    capture_put_frame(capture_ring[cap.head], &raw);
+    cap.ring_range[cap.head] = (uint8_t)(range.accel | (range.gyro << 4));
+    cap.head = (uint16_t)((cap.head + 1) % CAPTURE_RING_FRAMES);
+    cap.filled = (cap.filled < CAPTURE_RING_FRAMES) ? (uint16_t)(cap.filled + 1) : cap.filled;
+    s->samples++;
+
+    if (s->state == CAPTURE_POST)
+    {
+        if (--cap.post_left == 0)
+        {
+            s->state = CAPTURE_FROZEN;
+        }
+    }
+    else
+    {
+        const float a2 = imu->acc[0] * imu->acc[0] + imu->acc[1] * imu->acc[1] + imu->acc[2] * imu->acc[2];
+        capture_trigger_t source = (capture_trigger_t)cap.pending;
+        cap.pending = CAPTURE_TRIGGER_NONE;
+        if (source == CAPTURE_TRIGGER_NONE && cap.hi2 > 0.0f && (a2 > cap.hi2 || a2 < cap.lo2))
+        {
+            source = CAPTURE_TRIGGER_THRESHOLD;
+        }
+        if (source == CAPTURE_TRIGGER_NONE)
+        {
+            return 0;
+        }
+
+        capture_fire(source);
+    }
+
+    if (s->state == CAPTURE_FROZEN)
+    {
+        capture_close_window();
+        return 1;
+    }
+    return 0;
+}
+
+int capture_stream(void)
+{
+    capture_summary_t *s = &cap.summary;
+    if (s->state != CAPTURE_FROZEN)
+    {
+        return 1;
+    }
+
+    const uint32_t frames = (uint32_t)s->pre + 1 + s->post;
+    uint8_t *h = cap.header;
+    memcpy(h, "IMUR", 4);
+    h[4] = IMU_REPLAY_VERSION;
+    h[5] = cap.accel_range;
+    h[6] = cap.gyro_range;
+    h[7] = IMU_REPLAY_FRAME_SIZE;
+    h[8] = (uint8_t)s->rate_hz;
+    h[9] = (uint8_t)(s->rate_hz >> 8);
+    h[10] = 0;
+    h[11] = 0;
+    for (int i = 0; i < 4; i++)
+    {
+        h[12 + i] = (uint8_t)(frames >> (8 * i));
+    }
+
+    s->streamed = 0;
+    s->stream_size = IMU_REPLAY_HEADER_SIZE + frames * IMU_REPLAY_FRAME_SIZE + 4;
+    cap.crc = 0;
+    s->state = CAPTURE_STREAMING;
+    return 0;
+}
+
+void capture_get_summary(capture_summary_t *summary)
+{
+    *summary = cap.summary;
+}
+
+const char *capture_trigger_name(capture_trigger_t source)
+{
+    static const char *const names[] = {"none", "threshold", "cli"};
+    return ((unsigned)source < sizeof(names) / sizeof(names[0])) ? names[source] : "?";
+}
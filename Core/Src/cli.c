@@ -19,7 +19,7 @@
  */
 
 #include "cli.h"
-#include <stdio.h>
+#include "mem_sections.h"
 #include <string.h>
 #include <stdbool.h>
 #include <stdint.h>
@@ -28,6 +28,7 @@
 #define CLI_BUFFER_SIZE 128
 #define CLI_HISTORY_SIZE 10
 #define CLI_MAX_ARGS 8
+#define CLI_MAX_MATCHES 10
 
 // =============================================================================
 // CLI State
@@ -36,8 +37,8 @@
 static char cli_buffer[CLI_BUFFER_SIZE];
 static uint16_t cli_index = 0;
 
-// Command history
-static char cli_history[CLI_HISTORY_SIZE][CLI_BUFFER_SIZE];
+// Command history (only entries below history_count are ever read)
+static char cli_history[CLI_HISTORY_SIZE][CLI_BUFFER_SIZE] MEM_RAM_BUFFER(cli_history);
 static int history_count = 0;
 static int current_history_pos = -1;
 
@@ -162,7 +163,9 @@ static void cli_load_history(int direction)
     cli_puts(cli_buffer);
 }
 
-static int cli_find_matches(const char* prefix, char matches[][CLI_BUFFER_SIZE], int max_matches)
+// Matches are returned as indices into cli_commands rather than copies, which
+// keeps tab completion from putting ~1.3 KB on a 1 KB stack
+static int cli_find_matches(const char* prefix, uint8_t matches[], int max_matches)
 {
     int match_count = 0;
     int prefix_len = strlen(prefix);
@@ -174,7 +177,7 @@ static int cli_find_matches(const char* prefix, char matches[][CLI_BUFFER_SIZE],
     {
         if (strncmp(prefix, cli_commands[i].name, prefix_len) == 0)
         {
-            strcpy(matches[match_count], cli_commands[i].name);
+            matches[match_count] = (uint8_t)i;
             match_count++;
         }
     }
@@ -206,8 +209,8 @@ static void cli_tab_complete(void)
         return;
     }
     
-    char matches[10][CLI_BUFFER_SIZE];
-    int match_count = cli_find_matches(current_word, matches, 10);
+    uint8_t matches[CLI_MAX_MATCHES];
+    int match_count = cli_find_matches(current_word, matches, CLI_MAX_MATCHES);
     
     if (match_count == 0)
     {
@@ -215,8 +218,10 @@ static void cli_tab_complete(void)
     }
     else if (match_count == 1)
     {
+        const char *match = cli_commands[matches[0]].name;
+
         // Check if already complete
-        if (strcmp(current_word, matches[0]) == 0)
+        if (strcmp(current_word, match) == 0)
         {
             return;
         }
@@ -228,9 +233,9 @@ static void cli_tab_complete(void)
             cli_puts("\b \b");
         }
         
-        strcpy(&cli_buffer[word_start], matches[0]);
-        cli_index = word_start + strlen(matches[0]);
-        cli_puts(matches[0]);
+        strcpy(&cli_buffer[word_start], match);
+        cli_index = word_start + strlen(match);
+        cli_puts(match);
         
         // Add space after completion
         if (cli_index == strlen(cli_buffer))
@@ -242,6 +247,8 @@ static void cli_tab_complete(void)
     }
     else
     {
+        const char *first = cli_commands[matches[0]].name;
+
         // Multiple matches - show them
         if (cli_putchar_fn != NULL)
         {
@@ -251,7 +258,7 @@ static void cli_tab_complete(void)
         
         for (int i = 0; i < match_count; i++)
         {
-            cli_puts(matches[i]);
+            cli_puts(cli_commands[matches[i]].name);
             if (i < match_count - 1)
                 cli_puts("  ");
         }
@@ -263,12 +270,12 @@ static void cli_tab_complete(void)
         }
         
         // Find common prefix
-        int common_len = strlen(matches[0]);
+        int common_len = strlen(first);
         for (int i = 1; i < match_count; i++)
         {
             int j = 0;
-            while (j < common_len && j < (int)strlen(matches[i]) && 
-                   matches[0][j] == matches[i][j])
+            while (j < common_len && j < (int)strlen(cli_commands[matches[i]].name) && 
+                   first[j] == cli_commands[matches[i]].name[j])
             {
                 j++;
             }
@@ -284,7 +291,7 @@ static void cli_tab_complete(void)
                 cli_buffer[cli_index] = '\0';
             }
             
-            strncpy(&cli_buffer[word_start], matches[0], common_len);
+            strncpy(&cli_buffer[word_start], first, common_len);
             cli_buffer[word_start + common_len] = '\0';
             cli_index = word_start + common_len;
         }
@@ -295,6 +302,7 @@ static void cli_tab_complete(void)
     }
 }
 
+MEM_RAMFUNC(RAMFUNC_CLI, cli_parse_and_execute)
 static void cli_parse_and_execute(const char *cmd)
 {
     if (strlen(cmd) == 0) return;
@@ -307,11 +315,13 @@ static void cli_parse_and_execute(const char *cmd)
     char *argv[CLI_MAX_ARGS];
     int argc = 0;
     
-    char *token = strtok(cmd_copy, " ");
+    // strtok_r: newlib's strtok lazily mallocs its reent state
+    char *save = NULL;
+    char *token = strtok_r(cmd_copy, " ", &save);
     while (token != NULL && argc < CLI_MAX_ARGS)
     {
         argv[argc++] = token;
-        token = strtok(NULL, " ");
+        token = strtok_r(NULL, " ", &save);
     }
     
     if (argc == 0) return;
@@ -371,6 +381,11 @@ void cli_init(const cli_config_t *config)
     cli_prompt();
 }
 
+void cli_execute(const char *cmd)
+{
+    cli_parse_and_execute(cmd);
+}
+
 void cli_update(void)
 {
     while (true)
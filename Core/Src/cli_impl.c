@@ -29,7 +29,29 @@
 #include "cli_impl.h"
 #include "cli.h"
 #include "usart.h"
-#include <stdio.h>
+#include "uart_tx.h"
+#include "fmt.h"
+#include "anc.h"
+#include "autorange.h"
+#include "health.h"
+#include "boot.h"
+#include "capture.h"
+#include "control.h"
+#include "dsp_bench.h"
+#include "envelope.h"
+#include "fsync.h"
+#include "i2c_trace.h"
+#include "driver_mpu6050_basic.h"
+#include "imu_replay.h"
+#include "imu_event.h"
+#include "imu_sample.h"
+#include "mfcc.h"
+#include "pipeline.h"
+#include "scratch.h"
+#include "timer_module.h"
+#include "timesync.h"
+#include "util.h"
+#include "xcorr.h"
 #include <string.h>
 #include <stdlib.h>
 #include <stdbool.h>
@@ -76,6 +98,92 @@ static cli_var_t cli_vars[] = {
 
     // imu logging to console
     {"imulog",        "Enable imu logging to console",   VAR_BOOL,  &imu_logging_enabled},
+
+    // adaptive noise cancellation, applied by "anc on"
+    {"ancmu",    "ANC NLMS step size (0..1)",          VAR_FLOAT, &anc_config.mu},
+    {"anctaps",  "ANC filter taps (1..32)",            VAR_INT,   &anc_config.taps},
+    {"ancref",   "ANC reference (0-2 acc,3-5 gyr,6 ext)", VAR_INT, &anc_config.ref},
+    {"ancq",     "ANC fixed point format (15 or 31)",  VAR_INT,   &anc_config.qbits},
+
+    // cross-correlation, applied by "xcorr on"
+    {"xcorra",   "XCORR channel a (0-2 acc,3-5 gyr)",  VAR_INT,   &xcorr_config.a},
+    {"xcorrb",   "XCORR channel b, lag > 0 if b later", VAR_INT,  &xcorr_config.b},
+    {"xcorrn",   "XCORR block length (16..512, even)", VAR_INT,   &xcorr_config.n},
+    {"xcorrlag", "XCORR max lag in samples (<= n/4)",  VAR_INT,   &xcorr_config.maxlag},
+    {"xcorrlog", "Print every XCORR summary",          VAR_BOOL,  &xcorr_config.log},
+
+    // envelope spectrum, applied by "env on"
+    {"envch",    "ENV channel (0-2 acc,3-5 gyr)",      VAR_INT,   &envelope_config.channel},
+    {"envlo",    "ENV band-pass low edge in Hz",       VAR_FLOAT, &envelope_config.band_lo},
+    {"envhi",    "ENV band-pass high edge in Hz",      VAR_FLOAT, &envelope_config.band_hi},
+    {"envdec",   "ENV decimation factor (1..16)",      VAR_INT,   &envelope_config.dec},
+    {"envn",     "ENV FFT length (64, 128, 256)",      VAR_INT,   &envelope_config.n},
+    {"envlog",   "Print the peaks of every spectrum",  VAR_BOOL,  &envelope_config.log},
+
+    // MFCC features, applied by "mfcc on"
+    {"mfccch",   "MFCC channel (0-2 acc,3-5 gyr)",     VAR_INT,   &mfcc_config.channel},
+    {"mfccn",    "MFCC frame length (64, 128, 256)",   VAR_INT,   &mfcc_config.n},
+    {"mfccmel",  "MFCC mel filters (2..32, <= n/2)",   VAR_INT,   &mfcc_config.mels},
+    {"mfcccoef", "MFCC coefficients (1..16, <= mels)", VAR_INT,   &mfcc_config.coeffs},
+    {"mfccq",    "MFCC fixed point format (15 or 31)", VAR_INT,   &mfcc_config.qbits},
+    {"mfcclog",  "Print every MFCC feature vector",    VAR_BOOL,  &mfcc_config.log},
+
+    // PID loops to TIM3 PWM, applied by "pid on" (setpoints and gains live)
+    {"pidn",     "PID loops, loop i drives TIM3 CH i+1", VAR_INT, &control_config.loops},
+    {"piddiv",   "PID runs every n-th sample (1..100)", VAR_INT,  &control_config.div},
+    {"pidq",     "PID format (0 f32, 31 q31)",         VAR_INT,   &control_config.qbits},
+    {"pidlog",   "Print every PID step",               VAR_BOOL,  &control_config.log},
+    {"pid0in",   "PID0 input (0-5 imu,6 roll,7 pitch)", VAR_INT, &control_config.loop[0].input},
+    {"pid0sp",   "PID0 setpoint, input units",        VAR_FLOAT, &control_config.loop[0].setpoint},
+    {"pid0kp",   "PID0 proportional gain, per unit",  VAR_FLOAT, &control_config.loop[0].kp},
+    {"pid0ki",   "PID0 integral gain, per step",      VAR_FLOAT, &control_config.loop[0].ki},
+    {"pid0kd",   "PID0 derivative gain, per step",    VAR_FLOAT, &control_config.loop[0].kd},
+    {"pid1in",   "PID1 input (0-5 imu,6 roll,7 pitch)", VAR_INT, &control_config.loop[1].input},
+    {"pid1sp",   "PID1 setpoint, input units",        VAR_FLOAT, &control_config.loop[1].setpoint},
+    {"pid1kp",   "PID1 proportional gain, per unit",  VAR_FLOAT, &control_config.loop[1].kp},
+    {"pid1ki",   "PID1 integral gain, per step",      VAR_FLOAT, &control_config.loop[1].ki},
+    {"pid1kd",   "PID1 derivative gain, per step",    VAR_FLOAT, &control_config.loop[1].kd},
+    {"pid2in",   "PID2 input (0-5 imu,6 roll,7 pitch)", VAR_INT, &control_config.loop[2].input},
+    {"pid2sp",   "PID2 setpoint, input units",        VAR_FLOAT, &control_config.loop[2].setpoint},
+    {"pid2kp",   "PID2 proportional gain, per unit",  VAR_FLOAT, &control_config.loop[2].kp},
+    {"pid2ki",   "PID2 integral gain, per step",      VAR_FLOAT, &control_config.loop[2].ki},
+    {"pid2kd",   "PID2 derivative gain, per step",    VAR_FLOAT, &control_config.loop[2].kd},
+    {"pid3in",   "PID3 input (0-5 imu,6 roll,7 pitch)", VAR_INT, &control_config.loop[3].input},
+    {"pid3sp",   "PID3 setpoint, input units",        VAR_FLOAT, &control_config.loop[3].setpoint},
+    {"pid3kp",   "PID3 proportional gain, per unit",  VAR_FLOAT, &control_config.loop[3].kp},
+    {"pid3ki",   "PID3 integral gain, per step",      VAR_FLOAT, &control_config.loop[3].ki},
+    {"pid3kd",   "PID3 derivative gain, per step",    VAR_FLOAT, &control_config.loop[3].kd},
+
+    // Event capture (applied by "capture on")
+    {"cappre",   "CAPTURE window before trigger, ms",  VAR_INT,   &capture_config.pre_ms},
+    {"cappost",  "CAPTURE window after trigger, ms",   VAR_INT,   &capture_config.post_ms},
+    {"capthr",   "CAPTURE trigger on ||a|-1g| > g, 0 off", VAR_FLOAT, &capture_config.threshold},
+
+    // Auto-ranging, applied by "range on"
+    {"rngacc",   "RANGE auto-range the accelerometer", VAR_BOOL,  &autorange_config.accel},
+    {"rnggyr",   "RANGE auto-range the gyroscope",     VAR_BOOL,  &autorange_config.gyro},
+    {"rngup",    "RANGE switch up at this full scale fraction", VAR_FLOAT, &autorange_config.up},
+    {"rngdown",  "RANGE switch down below this (< rngup)", VAR_FLOAT, &autorange_config.down},
+    {"rnghold",  "RANGE time below rngdown to switch, ms", VAR_INT, &autorange_config.hold_ms},
+    {"rnglog",   "Print every RANGE switch",           VAR_BOOL,  &autorange_config.log},
+
+    // Sensor events (DMP tap/orient, pedometer, interrupts)
+    {"evsteps",  "EVENTS pedometer poll interval, ms, 0 off", VAR_INT, &imu_event_config.step_ms},
+    {"evlog",    "Print every sensor event",           VAR_BOOL,  &imu_event_config.log},
+
+    // External FSYNC trigger
+    {"fsynclog", "Print every FSYNC event",            VAR_BOOL,  &fsync_config.log},
+
+    // Sensor health, applied by "health reset"
+    {"hltstuck", "HEALTH samples unchanged = stuck, 0 off", VAR_INT, &health_config.stuck},
+    {"hltnoise", "HEALTH noise floor RMS ratio (> 1), 0 off", VAR_FLOAT, &health_config.noise},
+    {"hltrate",  "HEALTH interval deviation (< 1), 0 off", VAR_FLOAT, &health_config.rate},
+    {"hltlearn", "HEALTH samples to learn baselines",  VAR_INT,   &health_config.learn},
+    {"hltlog",   "Print every HEALTH flag change",     VAR_BOOL,  &health_config.log},
+
+    // Host time sync
+    {"syncgate", "SYNC us over the minimum delay an exchange may take", VAR_INT, &timesync_config.gate},
+    {"synclock", "SYNC exchanges before imulog is in host time", VAR_INT, &timesync_config.lock},
 };
 
 #define NUM_VARS (sizeof(cli_vars) / sizeof(cli_vars[0]))
@@ -95,7 +203,7 @@ static uint16_t cli_last_processed = 0;
 
 static void cli_uart_putchar_impl(char c)
 {
-    HAL_UART_Transmit(&huart2, (uint8_t*)&c, 1, HAL_MAX_DELAY);
+    uart_tx_putc(c);
 }
 
 static int cli_uart_getchar_impl(void)
@@ -121,10 +229,7 @@ static int cli_uart_getchar_impl(void)
 
 static void cli_puts(const char *s)
 {
-    while (*s)
-    {
-        cli_uart_putchar_impl(*s++);
-    }
+    uart_tx_write((const uint8_t*)s, strlen(s));
 }
 
 // =============================================================================
@@ -144,6 +249,12 @@ void cli_cmd_vars(int argc, char *argv[]);
 // Helper Functions
 // =============================================================================
 
+// DWT cycles at the current core clock
+static float cli_cycles_to_us(float cycles)
+{
+    return cycles * (1e6f / (float)SystemCoreClock);
+}
+
 static void cli_print_var_value(int var_index)
 {
     char buffer[32];
@@ -164,11 +275,11 @@ static void cli_print_var_value(int var_index)
             }
             break;
         case VAR_INT:
-            len = snprintf(buffer, sizeof(buffer), "%ld", *(int32_t*)cli_vars[var_index].ptr);
+            len = fmt_snprintf(buffer, sizeof(buffer), "%ld", (long)*(int32_t*)cli_vars[var_index].ptr);
             cli_puts(buffer);
             break;
         case VAR_FLOAT:
-            len = snprintf(buffer, sizeof(buffer), "%.3f", *(float*)cli_vars[var_index].ptr);
+            len = fmt_snprintf(buffer, sizeof(buffer), "%.3f", *(float*)cli_vars[var_index].ptr);
             cli_puts(buffer);
             break;
         case VAR_STRING:
@@ -200,6 +311,26 @@ void cli_cmd_help(int argc, char *argv[])
     cli_puts("  list              - List all variables with descriptions\r\n");
     cli_puts("  get <var>         - Get variable value\r\n");
     cli_puts("  set <var> <val>   - Set variable value\r\n");
+    cli_puts("  bench dsp [reps]  - Benchmark CMSIS-DSP kernels (stalls the main loop)\r\n");
+    cli_puts("  bench hot [reps]  - Cycles of the per-sample hot path, RAM or flash\r\n");
+    cli_puts("  replay [rt]       - Replay the flash recording through imu_process\r\n");
+    cli_puts("  anc [on|off]      - Adaptive noise cancellation, no argument shows metrics\r\n");
+    cli_puts("  xcorr [on|off]    - Channel cross-correlation, no argument shows summary\r\n");
+    cli_puts("  env [on|off|spec] - Envelope spectrum, no argument shows peaks\r\n");
+    cli_puts("  mfcc [on|off|ref] - MFCC features, ref stores the reference vector\r\n");
+    cli_puts("  pid [on|off]      - PID loops to TIM3 PWM, no argument shows loops and latency\r\n");
+    cli_puts("  imu               - Latest published IMU sample and snapshot retries\r\n");
+    cli_puts("  capture [on|off|trigger|dump] - Pre-trigger event window, dump streams it binary\r\n");
+    cli_puts("  range [on|off]    - Accel/gyro auto-ranging, no argument shows clips and dwell\r\n");
+    cli_puts("  events            - Sensor events (tap, orient, steps, motion) since last call\r\n");
+    cli_puts("  fsync [on|off]    - FSYNC trigger tagging, no argument shows edge offsets\r\n");
+    cli_puts("  i2ctrace [ring|clear|run <cmd>] - I2C transactions per register, run counts one command\r\n");
+    cli_puts("  reg read <addr> [n] [bin] - Burst read of sensor registers, hex or binary frame\r\n");
+    cli_puts("  reg write <addr> <byte>.. - Burst write, read back\r\n");
+    cli_puts("  reg dump [bin]    - All 128 sensor registers as one frame\r\n");
+    cli_puts("  boot              - Boot phase timing from reset to the first sample\r\n");
+    cli_puts("  health [on|off|reset] - Sensor health checks, reset learns the baselines again\r\n");
+    cli_puts("  sync [reset]      - Host time sync (tools/timesync.py), no argument shows offset and skew\r\n");
     cli_puts("\r\nNavigation:\r\n");
     cli_puts("  Up/Down arrows    - Navigate command history\r\n");
     cli_puts("  Tab               - Auto-complete commands\r\n");
@@ -216,7 +347,7 @@ void cli_cmd_info(int argc, char *argv[])
     cli_puts("Version:      2.0.0 (Modular)\r\n");
     char buffer[16];
     cli_puts("Variables:    ");
-    snprintf(buffer, sizeof(buffer), "%d\r\n", (int)NUM_VARS);
+    fmt_snprintf(buffer, sizeof(buffer), "%d\r\n", (int)NUM_VARS);
     cli_puts(buffer);
     cli_puts("Commands:     help, list, get, set, status, reset, info\r\n");
 }
@@ -232,7 +363,7 @@ void cli_cmd_status(int argc, char *argv[])
     cli_puts("\r\nLED State:    ");
     cli_puts(led_mode == 0 ? "OFF" : (led_mode == 1 ? "ON" : "BLINKING"));
     cli_puts("\r\nLED Blink Rate: ");
-    snprintf(buffer, sizeof(buffer), "%.1f Hz\r\n", led_blink_rate);
+    fmt_snprintf(buffer, sizeof(buffer), "%.1f Hz\r\n", led_blink_rate);
     cli_puts(buffer);
     cli_puts("\r\nIMU Logging:      ");
     cli_puts(imu_logging_enabled ? "ACTIVE" : "STOPPED");
@@ -330,7 +461,7 @@ void cli_cmd_set(int argc, char *argv[])
                 }
                 
                 case VAR_FLOAT:
-                    *(float*)cli_vars[i].ptr = atof(argv[2]);
+                    *(float*)cli_vars[i].ptr = fmt_strtof(argv[2], NULL);
                     break;
                     
                 case VAR_STRING:
@@ -449,6 +580,988 @@ void cli_cmd_flashdump(int argc, char *argv[])
     cli_puts(" (Not really, this is a placeholder)\r\n");
 }
 
+void cli_cmd_bench(int argc, char *argv[])
+{
+    if (argc < 2)
+    {
+        cli_puts("Usage: bench dsp|hot [reps]\r\n");
+        return;
+    }
+
+    if (strcmp(argv[1], "dsp") == 0)
+    {
+        uint32_t reps = (argc > 2) ? (uint32_t)atoi(argv[2]) : 0;
+        dsp_bench_run(cli_puts, reps);
+    }
+    else if (strcmp(argv[1], "hot") == 0)
+    {
+        uint32_t reps = (argc > 2) ? (uint32_t)atoi(argv[2]) : 0;
+        dsp_bench_hot(cli_puts, reps);
+    }
+    else
+    {
+        cli_puts("Unknown benchmark: ");
+        cli_puts(argv[1]);
+        cli_puts("\r\n");
+    }
+}
+
+// Same stages as the main loop, so they see the recording too
+static void cli_replay_sink(imu_t *imu, void *ctx)
+{
+    (void)ctx;
+
+    pipeline_process(imu);
+}
+
+void cli_cmd_replay(int argc, char *argv[])
+{
+    const uint8_t *image;
+    size_t size;
+
+    if (imu_replay_flash_slot(&image, &size) != 0 || imu_replay_open(image, size) != 0)
+    {
+        cli_puts("No recording in the replay slot\r\n");
+        return;
+    }
+
+    imu_replay_pace_t pace = (argc > 1 && strcmp(argv[1], "rt") == 0) ? IMU_REPLAY_REALTIME : IMU_REPLAY_MAX_SPEED;
+    imu_replay_stats_t stats;
+    imu_t imu;
+    uint16_t rate = pipeline_rate_hz();
+    pipeline_set_rate_hz(imu_replay_rate_hz());
+    int res = imu_replay_run(&imu, pace, cli_replay_sink, NULL, &stats);
+    pipeline_set_rate_hz(rate);
+    imu_replay_close();
+
+    char buffer[96];
+    fmt_snprintf(buffer, sizeof(buffer), "%lu samples in %lu us, %lu samples/s, crc32 0x%08lx%s\r\n",
+                 (unsigned long)stats.samples, (unsigned long)stats.elapsed_us,
+                 (unsigned long)stats.samples_per_s, (unsigned long)stats.crc,
+                 res != 0 ? " (aborted)" : "");
+    cli_puts(buffer);
+}
+
+static void cli_anc_metrics(void)
+{
+    anc_metrics_t m;
+    char buffer[96];
+    static const char *const axis_names[3] = {"ax", "ay", "az"};
+
+    anc_get_metrics(&m);
+    fmt_snprintf(buffer, sizeof(buffer), "ANC %s: q%d, %d taps, mu %.3f, ref %s, %lu samples\r\n",
+                 anc_enabled() ? "on" : "off", m.active.qbits, m.active.taps, m.active.mu,
+                 anc_ref_name(m.active.ref), (unsigned long)m.samples);
+    cli_puts(buffer);
+    if (m.samples == 0)
+    {
+        return;
+    }
+
+    cli_puts("axis    in rms   out rms  atten dB  converged\r\n");
+    for (int a = 0; a < 3; a++)
+    {
+        if (!m.axis_active[a])
+        {
+            fmt_snprintf(buffer, sizeof(buffer), "%-4s    (reference)\r\n", axis_names[a]);
+        }
+        else if (m.axis[a].converged_at != 0)
+        {
+            fmt_snprintf(buffer, sizeof(buffer), "%-4s %9.4f %9.4f %9.1f  after %lu\r\n", axis_names[a],
+                         m.axis[a].in_rms, m.axis[a].out_rms, m.axis[a].atten_db,
+                         (unsigned long)m.axis[a].converged_at);
+        }
+        else
+        {
+            fmt_snprintf(buffer, sizeof(buffer), "%-4s %9.4f %9.4f %9.1f  no\r\n", axis_names[a],
+                         m.axis[a].in_rms, m.axis[a].out_rms, m.axis[a].atten_db);
+        }
+        cli_puts(buffer);
+    }
+
+    fmt_snprintf(buffer, sizeof(buffer), "cycles/sample: last %lu, min %lu, max %lu, avg %lu\r\n",
+                 (unsigned long)m.cycles_last, (unsigned long)m.cycles_min,
+                 (unsigned long)m.cycles_max, (unsigned long)m.cycles_avg);
+    cli_puts(buffer);
+}
+
+void cli_cmd_anc(int argc, char *argv[])
+{
+    if (argc < 2)
+    {
+        cli_anc_metrics();
+        return;
+    }
+
+    if (strcmp(argv[1], "on") == 0)
+    {
+        if (anc_enable() != 0)
+        {
+            cli_puts("ANC: invalid settings or scratch arena in use by ");
+            cli_puts(scratch_owner_name(scratch_owner()));
+            cli_puts("\r\n");
+            return;
+        }
+        cli_anc_metrics();
+    }
+    else if (strcmp(argv[1], "off") == 0)
+    {
+        anc_disable();
+        cli_puts("ANC off\r\n");
+    }
+    else
+    {
+        cli_puts("Usage: anc [on|off]\r\n");
+    }
+}
+
+static void cli_xcorr_summary(void)
+{
+    xcorr_config_t cfg;
+    xcorr_summary_t xs;
+    char buffer[96];
+
+    xcorr_get_active(&cfg);
+    xcorr_get_summary(&xs);
+    fmt_snprintf(buffer, sizeof(buffer), "XCORR %s: %s vs %s, n %d, lag +-%d, %lu blocks\r\n",
+                 xcorr_enabled() ? "on" : "off", imu_channel_name(cfg.a), imu_channel_name(cfg.b),
+                 cfg.n, cfg.maxlag, (unsigned long)xs.blocks);
+    cli_puts(buffer);
+    if (xs.blocks == 0)
+    {
+        return;
+    }
+
+    fmt_snprintf(buffer, sizeof(buffer), "lag %.2f samples (%.0f us), rho %.3f\r\n",
+                 xs.lag, xs.lag * 1e6f / (float)pipeline_rate_hz(), xs.rho);
+    cli_puts(buffer);
+    fmt_snprintf(buffer, sizeof(buffer), "cycles/block: last %lu, max %lu\r\n",
+                 (unsigned long)xs.cycles, (unsigned long)xs.cycles_max);
+    cli_puts(buffer);
+}
+
+void cli_cmd_xcorr(int argc, char *argv[])
+{
+    if (argc < 2)
+    {
+        cli_xcorr_summary();
+        return;
+    }
+
+    if (strcmp(argv[1], "on") == 0)
+    {
+        if (xcorr_enable() != 0)
+        {
+            cli_puts("XCORR: invalid settings or scratch arena in use by ");
+            cli_puts(scratch_owner_name(scratch_owner()));
+            cli_puts("\r\n");
+            return;
+        }
+        cli_xcorr_summary();
+    }
+    else if (strcmp(argv[1], "off") == 0)
+    {
+        xcorr_disable();
+        cli_puts("XCORR off\r\n");
+    }
+    else
+    {
+        cli_puts("Usage: xcorr [on|off]\r\n");
+    }
+}
+
+static void cli_env_summary(void)
+{
+    envelope_config_t cfg;
+    envelope_summary_t es;
+    char buffer[96];
+
+    envelope_get_active(&cfg);
+    envelope_get_summary(&es);
+    fmt_snprintf(buffer, sizeof(buffer), "ENV %s: %s, %.1f-%.1f Hz, dec %d, n %d, %lu B, %lu spectra\r\n",
+                 envelope_enabled() ? "on" : "off", imu_channel_name(cfg.channel), cfg.band_lo, cfg.band_hi,
+                 cfg.dec, cfg.n, (unsigned long)es.ram_bytes, (unsigned long)es.spectra);
+    cli_puts(buffer);
+    if (es.spectra == 0)
+    {
+        return;
+    }
+
+    for (int p = 0; p < ENVELOPE_PEAKS; p++)
+    {
+        fmt_snprintf(buffer, sizeof(buffer), "peak %d: %7.2f Hz  %.4f\r\n", p + 1, es.peak[p].freq, es.peak[p].amp);
+        cli_puts(buffer);
+    }
+    fmt_snprintf(buffer, sizeof(buffer), "cycles: chain %lu/sample, spectrum %lu\r\n",
+                 (unsigned long)es.chain_cycles, (unsigned long)es.fft_cycles);
+    cli_puts(buffer);
+}
+
+void cli_cmd_env(int argc, char *argv[])
+{
+    if (argc < 2)
+    {
+        cli_env_summary();
+        return;
+    }
+
+    if (strcmp(argv[1], "on") == 0)
+    {
+        if (envelope_enable() != 0)
+        {
+            cli_puts("ENV: invalid settings for this rate or scratch arena in use by ");
+            cli_puts(scratch_owner_name(scratch_owner()));
+            cli_puts("\r\n");
+            return;
+        }
+        cli_env_summary();
+    }
+    else if (strcmp(argv[1], "off") == 0)
+    {
+        envelope_disable();
+        cli_puts("ENV off\r\n");
+    }
+    else if (strcmp(argv[1], "spec") == 0)
+    {
+        envelope_config_t cfg;
+        envelope_summary_t es;
+        char buffer[48];
+
+        envelope_get_active(&cfg);
+        envelope_get_summary(&es);
+        for (uint32_t k = 0; es.spectra > 0 && k <= (uint32_t)cfg.n / 2; k++)
+        {
+            fmt_snprintf(buffer, sizeof(buffer), "%3lu %8.3f %.5f\r\n", (unsigned long)k,
+                         (float)k * es.bin_hz, envelope_bin(k));
+            cli_puts(buffer);
+            uart_tx_flush();
+        }
+    }
+    else
+    {
+        cli_puts("Usage: env [on|off|spec]\r\n");
+    }
+}
+
+static void cli_mfcc_summary(void)
+{
+    mfcc_config_t cfg;
+    mfcc_summary_t ms;
+    char buffer[96];
+
+    mfcc_get_active(&cfg);
+    mfcc_get_summary(&ms);
+    fmt_snprintf(buffer, sizeof(buffer), "MFCC %s: %s, n %d, %d mels, %d coeffs, q%d, %lu B, %lu frames\r\n",
+                 mfcc_enabled() ? "on" : "off", imu_channel_name(cfg.channel), cfg.n, cfg.mels,
+                 cfg.coeffs, cfg.qbits, (unsigned long)ms.ram_bytes, (unsigned long)ms.frames);
+    cli_puts(buffer);
+    if (ms.frames == 0)
+    {
+        return;
+    }
+
+    cli_puts("c:");
+    for (int k = 0; k < cfg.coeffs; k++)
+    {
+        fmt_snprintf(buffer, sizeof(buffer), " %.2f", ms.features[k]);
+        cli_puts(buffer);
+    }
+    cli_puts("\r\n");
+    if (ms.reference)
+    {
+        fmt_snprintf(buffer, sizeof(buffer), "distance to reference %.3f\r\n", ms.distance);
+        cli_puts(buffer);
+    }
+    fmt_snprintf(buffer, sizeof(buffer), "cycles/frame: last %lu, max %lu\r\n",
+                 (unsigned long)ms.cycles, (unsigned long)ms.cycles_max);
+    cli_puts(buffer);
+}
+
+void cli_cmd_mfcc(int argc, char *argv[])
+{
+    if (argc < 2)
+    {
+        cli_mfcc_summary();
+        return;
+    }
+
+    if (strcmp(argv[1], "on") == 0)
+    {
+        if (mfcc_enable() != 0)
+        {
+            cli_puts("MFCC: invalid settings or scratch arena in use by ");
+            cli_puts(scratch_owner_name(scratch_owner()));
+            cli_puts("\r\n");
+            return;
+        }
+        cli_mfcc_summary();
+    }
+    else if (strcmp(argv[1], "off") == 0)
+    {
+        mfcc_disable();
+        cli_puts("MFCC off\r\n");
+    }
+    else if (strcmp(argv[1], "ref") == 0)
+    {
+        cli_puts((mfcc_set_reference() == 0) ? "MFCC reference stored\r\n" : "MFCC: no frame yet\r\n");
+    }
+    else
+    {
+        cli_puts("Usage: mfcc [on|off|ref]\r\n");
+    }
+}
+
+static void cli_pid_summary(void)
+{
+    control_config_t cfg;
+    control_summary_t cs;
+    char buffer[96];
+
+    control_get_active(&cfg);
+    control_get_summary(&cs);
+    fmt_snprintf(buffer, sizeof(buffer), "PID %s: %d loops, %s, %u Hz, %lu steps\r\n",
+                 control_enabled() ? "on" : "off", cfg.loops, (cfg.qbits == 31) ? "q31" : "f32",
+                 (unsigned)(pipeline_rate_hz() / ((cfg.div > 0) ? cfg.div : 1)), (unsigned long)cs.steps);
+    cli_puts(buffer);
+    if (cs.steps == 0)
+    {
+        return;
+    }
+
+    for (int i = 0; i < cfg.loops; i++)
+    {
+        fmt_snprintf(buffer, sizeof(buffer), "loop %d: %-5s sp %8.3f in %8.3f u %+.3f duty %.3f\r\n",
+                     i, control_input_name(cfg.loop[i].input), control_config.loop[i].setpoint,
+                     cs.input[i], cs.output[i], pwm_duty(i));
+        cli_puts(buffer);
+    }
+    fmt_snprintf(buffer, sizeof(buffer), "latency us: last %.1f, avg %.1f, max %.1f\r\n",
+                 cli_cycles_to_us(cs.latency), cli_cycles_to_us(cs.latency_avg), cli_cycles_to_us(cs.latency_max));
+    cli_puts(buffer);
+    if (cs.steps > 1)
+    {
+        fmt_snprintf(buffer, sizeof(buffer), "period us: min %.0f, max %.0f\r\n",
+                     cli_cycles_to_us(cs.period_min), cli_cycles_to_us(cs.period_max));
+        cli_puts(buffer);
+    }
+    if (cs.gains_rejected > 0)
+    {
+        fmt_snprintf(buffer, sizeof(buffer), "%lu gain changes rejected (q31 range)\r\n",
+                     (unsigned long)cs.gains_rejected);
+        cli_puts(buffer);
+    }
+}
+
+void cli_cmd_pid(int argc, char *argv[])
+{
+    if (argc < 2)
+    {
+        cli_pid_summary();
+        return;
+    }
+
+    if (strcmp(argv[1], "on") == 0)
+    {
+        if (control_enable() != 0)
+        {
+            cli_puts("PID: invalid settings\r\n");
+            return;
+        }
+        cli_pid_summary();
+    }
+    else if (strcmp(argv[1], "off") == 0)
+    {
+        control_disable();
+        cli_puts("PID off\r\n");
+    }
+    else
+    {
+        cli_puts("Usage: pid [on|off]\r\n");
+    }
+}
+
+void cli_cmd_imu(int argc, char *argv[])
+{
+    (void)argc;
+    (void)argv;
+    imu_sample_t sample;
+    imu_sample_stats_t st;
+    char buffer[96];
+
+    if (imu_sample_snapshot(&sample) != 0)
+    {
+        cli_puts("No IMU sample published yet\r\n");
+        return;
+    }
+    imu_sample_get_stats(&st);
+
+    fmt_snprintf(buffer, sizeof(buffer), "%s sample %lu, read %.0f us ago\r\n", imu_backend_name(),
+                 (unsigned long)sample.seq, cli_cycles_to_us(DWT->CYCCNT - sample.cycles));
+    cli_puts(buffer);
+    fmt_snprintf(buffer, sizeof(buffer), "acc %8.3f %8.3f %8.3f m/s^2\r\n",
+                 sample.imu.acc[0], sample.imu.acc[1], sample.imu.acc[2]);
+    cli_puts(buffer);
+    fmt_snprintf(buffer, sizeof(buffer), "gyr %8.3f %8.3f %8.3f dps\r\n",
+                 sample.imu.gyr[0], sample.imu.gyr[1], sample.imu.gyr[2]);
+    cli_puts(buffer);
+    fmt_snprintf(buffer, sizeof(buffer), "range +-%u g +-%u dps, %u switches\r\n", 2u << sample.range.accel,
+                 250u << sample.range.gyro, (unsigned)sample.range.switches);
+    cli_puts(buffer);
+    fmt_snprintf(buffer, sizeof(buffer), "%lu snapshots, %lu retries (max %lu)\r\n",
+                 (unsigned long)st.snapshots, (unsigned long)st.retries, (unsigned long)st.retries_max);
+    cli_puts(buffer);
+}
+
+static void cli_capture_summary(void)
+{
+    static const char *const states[] = {"off", "armed", "post-trigger", "frozen", "streaming"};
+    capture_summary_t cs;
+    char buffer[96];
+
+    capture_get_summary(&cs);
+    fmt_snprintf(buffer, sizeof(buffer), "CAPTURE %s, %lu samples\r\n", states[cs.state],
+                 (unsigned long)cs.samples);
+    cli_puts(buffer);
+    if (cs.trigger == CAPTURE_TRIGGER_NONE)
+    {
+        return;
+    }
+    fmt_snprintf(buffer, sizeof(buffer), "trigger %s at sample %lu, %u + 1 + %u frames at %u Hz\r\n",
+                 capture_trigger_name(cs.trigger), (unsigned long)cs.trigger_sample,
+                 (unsigned)cs.pre, (unsigned)cs.post, (unsigned)cs.rate_hz);
+    cli_puts(buffer);
+    if (cs.state == CAPTURE_FROZEN || cs.state == CAPTURE_STREAMING)
+    {
+        fmt_snprintf(buffer, sizeof(buffer), "peak %.2f g, streamed %lu of %lu bytes\r\n", cs.peak,
+                     (unsigned long)cs.streamed, (unsigned long)cs.stream_size);
+        cli_puts(buffer);
+    }
+}
+
+void cli_cmd_capture(int argc, char *argv[])
+{
+    if (argc < 2)
+    {
+        cli_capture_summary();
+        return;
+    }
+
+    if (strcmp(argv[1], "on") == 0)
+    {
+        if (capture_enable() != 0)
+        {
+            cli_puts("CAPTURE: invalid settings or window larger than the ring\r\n");
+            return;
+        }
+        cli_capture_summary();
+    }
+    else if (strcmp(argv[1], "off") == 0)
+    {
+        capture_disable();
+        cli_puts("CAPTURE off\r\n");
+    }
+    else if (strcmp(argv[1], "trigger") == 0)
+    {
+        capture_trigger(CAPTURE_TRIGGER_CLI);
+    }
+    else if (strcmp(argv[1], "dump") == 0)
+    {
+        if (capture_stream() != 0)
+        {
+            cli_puts("CAPTURE: no complete window\r\n");
+        }
+    }
+    else
+    {
+        cli_puts("Usage: capture [on|off|trigger|dump]\r\n");
+    }
+}
+
+static void cli_autorange_sensor(const char *name, const autorange_sensor_t *as, unsigned base,
+                                 const char *unit, uint16_t rate_hz)
+{
+    char buffer[96];
+    fmt_snprintf(buffer, sizeof(buffer), "%s +-%u %s, %lu switches, %lu clips (%lu samples)\r\n", name,
+                 base << as->range, unit, (unsigned long)as->switches, (unsigned long)as->clips,
+                 (unsigned long)as->clipped);
+    cli_puts(buffer);
+    cli_puts("    dwell");
+    for (int i = 0; i < AUTORANGE_RANGES; i++)
+    {
+        fmt_snprintf(buffer, sizeof(buffer), " %u %s %.2f s%s", base << i, unit,
+                     (float)as->dwell[i] / (float)rate_hz, (i < AUTORANGE_RANGES - 1) ? "," : "\r\n");
+        cli_puts(buffer);
+    }
+}
+
+static void cli_autorange_summary(void)
+{
+    autorange_summary_t as;
+    char buffer[64];
+
+    autorange_get_summary(&as);
+    fmt_snprintf(buffer, sizeof(buffer), "RANGE %s, %lu samples, %lu failed\r\n",
+                 autorange_enabled() ? "on" : "off", (unsigned long)as.accel.samples,
+                 (unsigned long)as.failed);
+    cli_puts(buffer);
+    if (as.rate_hz == 0)
+    {
+        return;
+    }
+    cli_autorange_sensor("acc", &as.accel, 2, "g", as.rate_hz);
+    cli_autorange_sensor("gyr", &as.gyro, 250, "dps", as.rate_hz);
+}
+
+void cli_cmd_range(int argc, char *argv[])
+{
+    if (argc < 2)
+    {
+        cli_autorange_summary();
+        return;
+    }
+
+    if (strcmp(argv[1], "on") == 0)
+    {
+        if (autorange_enable() != 0)
+        {
+            cli_puts("RANGE: need 0 < rngdown < rngup <= 1 and rnghold >= 0\r\n");
+            return;
+        }
+        cli_autorange_summary();
+    }
+    else if (strcmp(argv[1], "off") == 0)
+    {
+        autorange_disable();
+        cli_puts("RANGE off\r\n");
+    }
+    else
+    {
+        cli_puts("Usage: range [on|off]\r\n");
+    }
+}
+
+void cli_cmd_events(int argc, char *argv[])
+{
+    (void)argc;
+    (void)argv;
+    static imu_event_reader_t reader;       // from boot, as far as the queue reaches
+    imu_event_t ev;
+    char buffer[64];
+    uint32_t n = 0;
+
+    while (imu_event_read(&reader, &ev) == 0)
+    {
+        imu_event_format(&ev, buffer, sizeof(buffer));
+        cli_puts(buffer);
+        cli_puts("\r\n");
+        n++;
+    }
+    fmt_snprintf(buffer, sizeof(buffer), "%lu new, %lu queued since boot, %lu lost\r\n", (unsigned long)n,
+                 (unsigned long)imu_event_count(), (unsigned long)reader.lost);
+    cli_puts(buffer);
+}
+
+static void cli_fsync_summary(void)
+{
+    static fsync_reader_t reader;           // from boot, as far as the events reach
+    fsync_summary_t fs;
+    fsync_event_t ev;
+    char buffer[80];
+
+    fsync_get_summary(&fs);
+    fmt_snprintf(buffer, sizeof(buffer), "FSYNC %s, %lu edges, %lu events, %lu missed, %lu orphans\r\n",
+                 fs.enabled ? "on" : "off", (unsigned long)fs.edges, (unsigned long)fs.events,
+                 (unsigned long)fs.missed, (unsigned long)fs.orphans);
+    cli_puts(buffer);
+    if (fs.events > fs.orphans)
+    {
+        fmt_snprintf(buffer, sizeof(buffer), "edge before read: last %.0f us, min %.0f us, max %.0f us\r\n",
+                     fs.offset_us, fs.offset_min_us, fs.offset_max_us);
+        cli_puts(buffer);
+    }
+    while (fsync_read(&reader, &ev) == 0)
+    {
+        if (ev.edge != 0)
+        {
+            fmt_snprintf(buffer, sizeof(buffer), "sample %lu, edge %lu, read %lu cyc\r\n",
+                         (unsigned long)ev.sample, (unsigned long)ev.edge, (unsigned long)ev.read);
+        }
+        else
+        {
+            fmt_snprintf(buffer, sizeof(buffer), "sample %lu, no edge\r\n", (unsigned long)ev.sample);
+        }
+        cli_puts(buffer);
+    }
+    if (reader.lost != 0)
+    {
+        fmt_snprintf(buffer, sizeof(buffer), "%lu events lost\r\n", (unsigned long)reader.lost);
+        cli_puts(buffer);
+    }
+}
+
+void cli_cmd_fsync(int argc, char *argv[])
+{
+    if (argc < 2)
+    {
+        cli_fsync_summary();
+        return;
+    }
+
+    if (strcmp(argv[1], "on") == 0)
+    {
+        if (fsync_enable() != 0)
+        {
+            cli_puts("FSYNC: sensor config failed\r\n");
+            return;
+        }
+        cli_fsync_summary();
+    }
+    else if (strcmp(argv[1], "off") == 0)
+    {
+        fsync_disable();
+        cli_puts("FSYNC off\r\n");
+    }
+    else
+    {
+        cli_puts("Usage: fsync [on|off]\r\n");
+    }
+}
+
+static void cli_i2c_trace_stats(void)
+{
+    i2c_trace_summary_t ts;
+    i2c_trace_stat_t st;
+    char buffer[80];
+
+    i2c_trace_get_summary(&ts);
+    fmt_snprintf(buffer, sizeof(buffer), "I2C %lu transactions, %lu bytes, %.0f us, %lu errors\r\n",
+                 (unsigned long)ts.count, (unsigned long)ts.bytes, cli_cycles_to_us(ts.cycles),
+                 (unsigned long)ts.errors);
+    cli_puts(buffer);
+    if (ts.count == 0)
+    {
+        return;
+    }
+    cli_puts("reg  dir     n  bytes   avg us   max us  err\r\n");
+    for (uint8_t i = 0; i2c_trace_get_stat(i, &st) == 0; i++)
+    {
+        fmt_snprintf(buffer, sizeof(buffer), "0x%02X %s %5lu %6lu %8.1f %8.1f %4u\r\n", st.reg,
+                     st.write ? "wr" : "rd", (unsigned long)st.count, (unsigned long)st.bytes,
+                     cli_cycles_to_us(st.cycles) / (float)st.count, cli_cycles_to_us(st.max), (unsigned)st.errors);
+        cli_puts(buffer);
+    }
+    if (ts.untracked != 0)
+    {
+        fmt_snprintf(buffer, sizeof(buffer), "%lu on other registers\r\n", (unsigned long)ts.untracked);
+        cli_puts(buffer);
+    }
+}
+
+void cli_cmd_i2ctrace(int argc, char *argv[])
+{
+    if (!i2c_trace_available())
+    {
+        cli_puts("I2CTRACE: compiled out, define ENABLE_I2C_TRACE in config.h\r\n");
+        return;
+    }
+    if (argc < 2)
+    {
+        cli_i2c_trace_stats();
+        return;
+    }
+
+    if (strcmp(argv[1], "ring") == 0)
+    {
+        i2c_trace_record_t r, newest;
+        char buffer[64];
+
+        if (i2c_trace_get_record(0, &newest) != 0)
+        {
+            cli_puts("I2CTRACE: empty\r\n");
+            return;
+        }
+        // Oldest first, start relative to the newest
+        uint32_t age = I2C_TRACE_RECORDS;
+        while (age-- > 0)
+        {
+            if (i2c_trace_get_record(age, &r) != 0)
+            {
+                continue;
+            }
+            fmt_snprintf(buffer, sizeof(buffer), "%10.1f us %s 0x%02X %3u %7.1f us%s\r\n",
+                         cli_cycles_to_us((float)(int32_t)(r.start - newest.start)),
+                         (r.flags & I2C_TRACE_WRITE) ? "wr" : "rd", r.reg, (unsigned)r.len,
+                         cli_cycles_to_us(r.cycles), (r.flags & I2C_TRACE_ERROR) ? " error" : "");
+            cli_puts(buffer);
+        }
+    }
+    else if (strcmp(argv[1], "clear") == 0)
+    {
+        i2c_trace_clear();
+        cli_puts("I2CTRACE cleared\r\n");
+    }
+    else if (strcmp(argv[1], "run") == 0 && argc > 2)
+    {
+        // Rebuild the command line; argv points into the caller's copy
+        char line[96];
+        size_t n = 0;
+        line[0] = '\0';
+        for (int i = 2; i < argc && n < sizeof(line) - 1; i++)
+        {
+            n += (size_t)fmt_snprintf(line + n, sizeof(line) - n, (i > 2) ? " %s" : "%s", argv[i]);
+        }
+        i2c_trace_clear();
+        cli_execute(line);
+        cli_i2c_trace_stats();
+    }
+    else
+    {
+        cli_puts("Usage: i2ctrace [ring|clear|run <command>]\r\n");
+    }
+}
+
+#define REG_COUNT           0x80    // MPU6050 register map
+
+/**
+ * @brief Hex lines of 16 registers, "--" for the ones not read.
+ */
+static void cli_reg_hex(uint8_t first, const uint8_t *buf, uint16_t n, const uint8_t *valid)
+{
+    char buffer[64];
+    for (uint16_t i = 0; i < n; i += 16)
+    {
+        int len = fmt_snprintf(buffer, sizeof(buffer), "0x%02X:", first + i);
+        for (uint16_t j = i; j < n && j < i + 16; j++)
+        {
+            len += (valid == NULL || valid[j])
+                ? fmt_snprintf(buffer + len, sizeof(buffer) - len, " %02X", buf[j])
+                : fmt_snprintf(buffer + len, sizeof(buffer) - len, " --");
+        }
+        cli_puts(buffer);
+        cli_puts("\r\n");
+    }
+}
+
+/**
+ * @brief One binary frame, like a capture dump:
+ *        "reg 0x<first>: <n> bytes\r\n" <n bytes> <crc32 LE>
+ */
+static void cli_reg_frame(uint8_t first, const uint8_t *buf, uint16_t n)
+{
+    char line[32];
+    uint8_t crc[4];
+    const uint32_t c = imu_replay_crc32(0, buf, n);
+    for (int i = 0; i < 4; i++)
+    {
+        crc[i] = (uint8_t)(c >> (8 * i));
+    }
+    fmt_snprintf(line, sizeof(line), "reg 0x%02X: %u bytes\r\n", first, (unsigned)n);
+    cli_puts(line);
+    uart_tx_write(buf, n);
+    uart_tx_write(crc, sizeof(crc));
+}
+
+static int cli_reg_parse(const char *arg, unsigned long max, uint8_t *value)
+{
+    char *end;
+    const unsigned long v = strtoul(arg, &end, 0);
+    if (end == arg || *end != '\0' || v > max)
+    {
+        return 1;
+    }
+    *value = (uint8_t)v;
+    return 0;
+}
+
+void cli_cmd_reg(int argc, char *argv[])
+{
+    mpu6050_handle_t *h = mpu6050_basic_handle();
+    uint8_t buf[REG_COUNT];
+    uint8_t first, n = 1;
+
+    if (argc >= 3 && strcmp(argv[1], "read") == 0 && cli_reg_parse(argv[2], REG_COUNT - 1, &first) == 0)
+    {
+        const bool bin = (argc > 3 && strcmp(argv[argc - 1], "bin") == 0);
+        if ((argc > 3 + bin && cli_reg_parse(argv[3], REG_COUNT, &n) != 0) || n == 0 || first + n > REG_COUNT)
+        {
+            cli_puts("REG: n must be 1.. and end at 0x7F at most\r\n");
+            return;
+        }
+        // Whatever the registers do on a read (FIFO_R_W, MEM_R_W, INT_STATUS) happens
+        if (mpu6050_get_reg(h, first, buf, n) != 0)
+        {
+            cli_puts("REG: read failed\r\n");
+            return;
+        }
+        bin ? cli_reg_frame(first, buf, n) : cli_reg_hex(first, buf, n, NULL);
+    }
+    else if (argc >= 4 && strcmp(argv[1], "write") == 0 && cli_reg_parse(argv[2], REG_COUNT - 1, &first) == 0)
+    {
+        n = (uint8_t)(argc - 3);
+        for (uint8_t i = 0; i < n; i++)
+        {
+            if (cli_reg_parse(argv[3 + i], 0xFF, &buf[i]) != 0)
+            {
+                cli_puts("REG: bytes are 0..0xFF\r\n");
+                return;
+            }
+        }
+        if (first + n > REG_COUNT || mpu6050_set_reg(h, first, buf, n) != 0 || mpu6050_get_reg(h, first, buf, n) != 0)
+        {
+            cli_puts("REG: write failed\r\n");
+            return;
+        }
+        cli_reg_hex(first, buf, n, NULL);
+    }
+    else if (argc >= 2 && strcmp(argv[1], "dump") == 0)
+    {
+        // Bursts around the registers a read changes: INT_STATUS (cleared),
+        // MEM_R_W (advances the DMP address) and FIFO_R_W (pops a byte)
+        static const uint8_t spans[][2] = {{0x00, 0x39}, {0x3B, 0x6E}, {0x70, 0x73}, {0x75, 0x7F}};
+        uint8_t valid[REG_COUNT] = {0};
+        memset(buf, 0, sizeof(buf));
+        for (size_t i = 0; i < sizeof(spans) / sizeof(spans[0]); i++)
+        {
+            const uint8_t len = (uint8_t)(spans[i][1] - spans[i][0] + 1);
+            if (mpu6050_get_reg(h, spans[i][0], &buf[spans[i][0]], len) != 0)
+            {
+                cli_puts("REG: read failed\r\n");
+                return;
+            }
+            memset(&valid[spans[i][0]], 1, len);
+        }
+        (argc > 2 && strcmp(argv[2], "bin") == 0) ? cli_reg_frame(0, buf, REG_COUNT)
+                                                  : cli_reg_hex(0, buf, REG_COUNT, valid);
+    }
+    else
+    {
+        cli_puts("Usage: reg read <addr> [n] [bin] | reg write <addr> <byte>.. | reg dump [bin]\r\n");
+    }
+}
+
+void cli_cmd_boot(int argc, char *argv[])
+{
+    (void)argc;
+    (void)argv;
+    boot_phase_t p;
+    uint32_t total_us, hidden_us;
+    char buffer[64];
+
+    boot_get_total(&total_us, &hidden_us);
+    cli_puts("phase          ms      end ms\r\n");
+    for (uint8_t i = 0; boot_get_phase(i, &p) == 0; i++)
+    {
+        fmt_snprintf(buffer, sizeof(buffer), "%-10s %8.3f %9.3f\r\n", p.name, (float)p.us / 1000.0f,
+                     (float)p.end_us / 1000.0f);
+        cli_puts(buffer);
+    }
+    fmt_snprintf(buffer, sizeof(buffer), "total %.3f ms, %.3f ms of init hidden in sensor waits\r\n",
+                 (float)total_us / 1000.0f, (float)hidden_us / 1000.0f);
+    cli_puts(buffer);
+}
+
+static void cli_health_summary(void)
+{
+    health_summary_t hs;
+    char buffer[96];
+    char flags[48];
+
+    health_get_summary(&hs);
+    health_format(hs.flags, flags, sizeof(flags));
+    fmt_snprintf(buffer, sizeof(buffer), "HEALTH %s, %lu samples, %s\r\n", health_enabled() ? "on" : "off",
+                 (unsigned long)hs.samples, flags);
+    cli_puts(buffer);
+    fmt_snprintf(buffer, sizeof(buffer), "interval %lu us, %lu late, %lu early\r\n",
+                 (unsigned long)hs.interval_us, (unsigned long)hs.late, (unsigned long)hs.early);
+    cli_puts(buffer);
+    cli_puts("ch  stuck  saturated  noisy  baseline     floor\r\n");
+    for (int i = 0; i < IMU_CHANNELS; i++)
+    {
+        const health_channel_t *c = &hs.channel[i];
+        fmt_snprintf(buffer, sizeof(buffer), "%-2s %6lu %10lu %6lu %9.4f %9.4f%s\r\n", imu_channel_name(i),
+                     (unsigned long)c->stuck, (unsigned long)c->saturated, (unsigned long)c->noisy,
+                     c->baseline, c->floor,
+                     (hs.stuck_mask & (1u << i)) ? "  stuck" : ((hs.noise_mask & (1u << i)) ? "  noise" : ""));
+        cli_puts(buffer);
+    }
+}
+
+void cli_cmd_health(int argc, char *argv[])
+{
+    if (argc < 2)
+    {
+        cli_health_summary();
+        return;
+    }
+
+    if (strcmp(argv[1], "on") == 0 || strcmp(argv[1], "off") == 0)
+    {
+        health_enable(strcmp(argv[1], "on") == 0);
+        cli_puts(health_enabled() ? "HEALTH on\r\n" : "HEALTH off\r\n");
+    }
+    else if (strcmp(argv[1], "reset") == 0)
+    {
+        if (health_reset() != 0)
+        {
+            cli_puts("HEALTH: need hltstuck >= 0, hltnoise 0 or > 1, 0 <= hltrate < 1, hltlearn >= 2\r\n");
+            return;
+        }
+        cli_puts("HEALTH learning\r\n");
+    }
+    else
+    {
+        cli_puts("Usage: health [on|off|reset]\r\n");
+    }
+}
+
+static void cli_sync_summary(void)
+{
+    timesync_summary_t ts;
+    char buffer[96];
+
+    timesync_get_summary(&ts);
+    fmt_snprintf(buffer, sizeof(buffer), "SYNC %s, %lu exchanges of %lu requests, %lu in the gate\r\n",
+                 ts.locked ? "locked" : "unlocked", (unsigned long)ts.exchanges, (unsigned long)ts.requests,
+                 (unsigned long)ts.used);
+    cli_puts(buffer);
+    fmt_snprintf(buffer, sizeof(buffer), "offset %lld us, skew %+.1f ppm, rms %.1f us\r\n",
+                 (long long)ts.offset_us, ts.skew_ppm, ts.rms_us);
+    cli_puts(buffer);
+    fmt_snprintf(buffer, sizeof(buffer), "delay %lu us, min %lu us\r\n", (unsigned long)ts.delay_us,
+                 (unsigned long)ts.delay_min_us);
+    cli_puts(buffer);
+}
+
+void cli_cmd_sync(int argc, char *argv[])
+{
+    // Receive time first, everything after it is device turnaround
+    const uint64_t t2 = micros();
+
+    if (argc < 2)
+    {
+        cli_sync_summary();
+        return;
+    }
+
+    if (strcmp(argv[1], "reset") == 0)
+    {
+        timesync_reset();
+        cli_puts("SYNC reset\r\n");
+        return;
+    }
+
+    char *end1, *end2, *end3 = NULL;
+    const unsigned long seq = strtoul(argv[1], &end1, 10);
+    const uint64_t t1 = (argc > 2) ? strtoull(argv[2], &end2, 10) : 0;
+    const uint64_t t4 = (argc > 3) ? strtoull(argv[3], &end3, 10) : 0;
+    if (argc < 3 || argc > 4 || *end1 != '\0' || *end2 != '\0' || (end3 != NULL && *end3 != '\0'))
+    {
+        cli_puts("Usage: sync [reset] | sync <seq> <t1 us> [<t4 us>]\r\n");
+        return;
+    }
+    timesync_request((uint32_t)seq, t1, argc > 3, t4, t2);
+}
+
 // =============================================================================
 // Command Registry
 // =============================================================================
@@ -466,6 +1579,24 @@ static const cli_command_t app_commands[] = {
     {"calibrate", cli_cmd_calibrate},
     {"filedump", cli_cmd_filedump},
     {"flashdump", cli_cmd_flashdump},
+
+    {"bench", cli_cmd_bench},
+    {"replay", cli_cmd_replay},
+    {"anc", cli_cmd_anc},
+    {"xcorr", cli_cmd_xcorr},
+    {"env", cli_cmd_env},
+    {"mfcc", cli_cmd_mfcc},
+    {"pid", cli_cmd_pid},
+    {"imu", cli_cmd_imu},
+    {"capture", cli_cmd_capture},
+    {"range", cli_cmd_range},
+    {"events", cli_cmd_events},
+    {"fsync", cli_cmd_fsync},
+    {"i2ctrace", cli_cmd_i2ctrace},
+    {"reg", cli_cmd_reg},
+    {"boot", cli_cmd_boot},
+    {"health", cli_cmd_health},
+    {"sync", cli_cmd_sync},
 };
 
 #define NUM_COMMANDS (sizeof(app_commands) / sizeof(app_commands[0]))
@@ -0,0 +1,292 @@
+/*
+ * control.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: halvard
+ *
+ *  Description: fixed-rate PID loops from IMU attitude/rates to TIM3 PWM
+ */
+
+#include "control.h"
+#include "main.h"
+#include "mem_sections.h"
+#include "arm_math.h"
+
+#include <math.h>
+#include <string.h>
+
+control_config_t control_config = {
+    .loops = 2,
+    .div = 1,
+    .qbits = 0,
+    .log = false,
+    .loop = {
+        { .input = CONTROL_INPUT_ROLL,  .setpoint = 0.0f, .kp = 1.0f, .ki = 0.0f, .kd = 0.0f },
+        { .input = CONTROL_INPUT_PITCH, .setpoint = 0.0f, .kp = 1.0f, .ki = 0.0f, .kd = 0.0f },
+        { .input = 5,                   .setpoint = 0.0f, .kp = 1.0f, .ki = 0.0f, .kd = 0.0f },
+        { .input = 2,                   .setpoint = 9.81f, .kp = 1.0f, .ki = 0.0f, .kd = 0.0f },
+    },
+};
+
+static struct {
+    bool enabled;
+    control_config_t active;
+    uint32_t count;             // samples since the last step
+    bool have_sample;           // last_sample valid, for the period
+    uint32_t last_sample;
+    uint64_t latency_sum;
+
+    // Gains the PID coefficients were computed from
+    float gains[CONTROL_MAX_LOOPS][3];
+    union {
+        arm_pid_instance_f32 f32;
+        arm_pid_instance_q31 q31;
+    } pid[CONTROL_MAX_LOOPS];
+
+    control_summary_t summary;
+} ctl;
+
+static float control_full_scale(int input)
+{
+    if (input < 3)
+    {
+        return CONTROL_ACCEL_FULL_SCALE;
+    }
+    return (input < IMU_CHANNELS) ? CONTROL_GYRO_FULL_SCALE : CONTROL_ANGLE_FULL_SCALE;
+}
+
+static bool control_q31_gains_ok(const control_loop_config_t *loop)
+{
+    float limit = (float)(1 << CONTROL_Q31_SHIFT) - 1.0f;
+    return 2.0f * fabsf(loop->kp) + fabsf(loop->ki) + 4.0f * fabsf(loop->kd) < limit;
+}
+
+static q31_t control_to_q31(float x)
+{
+    if (x >= 0.999999f)
+    {
+        return INT32_MAX;
+    }
+    if (x <= -1.0f)
+    {
+        return INT32_MIN;
+    }
+    return (q31_t)(x * 2147483648.0f);
+}
+
+/**
+ * @brief (Re)computes loop i's PID coefficients from its gains.
+ * @return 0 on success, 1 if the gains don't fit q31 (nothing changed)
+ */
+static int control_load_gains(int i, int reset)
+{
+    const control_loop_config_t *loop = &control_config.loop[i];
+    if (ctl.active.qbits == 31)
+    {
+        if (!control_q31_gains_ok(loop))
+        {
+            return 1;
+        }
+        const float scale = 1.0f / (float)(1 << CONTROL_Q31_SHIFT);
+        arm_pid_instance_q31 *s = &ctl.pid[i].q31;
+        s->Kp = control_to_q31(loop->kp * scale);
+        s->Ki = control_to_q31(loop->ki * scale);
+        s->Kd = control_to_q31(loop->kd * scale);
+        arm_pid_init_q31(s, reset);
+    }
+    else
+    {
+        arm_pid_instance_f32 *s = &ctl.pid[i].f32;
+        s->Kp = loop->kp;
+        s->Ki = loop->ki;
+        s->Kd = loop->kd;
+        arm_pid_init_f32(s, reset);
+    }
+
+    ctl.gains[i][0] = loop->kp;
+    ctl.gains[i][1] = loop->ki;
+    ctl.gains[i][2] = loop->kd;
+    return 0;
+}
+
+/**
+ * @brief One PID step on a per-unit error.
+ * @return Output u, -1..1
+ */
+MEM_RAMFUNC(RAMFUNC_FILTER, control_pid)
+static float control_pid(int i, float error)
+{
+    error = (error > 1.0f) ? 1.0f : ((error < -1.0f) ? -1.0f : error);
+
+    if (ctl.active.qbits == 31)
+    {
+        // The state holds u / 2^shift; clamp it to +-1 at the output scale
+        const q31_t limit = INT32_MAX >> CONTROL_Q31_SHIFT;
+        arm_pid_instance_q31 *s = &ctl.pid[i].q31;
+        q31_t out = arm_pid_q31(s, control_to_q31(error));
+        out = (out > limit) ? limit : ((out < -limit) ? -limit : out);
+        s->state[2] = out;
+        return (float)out * ((float)(1 << CONTROL_Q31_SHIFT) / 2147483648.0f);
+    }
+
+    arm_pid_instance_f32 *s = &ctl.pid[i].f32;
+    float out = arm_pid_f32(s, error);
+    out = (out > 1.0f) ? 1.0f : ((out < -1.0f) ? -1.0f : out);
+    s->state[2] = out;
+    return out;
+}
+
+MEM_RAMFUNC(RAMFUNC_FILTER, control_input)
+float control_input(const imu_t *imu, int input)
+{
+    if (input >= 0 && input < IMU_CHANNELS)
+    {
+        return imu_channel(imu, input);
+    }
+
+    // NED body frame, az = +g when level
+    const float ax = imu->acc[0];
+    const float ay = imu->acc[1];
+    const float az = imu->acc[2];
+    if (input == CONTROL_INPUT_ROLL)
+    {
+        return atan2f(ay, az) * (180.0f / PI);
+    }
+    if (input == CONTROL_INPUT_PITCH)
+    {
+        return atan2f(-ax, sqrtf(ay * ay + az * az)) * (180.0f / PI);
+    }
+    return 0.0f;
+}
+
+const char *control_input_name(int input)
+{
+    if (input == CONTROL_INPUT_ROLL)
+    {
+        return "roll";
+    }
+    if (input == CONTROL_INPUT_PITCH)
+    {
+        return "pitch";
+    }
+    return imu_channel_name(input);
+}
+
+int control_enable(void)
+{
+    control_disable();
+
+    const control_config_t *cfg = &control_config;
+    if (cfg->loops < 1 || cfg->loops > CONTROL_MAX_LOOPS || cfg->div < 1 || cfg->div > 100
+        || (cfg->qbits != 0 && cfg->qbits != 31))
+    {
+        return 1;
+    }
+    for (int i = 0; i < cfg->loops; i++)
+    {
+        if (cfg->loop[i].input < 0 || cfg->loop[i].input >= CONTROL_INPUTS
+            || (cfg->qbits == 31 && !control_q31_gains_ok(&cfg->loop[i])))
+        {
+            return 1;
+        }
+    }
+    if (pwm_init(PWM_DEFAULT_FREQ_HZ) != 0)
+    {
+        return 1;
+    }
+
+    memset(&ctl, 0, sizeof(ctl));
+    ctl.active = *cfg;
+    for (int i = 0; i < cfg->loops; i++)
+    {
+        control_load_gains(i, 1);
+        pwm_set(i, 0.5f);
+    }
+    ctl.summary.period_min = UINT32_MAX;
+
+    ctl.enabled = true;
+    return 0;
+}
+
+void control_disable(void)
+{
+    if (ctl.enabled)
+    {
+        ctl.enabled = false;
+        for (int i = 0; i < ctl.active.loops; i++)
+        {
+            pwm_set(i, 0.0f);
+        }
+    }
+}
+
+bool control_enabled(void)
+{
+    return ctl.enabled;
+}
+
+MEM_RAMFUNC(RAMFUNC_FILTER, control_process)
+int control_process(const imu_t *imu)
+{
+    if (!ctl.enabled)
+    {
+        return 0;
+    }
+    if (++ctl.count < (uint32_t)ctl.active.div)
+    {
+        return 0;
+    }
+    ctl.count = 0;
+
+    const uint32_t sample = imu_sample_cycles();
+    for (int i = 0; i < ctl.active.loops; i++)
+    {
+        const control_loop_config_t *loop = &control_config.loop[i];
+        if ((loop->kp != ctl.gains[i][0] || loop->ki != ctl.gains[i][1] || loop->kd != ctl.gains[i][2])
+            && control_load_gains(i, 0) != 0)
+        {
+            // Keep the old gains, and don't retry until they change again
+            ctl.gains[i][0] = loop->kp;
+            ctl.gains[i][1] = loop->ki;
+            ctl.gains[i][2] = loop->kd;
+            ctl.summary.gains_rejected++;
+        }
+
+        float in = control_input(imu, ctl.active.loop[i].input);
+        float error = (loop->setpoint - in) / control_full_scale(ctl.active.loop[i].input);
+        float u = control_pid(i, error);
+        pwm_set(i, 0.5f + 0.5f * u);
+
+        ctl.summary.input[i] = in;
+        ctl.summary.output[i] = u;
+    }
+    uint32_t latency = DWT->CYCCNT - sample;
+
+    control_summary_t *s = &ctl.summary;
+    if (ctl.have_sample)
+    {
+        uint32_t period = sample - ctl.last_sample;
+        s->period_min = (period < s->period_min) ? period : s->period_min;
+        s->period_max = (period > s->period_max) ? period : s->period_max;
+    }
+    ctl.have_sample = true;
+    ctl.last_sample = sample;
+
+    s->steps++;
+    s->latency = latency;
+    s->latency_max = (latency > s->latency_max) ? latency : s->latency_max;
+    ctl.latency_sum += latency;
+    s->latency_avg = (uint32_t)(ctl.latency_sum / s->steps);
+
+    return 1;
+}
+
+void control_get_summary(control_summary_t *summary)
+{
+    *summary = ctl.summary;
+}
+
+void control_get_active(control_config_t *config)
+{
+    *config = ctl.active;
+}
@@ -36,6 +36,7 @@
 
 #include "driver_mpu6050.h"
 #include "driver_mpu6050_code.h"
+#include "fifo_decode.h"
 #include <math.h>
 #include <stdlib.h>
 
@@ -3185,7 +3186,6 @@ uint8_t mpu6050_dmp_read(mpu6050_handle_t *handle,
                         )
 {
     uint8_t res;
-    uint8_t i = 0;
     uint16_t len;
     uint8_t buf[2];
     uint8_t prev;
@@ -3272,6 +3272,22 @@ uint8_t mpu6050_dmp_read(mpu6050_handle_t *handle,
         return 7;                                                                                                         /* return error */
     }
 
+    {
+        uint8_t fields = 0;
+        const fifo_out_t out = {
+            .acc = {&accel_raw[0][0], &accel_raw[0][1], &accel_raw[0][2]},
+            .gyr = {&gyro_raw[0][0], &gyro_raw[0][1], &gyro_raw[0][2]},
+            .quat = {&quat[0][0], &quat[0][1], &quat[0][2], &quat[0][3]},
+            .stride = 3,
+            .quat_stride = 4,
+        };
+
+        fields |= ((handle->mask & (MPU6050_DMP_FEATURE_3X_QUAT | MPU6050_DMP_FEATURE_6X_QUAT)) != 0) ? FIFO_DMP_QUAT : 0;  /* quat */
+        fields |= ((handle->mask & MPU6050_DMP_FEATURE_SEND_RAW_ACCEL) != 0) ? FIFO_DMP_ACCEL : 0;                         /* accel */
+        fields |= ((handle->mask & MPU6050_DMP_FEATURE_SEND_ANY_GYRO) != 0) ? FIFO_DMP_GYRO : 0;                           /* gyro */
+        fields |= ((handle->mask & (MPU6050_DMP_FEATURE_TAP | MPU6050_DMP_FEATURE_ORIENT)) != 0) ? FIFO_DMP_GESTURE : 0;  /* tap and orient */
+        fifo_decode_dmp(handle->buf, *l, fields, &out);                                                                   /* set the raw data */
+    }
     for (j = 0; j < (*l); j++)                                                                                            /* (*l) times */
     {
         if ((handle->mask & (MPU6050_DMP_FEATURE_3X_QUAT | MPU6050_DMP_FEATURE_6X_QUAT)) != 0)                            /* check the quat */
@@ -3280,16 +3296,6 @@ uint8_t mpu6050_dmp_read(mpu6050_handle_t *handle,
             int32_t quat_mag_sq;
             float q0=1.0f, q1=0.0f, q2=0.0f, q3=0.0f;
 
-            i = 0;                                                                                                        /* set 0 */
-            quat[j][0] = ((int32_t)handle->buf[0 + len * j] << 24) | ((int32_t)handle->buf[1 + len * j] << 16) |
-                         ((int32_t)handle->buf[2 + len * j] << 8) | handle->buf[3 + len * j];                             /* set the quat 0 */
-            quat[j][1] = ((int32_t)handle->buf[4 + len * j] << 24) | ((int32_t)handle->buf[5 + len * j] << 16) |
-                         ((int32_t)handle->buf[6 + len * j] << 8) | handle->buf[7 + len * j];                             /* set the quat 1 */
-            quat[j][2] = ((int32_t)handle->buf[8 + len * j] << 24) | ((int32_t)handle->buf[9 + len * j] << 16) |
-                         ((int32_t)handle->buf[10 + len * j] << 8) | handle->buf[11 + len * j];                           /* set the quat 2 */
-            quat[j][3] = ((int32_t)handle->buf[12 + len * j] << 24) | ((int32_t)handle->buf[13 + len * j] << 16) |
-                         ((int32_t)handle->buf[14 + len * j] << 8) | handle->buf[15 + len * j];                           /* set the quat 3 */
-            i += 16;                                                                                                      /* size += 16 */
 
             quat_q14[0] = quat[j][0] >> 16;                                                                               /* set the quat q14[0] */
             quat_q14[1] = quat[j][1] >> 16;                                                                               /* set the quat q14[1] */
@@ -3327,11 +3333,6 @@ uint8_t mpu6050_dmp_read(mpu6050_handle_t *handle,
         {
             uint8_t accel_conf;
 
-            accel_raw[j][0] = ((int16_t)handle->buf[i + 0 + len * j] << 8) | handle->buf[i + 1 + len * j];                /* set the accel x raw data */
-            accel_raw[j][1] = ((int16_t)handle->buf[i + 2 + len * j] << 8) | handle->buf[i + 3 + len * j];                /* set the accel y raw data */
-            accel_raw[j][2] = ((int16_t)handle->buf[i + 4 + len * j] << 8) | handle->buf[i + 5 + len * j];                /* set the accel z raw data */
-            i += 6;                                                                                                       /* size += 6 */
-
             res = a_mpu6050_iic_read(handle, MPU6050_REG_ACCEL_CONFIG, (uint8_t *)&accel_conf, 1);                        /* read accel config */
             if (res != 0)                                                                                                 /* check result */
             {
@@ -3378,11 +3379,6 @@ uint8_t mpu6050_dmp_read(mpu6050_handle_t *handle,
         {
             uint8_t gyro_conf;
 
-            gyro_raw[j][0] = ((int16_t)handle->buf[i + 0 + len * j] << 8) | handle->buf[i + 1 + len * j];                 /* set the gyro x raw data */
-            gyro_raw[j][1] = ((int16_t)handle->buf[i + 2 + len * j] << 8) | handle->buf[i + 3 + len * j];                 /* set the gyro y raw data */
-            gyro_raw[j][2] = ((int16_t)handle->buf[i + 4 + len * j] << 8) | handle->buf[i + 5 + len * j];                 /* set the gyro z raw data */
-            i += 6;                                                                                                       /* size += 6 */
-
             res = a_mpu6050_iic_read(handle, MPU6050_REG_GYRO_CONFIG, (uint8_t *)&gyro_conf, 1);                          /* read gyro config */
             if (res != 0)                                                                                                 /* check result */
             {
@@ -3427,7 +3423,7 @@ uint8_t mpu6050_dmp_read(mpu6050_handle_t *handle,
         }
         if ((handle->mask & (MPU6050_DMP_FEATURE_TAP | MPU6050_DMP_FEATURE_ORIENT)) != 0)                                 /* check the tap and orient */
         {
-            a_mpu6050_dmp_decode_gesture(handle, handle->buf + i + len * j);                                              /* run the decode gesture */
+            a_mpu6050_dmp_decode_gesture(handle, handle->buf + (len - 4) + len * j);                                      /* run the decode gesture, last in the packet */
         }
     }
 
@@ -3703,8 +3699,9 @@ uint8_t mpu6050_get_addr_pin(mpu6050_handle_t *handle, mpu6050_address_t *addr_p
 }
 
 /**
- * @brief     initialize the chip
+ * @brief     initialize the chip, with or without a device reset
  * @param[in] *handle pointer to an mpu6050 handle structure
+ * @param[in] reset reset the device after the id check
  * @return    status code
  *            - 0 success
  *            - 1 iic initialization failed
@@ -3714,7 +3711,7 @@ uint8_t mpu6050_get_addr_pin(mpu6050_handle_t *handle, mpu6050_address_t *addr_p
  *            - 5 id is invalid
  * @note      none
  */
-uint8_t mpu6050_init(mpu6050_handle_t *handle)
+static uint8_t a_mpu6050_init(mpu6050_handle_t *handle, mpu6050_bool_t reset)
 {
     uint8_t res, prev;
     uint32_t timeout;
@@ -3787,6 +3784,14 @@ uint8_t mpu6050_init(mpu6050_handle_t *handle)
         return 5;                                                                   /* return error */
     }
 
+    if (reset == MPU6050_BOOL_FALSE)                                                /* keep the configuration */
+    {
+        handle->inited = 1;                                                         /* flag the inited bit */
+        handle->dmp_inited = 0;                                                     /* flag closed */
+
+        return 0;                                                                   /* success return 0 */
+    }
+
     prev = 1 << 7;                                                                  /* reset the device */
     res = a_mpu6050_iic_write(handle, MPU6050_REG_PWR_MGMT_1, &prev, 1);            /* write pwr mgmt 1 */
     if (res != 0)                                                                   /* check the result */
@@ -3823,6 +3828,40 @@ uint8_t mpu6050_init(mpu6050_handle_t *handle)
     return 4;                                                                       /* return error */
 }
 
+/**
+ * @brief     initialize the chip
+ * @param[in] *handle pointer to an mpu6050 handle structure
+ * @return    status code
+ *            - 0 success
+ *            - 1 iic initialization failed
+ *            - 2 handle is NULL
+ *            - 3 linked functions is NULL
+ *            - 4 reset failed
+ *            - 5 id is invalid
+ * @note      none
+ */
+uint8_t mpu6050_init(mpu6050_handle_t *handle)
+{
+    return a_mpu6050_init(handle, MPU6050_BOOL_TRUE);                              /* init with reset */
+}
+
+/**
+ * @brief     initialize the handle for a chip that is already configured
+ * @param[in] *handle pointer to an mpu6050 handle structure
+ * @return    status code
+ *            - 0 success
+ *            - 1 iic initialization failed
+ *            - 2 handle is NULL
+ *            - 3 linked functions is NULL
+ *            - 5 id is invalid
+ * @note      same as mpu6050_init without the device reset, so the registers
+ *            keep what the last init wrote (warm restart of the mcu only)
+ */
+uint8_t mpu6050_init_keep_config(mpu6050_handle_t *handle)
+{
+    return a_mpu6050_init(handle, MPU6050_BOOL_FALSE);                             /* init without reset */
+}
+
 /**
  * @brief     close the chip
  * @param[in] *handle pointer to an mpu6050 handle structure
@@ -3979,21 +4018,16 @@ uint8_t mpu6050_read(mpu6050_handle_t *handle, int16_t (*accel_raw)[3], float (*
 
             return 1;                                                                              /* return error */
         }
+        {
+            const fifo_out_t out = {
+                .acc = {&accel_raw[0][0], &accel_raw[0][1], &accel_raw[0][2]},
+                .gyr = {&gyro_raw[0][0], &gyro_raw[0][1], &gyro_raw[0][2]},
+                .stride = 3,
+            };
+            fifo_decode_raw(handle->buf, *len, &out);                                              /* set raw accel and gyro */
+        }
         for (i = 0; i < (*len); i++)                                                               /* *len times */
         {
-            accel_raw[i][0] = (int16_t)((uint16_t)handle->buf[i * 12 + 0] << 8) |
-                                         handle->buf[i * 12 + 1];                                  /* set raw accel x */
-            accel_raw[i][1] = (int16_t)((uint16_t)handle->buf[i * 12 + 2] << 8) |
-                                         handle->buf[i * 12 + 3];                                  /* set raw accel y */
-            accel_raw[i][2] = (int16_t)((uint16_t)handle->buf[i * 12 + 4] << 8) |
-                                         handle->buf[i * 12 + 5];                                  /* set raw accel z */
-            gyro_raw[i][0] = (int16_t)((uint16_t)handle->buf[i * 12 + 6] << 8) |
-                                        handle->buf[i * 12 + 7];                                   /* set raw gyro x */
-            gyro_raw[i][1] = (int16_t)((uint16_t)handle->buf[i * 12 + 8] << 8) |
-                                        handle->buf[i * 12 + 9];                                   /* set raw gyro y */
-            gyro_raw[i][2] = (int16_t)((uint16_t)handle->buf[i * 12 + 10] << 8) |
-                                        handle->buf[i * 12 + 11];                                  /* set raw gyro z */
-
             if (accel_conf == 0)                                                                   /* ±2g */
             {
                 accel_g[i][0] = (float)(accel_raw[i][0]) / 16384.0f;                               /* set accel x */
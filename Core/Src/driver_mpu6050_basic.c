@@ -36,20 +36,18 @@
 
 #include "driver_mpu6050_basic.h"
 
-static mpu6050_handle_t gs_handle;        /**< mpu6050 handle */
+static mpu6050_handle_t gs_handle;        /**< mpu6050 handle, .bss: inited is read before DRIVER_MPU6050_LINK_INIT on some paths */
 
 /**
- * @brief     basic example init
+ * @brief     link the interface functions and set the address
  * @param[in] addr_pin iic device address
  * @return    status code
  *            - 0 success
- *            - 1 init failed
+ *            - 1 set addr pin failed
  * @note      none
  */
-uint8_t mpu6050_basic_init(mpu6050_address_t addr_pin)
+static uint8_t a_mpu6050_basic_link(mpu6050_address_t addr_pin)
 {
-    uint8_t res;
-    
     /* link interface function */
     DRIVER_MPU6050_LINK_INIT(&gs_handle, mpu6050_handle_t);
     DRIVER_MPU6050_LINK_IIC_INIT(&gs_handle, mpu6050_interface_iic_init);
@@ -61,14 +59,61 @@ uint8_t mpu6050_basic_init(mpu6050_address_t addr_pin)
     DRIVER_MPU6050_LINK_RECEIVE_CALLBACK(&gs_handle, mpu6050_interface_receive_callback);
     
     /* set the addr pin */
-    res = mpu6050_set_addr_pin(&gs_handle, addr_pin);
-    if (res != 0)
+    if (mpu6050_set_addr_pin(&gs_handle, addr_pin) != 0)
     {
         mpu6050_interface_debug_print("mpu6050: set addr pin failed.\n");
        
         return 1;
     }
     
+    return 0;
+}
+
+/**
+ * @brief     basic example attach to a chip that is already configured
+ * @param[in] addr_pin iic device address
+ * @return    status code
+ *            - 0 success
+ *            - 1 attach failed
+ * @note      mpu6050_init without the reset: the iic bus is initialized and
+ *            the id checked, no register is written; the caller has to know
+ *            the configuration is the one it wants
+ */
+uint8_t mpu6050_basic_attach(mpu6050_address_t addr_pin)
+{
+    if (a_mpu6050_basic_link(addr_pin) != 0)
+    {
+        return 1;
+    }
+    
+    /* init, keeping the registers */
+    if (mpu6050_init_keep_config(&gs_handle) != 0)
+    {
+        mpu6050_interface_debug_print("mpu6050: attach failed.\n");
+        
+        return 1;
+    }
+    
+    return 0;
+}
+
+/**
+ * @brief     basic example init
+ * @param[in] addr_pin iic device address
+ * @return    status code
+ *            - 0 success
+ *            - 1 init failed
+ * @note      none
+ */
+uint8_t mpu6050_basic_init(mpu6050_address_t addr_pin)
+{
+    uint8_t res;
+    
+    if (a_mpu6050_basic_link(addr_pin) != 0)
+    {
+        return 1;
+    }
+    
     /* init */
     res = mpu6050_init(&gs_handle);
     if (res != 0)
@@ -556,6 +601,16 @@ uint8_t mpu6050_basic_read(float g[3], float dps[3])
     return 0;
 }
 
+/**
+ * @brief  basic example handle
+ * @return pointer to the handle set up by mpu6050_basic_init
+ * @note   for register access beyond the basic example (imu_backend_mpu6050.c)
+ */
+mpu6050_handle_t *mpu6050_basic_handle(void)
+{
+    return &gs_handle;
+}
+
 /**
  * @brief  basic example deinit
  * @return status code
@@ -38,6 +38,9 @@
 #include "config.h"
 #include "util.h"
 #include "i2c.h"
+#include "boot.h"
+#include "i2c_trace.h"
+#include "imu_event.h"
 
 #include <stdarg.h>
 
@@ -92,7 +95,9 @@ uint8_t mpu6050_interface_iic_read(uint8_t addr, uint8_t reg, uint8_t *buf, uint
     //     print("HAL_I2C_Master_Receive failed!\r\n");
     //     return 1;
     // }
+    I2C_TRACE_BEGIN(trace_start);
     status = HAL_I2C_Mem_Read(&hi2c1, addr, reg, I2C_MEMADD_SIZE_8BIT, buf, len, 0xFF);
+    I2C_TRACE_END(trace_start, 0, reg, len, status);
     if (status != HAL_OK)
     {
         print("I2C read failed!\r\n");
@@ -115,7 +120,9 @@ uint8_t mpu6050_interface_iic_read(uint8_t addr, uint8_t reg, uint8_t *buf, uint
 uint8_t mpu6050_interface_iic_write(uint8_t addr, uint8_t reg, uint8_t *buf, uint16_t len)
 {
     HAL_StatusTypeDef status;
+    I2C_TRACE_BEGIN(trace_start);
     status = HAL_I2C_Mem_Write(&hi2c1, addr, reg, I2C_MEMADD_SIZE_8BIT, buf, len, 0xFF);
+    I2C_TRACE_END(trace_start, I2C_TRACE_WRITE, reg, len, status);
     if (status != HAL_OK)
     {
         print("I2C write failed!\r\n");
@@ -131,7 +138,8 @@ uint8_t mpu6050_interface_iic_write(uint8_t addr, uint8_t reg, uint8_t *buf, uin
  */
 void mpu6050_interface_delay_ms(uint32_t ms)
 {
-    HAL_Delay(ms);
+    // Deferred boot init runs here first
+    boot_wait_ms(ms);
 }
 
 /**
@@ -144,7 +152,7 @@ void mpu6050_interface_debug_print(const char *const fmt, ...)
 #ifdef ENABLE_LOGGING
     va_list args;
     va_start(args, fmt);
-    vprintf(fmt, args);
+    vprint(fmt, args);
     va_end(args);
 #else
     (void)fmt;
@@ -154,7 +162,8 @@ void mpu6050_interface_debug_print(const char *const fmt, ...)
 /**
  * @brief     interface receive callback
  * @param[in] type irq type
- * @note      none
+ * @note      queues an event only (imu_event.h), safe at any rate and
+ *            from interrupt context
  */
 void mpu6050_interface_receive_callback(uint8_t type)
 {
@@ -162,37 +171,19 @@ void mpu6050_interface_receive_callback(uint8_t type)
     {
         case MPU6050_INTERRUPT_MOTION :
         {
-            mpu6050_interface_debug_print("mpu6050: irq motion.\n");
+            imu_event_push(IMU_EVENT_MOTION, 0, 0);
             
             break;
         }
         case MPU6050_INTERRUPT_FIFO_OVERFLOW :
         {
-            mpu6050_interface_debug_print("mpu6050: irq fifo overflow.\n");
-            
-            break;
-        }
-        case MPU6050_INTERRUPT_I2C_MAST :
-        {
-            mpu6050_interface_debug_print("mpu6050: irq i2c master.\n");
-            
-            break;
-        }
-        case MPU6050_INTERRUPT_DMP :
-        {
-            mpu6050_interface_debug_print("mpu6050: irq dmp\n");
-            
-            break;
-        }
-        case MPU6050_INTERRUPT_DATA_READY :
-        {
-            mpu6050_interface_debug_print("mpu6050: irq data ready\n");
+            imu_event_push(IMU_EVENT_FIFO_OVERFLOW, 0, 0);
             
             break;
         }
         default :
         {
-            mpu6050_interface_debug_print("mpu6050: irq unknown code.\n");
+            /* data ready, dmp and i2c master fire every sample, nothing to report */
             
             break;
         }
@@ -203,95 +194,19 @@ void mpu6050_interface_receive_callback(uint8_t type)
  * @brief     interface dmp tap callback
  * @param[in] count tap count
  * @param[in] direction tap direction
- * @note      none
+ * @note      queues an event only (imu_event.h)
  */
 void mpu6050_interface_dmp_tap_callback(uint8_t count, uint8_t direction)
 {
-    switch (direction)
-    {
-        case MPU6050_DMP_TAP_X_UP :
-        {
-            mpu6050_interface_debug_print("mpu6050: tap irq x up with %d.\n", count);
-            
-            break;
-        }
-        case MPU6050_DMP_TAP_X_DOWN :
-        {
-            mpu6050_interface_debug_print("mpu6050: tap irq x down with %d.\n", count);
-            
-            break;
-        }
-        case MPU6050_DMP_TAP_Y_UP :
-        {
-            mpu6050_interface_debug_print("mpu6050: tap irq y up with %d.\n", count);
-            
-            break;
-        }
-        case MPU6050_DMP_TAP_Y_DOWN :
-        {
-            mpu6050_interface_debug_print("mpu6050: tap irq y down with %d.\n", count);
-            
-            break;
-        }
-        case MPU6050_DMP_TAP_Z_UP :
-        {
-            mpu6050_interface_debug_print("mpu6050: tap irq z up with %d.\n", count);
-            
-            break;
-        }
-        case MPU6050_DMP_TAP_Z_DOWN :
-        {
-            mpu6050_interface_debug_print("mpu6050: tap irq z down with %d.\n", count);
-            
-            break;
-        }
-        default :
-        {
-            mpu6050_interface_debug_print("mpu6050: tap irq unknown code.\n");
-            
-            break;
-        }
-    }
+    imu_event_push(IMU_EVENT_TAP, direction, count);
 }
 
 /**
  * @brief     interface dmp orient callback
  * @param[in] orientation dmp orientation
- * @note      none
+ * @note      queues an event only (imu_event.h)
  */
 void mpu6050_interface_dmp_orient_callback(uint8_t orientation)
 {
-    switch (orientation)
-    {
-        case MPU6050_DMP_ORIENT_PORTRAIT :
-        {
-            mpu6050_interface_debug_print("mpu6050: orient irq portrait.\n");
-            
-            break;
-        }
-        case MPU6050_DMP_ORIENT_LANDSCAPE :
-        {
-            mpu6050_interface_debug_print("mpu6050: orient irq landscape.\n");
-            
-            break;
-        }
-        case MPU6050_DMP_ORIENT_REVERSE_PORTRAIT :
-        {
-            mpu6050_interface_debug_print("mpu6050: orient irq reverse portrait.\n");
-            
-            break;
-        }
-        case MPU6050_DMP_ORIENT_REVERSE_LANDSCAPE :
-        {
-            mpu6050_interface_debug_print("mpu6050: orient irq reverse landscape.\n");
-            
-            break;
-        }
-        default :
-        {
-            mpu6050_interface_debug_print("mpu6050: orient irq unknown code.\n");
-            
-            break;
-        }
-    }
+    imu_event_push(IMU_EVENT_ORIENT, orientation, 0);
 }
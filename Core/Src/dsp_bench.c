@@ -0,0 +1,1051 @@
+/*
+ * dsp_bench.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: halvard
+ *
+ *  Description: cycle benchmarks of the CMSIS-DSP kernels on IMU-shaped data
+ *
+ *  Kernels (each in q15, q31 and f32):
+ *    biquad  2-stage DF1 low-pass, one instance per axis
+ *    fir     16-tap low-pass, one instance per axis
+ *    rfft    real FFT of each axis block (block sizes >= 32)
+ *    matrix  3x3 rotation applied to the 3xN sample block
+ *    stats   mean + variance + max of each axis
+ *    quat    batched gyro integration into an attitude quaternion (quat.h),
+ *            the 3 axes being gx/gy/gz (q31 and f32 only)
+ *    quat1   the same, one quat_update_*() call per sample
+ *
+ *  The hot path table (dsp_bench_hot()) times single calls of the
+ *  per-sample functions the RAMFUNC_* switches in config.h place, with where
+ *  each one ended up.
+ */
+
+#include "dsp_bench.h"
+#include "scratch.h"
+#include "uart_tx.h"
+#include "fmt.h"
+#include "quat.h"
+#include "fsync.h"
+#include "fifo_decode.h"
+#include "imu.h"
+#include "config.h"
+#include "main.h"
+#include "arm_math.h"
+
+#include <string.h>
+
+#define BENCH_AXES          3
+#define BENCH_BIQUAD_STAGES 2
+#define BENCH_FIR_TAPS      16
+#define BENCH_QUAT_DT       0.01f   // [s], 100 Hz gyro
+
+typedef enum {
+    BENCH_Q15 = 0,
+    BENCH_Q31,
+    BENCH_F32,
+    BENCH_TYPE_COUNT
+} bench_type_t;
+
+typedef enum {
+    BENCH_OK = 0,
+    BENCH_UNSUPPORTED,      // kernel has no variant for this size
+    BENCH_NO_MEM            // does not fit in the scratch arena
+} bench_result_t;
+
+typedef struct {
+    const char *name;
+    bench_result_t (*setup)(void);
+    void (*run)(void);
+} bench_kernel_t;
+
+static const uint16_t bench_sizes[] = {8, 16, 32, 64, 128, 256, 512};
+#define BENCH_NUM_SIZES (sizeof(bench_sizes) / sizeof(bench_sizes[0]))
+
+static const char *const bench_type_names[BENCH_TYPE_COUNT] = {"q15", "q31", "f32"};
+static const uint8_t bench_type_size[BENCH_TYPE_COUNT] = {2, 4, 4};
+
+// Butterworth low-pass at 0.1 fs, CMSIS sign convention {b0, b1, b2, a1, a2}
+static const float32_t bench_biquad_coeffs[5] = {
+    0.0674553f, 0.1349105f, 0.0674553f, 1.1429805f, -0.4128016f
+};
+
+// Rotation by 10 degrees about z
+static const float32_t bench_rotation[9] = {
+    0.9848078f, -0.1736482f, 0.0f,
+    0.1736482f,  0.9848078f, 0.0f,
+    0.0f,        0.0f,       0.9999695f
+};
+
+// Current cell
+static struct {
+    bench_type_t type;
+    uint32_t n;
+    uint8_t *arena;
+    size_t used;
+    void *in;                   // [BENCH_AXES][n]
+    void *out;
+    void *inst[BENCH_AXES];
+    void *work;
+} bench;
+
+// =============================================================================
+// Helpers
+// =============================================================================
+
+static void *bench_alloc(size_t size)
+{
+    size = (size + 7u) & ~(size_t)7u;
+    if (bench.used + size > SCRATCH_SIZE)
+    {
+        return NULL;
+    }
+    void *p = bench.arena + bench.used;
+    bench.used += size;
+    return p;
+}
+
+static void *bench_axis(void *base, uint32_t axis)
+{
+    return (uint8_t *)base + axis * bench.n * bench_type_size[bench.type];
+}
+
+static q31_t bench_q31(float32_t x)
+{
+    if (x >= 1.0f)
+    {
+        return 0x7FFFFFFF;
+    }
+    if (x <= -1.0f)
+    {
+        return (q31_t)0x80000000;
+    }
+    return (q31_t)(x * 2147483648.0f);
+}
+
+static q15_t bench_q15(float32_t x)
+{
+    return (q15_t)(bench_q31(x) >> 16);
+}
+
+/**
+ * @brief Fills the input with a deterministic IMU-like signal in full-scale
+ * units: per-axis offset (gravity on z), a tone and LCG noise. Integer only,
+ * so refilling between runs is cheap on a core without FPU.
+ */
+static void bench_fill(void)
+{
+    static const int32_t offset[BENCH_AXES] = {0x01000000, -0x02000000, 0x40000000};
+    static const int32_t amplitude[BENCH_AXES] = {0x0C000000, 0x06000000, 0x02000000};
+    static const uint32_t step[BENCH_AXES] = {0x01900000, 0x03300000, 0x00A00000};
+    uint32_t seed = 12345u;
+
+    for (uint32_t a = 0; a < BENCH_AXES; a++)
+    {
+        uint32_t phase = 0;
+        for (uint32_t i = 0; i < bench.n; i++)
+        {
+            // Parabolic sine, q15
+            int32_t x = (int32_t)phase >> 16;
+            int32_t s = (x * (32768 - (x < 0 ? -x : x))) >> 13;
+            phase += step[a];
+
+            seed = seed * 1664525u + 1013904223u;
+            int32_t noise = (int32_t)seed >> 8;
+
+            int64_t v = (int64_t)offset[a] + (((int64_t)amplitude[a] * s) >> 15) + noise;
+            q31_t q = (v > INT32_MAX) ? INT32_MAX : (v < INT32_MIN) ? INT32_MIN : (q31_t)v;
+
+            uint32_t idx = a * bench.n + i;
+            switch (bench.type)
+            {
+                case BENCH_Q15: ((q15_t *)bench.in)[idx] = (q15_t)(q >> 16); break;
+                case BENCH_Q31: ((q31_t *)bench.in)[idx] = q; break;
+                default:        ((float32_t *)bench.in)[idx] = (float32_t)q * (1.0f / 2147483648.0f); break;
+            }
+        }
+    }
+}
+
+static bench_result_t bench_alloc_io(uint32_t out_elems)
+{
+    size_t elem = bench_type_size[bench.type];
+    bench.in = bench_alloc(BENCH_AXES * bench.n * elem);
+    bench.out = bench_alloc(out_elems * elem);
+    return (bench.in != NULL && bench.out != NULL) ? BENCH_OK : BENCH_NO_MEM;
+}
+
+// =============================================================================
+// Biquad
+// =============================================================================
+
+static bench_result_t bench_biquad_setup(void)
+{
+    if (bench_alloc_io(BENCH_AXES * bench.n) != BENCH_OK)
+    {
+        return BENCH_NO_MEM;
+    }
+
+    const uint32_t stages = BENCH_BIQUAD_STAGES;
+    const float32_t *c = bench_biquad_coeffs;
+
+    if (bench.type == BENCH_Q15)
+    {
+        // q15 layout {b0, 0, b1, b2, a1, a2}, coefficients halved (postShift 1)
+        q15_t *coeffs = bench_alloc(6 * stages * sizeof(q15_t));
+        if (coeffs == NULL)
+        {
+            return BENCH_NO_MEM;
+        }
+        for (uint32_t s = 0; s < stages; s++)
+        {
+            q15_t *k = &coeffs[6 * s];
+            k[0] = bench_q15(c[0] / 2); k[1] = 0; k[2] = bench_q15(c[1] / 2);
+            k[3] = bench_q15(c[2] / 2); k[4] = bench_q15(c[3] / 2); k[5] = bench_q15(c[4] / 2);
+        }
+        for (uint32_t a = 0; a < BENCH_AXES; a++)
+        {
+            arm_biquad_casd_df1_inst_q15 *S = bench_alloc(sizeof(*S));
+            q15_t *state = bench_alloc(4 * stages * sizeof(q15_t));
+            if (S == NULL || state == NULL)
+            {
+                return BENCH_NO_MEM;
+            }
+            arm_biquad_cascade_df1_init_q15(S, stages, coeffs, state, 1);
+            bench.inst[a] = S;
+        }
+    }
+    else if (bench.type == BENCH_Q31)
+    {
+        q31_t *coeffs = bench_alloc(5 * stages * sizeof(q31_t));
+        if (coeffs == NULL)
+        {
+            return BENCH_NO_MEM;
+        }
+        for (uint32_t i = 0; i < 5 * stages; i++)
+        {
+            coeffs[i] = bench_q31(c[i % 5] / 2);
+        }
+        for (uint32_t a = 0; a < BENCH_AXES; a++)
+        {
+            arm_biquad_casd_df1_inst_q31 *S = bench_alloc(sizeof(*S));
+            q31_t *state = bench_alloc(4 * stages * sizeof(q31_t));
+            if (S == NULL || state == NULL)
+            {
+                return BENCH_NO_MEM;
+            }
+            arm_biquad_cascade_df1_init_q31(S, stages, coeffs, state, 1);
+            bench.inst[a] = S;
+        }
+    }
+    else
+    {
+        float32_t *coeffs = bench_alloc(5 * stages * sizeof(float32_t));
+        if (coeffs == NULL)
+        {
+            return BENCH_NO_MEM;
+        }
+        for (uint32_t i = 0; i < 5 * stages; i++)
+        {
+            coeffs[i] = c[i % 5];
+        }
+        for (uint32_t a = 0; a < BENCH_AXES; a++)
+        {
+            arm_biquad_casd_df1_inst_f32 *S = bench_alloc(sizeof(*S));
+            float32_t *state = bench_alloc(4 * stages * sizeof(float32_t));
+            if (S == NULL || state == NULL)
+            {
+                return BENCH_NO_MEM;
+            }
+            arm_biquad_cascade_df1_init_f32(S, stages, coeffs, state);
+            bench.inst[a] = S;
+        }
+    }
+
+    return BENCH_OK;
+}
+
+static void bench_biquad_run(void)
+{
+    for (uint32_t a = 0; a < BENCH_AXES; a++)
+    {
+        switch (bench.type)
+        {
+            case BENCH_Q15:
+                arm_biquad_cascade_df1_q15(bench.inst[a], bench_axis(bench.in, a), bench_axis(bench.out, a), bench.n);
+                break;
+            case BENCH_Q31:
+                arm_biquad_cascade_df1_q31(bench.inst[a], bench_axis(bench.in, a), bench_axis(bench.out, a), bench.n);
+                break;
+            default:
+                arm_biquad_cascade_df1_f32(bench.inst[a], bench_axis(bench.in, a), bench_axis(bench.out, a), bench.n);
+                break;
+        }
+    }
+}
+
+// =============================================================================
+// FIR
+// =============================================================================
+
+static bench_result_t bench_fir_setup(void)
+{
+    if (bench_alloc_io(BENCH_AXES * bench.n) != BENCH_OK)
+    {
+        return BENCH_NO_MEM;
+    }
+
+    // Boxcar average, the simplest low-pass that is exact in every format
+    const uint32_t taps = BENCH_FIR_TAPS;
+    const float32_t tap = 1.0f / BENCH_FIR_TAPS;
+    size_t elem = bench_type_size[bench.type];
+    void *coeffs = bench_alloc(taps * elem);
+    if (coeffs == NULL)
+    {
+        return BENCH_NO_MEM;
+    }
+    for (uint32_t i = 0; i < taps; i++)
+    {
+        switch (bench.type)
+        {
+            case BENCH_Q15: ((q15_t *)coeffs)[i] = bench_q15(tap); break;
+            case BENCH_Q31: ((q31_t *)coeffs)[i] = bench_q31(tap); break;
+            default:        ((float32_t *)coeffs)[i] = tap; break;
+        }
+    }
+
+    for (uint32_t a = 0; a < BENCH_AXES; a++)
+    {
+        // q15 needs one extra state word
+        void *state = bench_alloc((taps + bench.n) * elem);
+        if (state == NULL)
+        {
+            return BENCH_NO_MEM;
+        }
+        switch (bench.type)
+        {
+            case BENCH_Q15:
+            {
+                arm_fir_instance_q15 *S = bench_alloc(sizeof(*S));
+                if (S == NULL)
+                {
+                    return BENCH_NO_MEM;
+                }
+                if (arm_fir_init_q15(S, taps, coeffs, state, bench.n) != ARM_MATH_SUCCESS)
+                {
+                    return BENCH_UNSUPPORTED;
+                }
+                bench.inst[a] = S;
+                break;
+            }
+            case BENCH_Q31:
+            {
+                arm_fir_instance_q31 *S = bench_alloc(sizeof(*S));
+                if (S == NULL)
+                {
+                    return BENCH_NO_MEM;
+                }
+                arm_fir_init_q31(S, taps, coeffs, state, bench.n);
+                bench.inst[a] = S;
+                break;
+            }
+            default:
+            {
+                arm_fir_instance_f32 *S = bench_alloc(sizeof(*S));
+                if (S == NULL)
+                {
+                    return BENCH_NO_MEM;
+                }
+                arm_fir_init_f32(S, taps, coeffs, state, bench.n);
+                bench.inst[a] = S;
+                break;
+            }
+        }
+    }
+
+    return BENCH_OK;
+}
+
+static void bench_fir_run(void)
+{
+    for (uint32_t a = 0; a < BENCH_AXES; a++)
+    {
+        switch (bench.type)
+        {
+            case BENCH_Q15:
+                arm_fir_q15(bench.inst[a], bench_axis(bench.in, a), bench_axis(bench.out, a), bench.n);
+                break;
+            case BENCH_Q31:
+                arm_fir_q31(bench.inst[a], bench_axis(bench.in, a), bench_axis(bench.out, a), bench.n);
+                break;
+            default:
+                arm_fir_f32(bench.inst[a], bench_axis(bench.in, a), bench_axis(bench.out, a), bench.n);
+                break;
+        }
+    }
+}
+
+// =============================================================================
+// RFFT
+// =============================================================================
+
+#if DSP_BENCH_FIXED_RFFT
+static arm_status bench_rfft_init_q15(arm_rfft_instance_q15 *S, uint32_t n)
+{
+    switch (n)
+    {
+        case 32:  return arm_rfft_init_32_q15(S, 0, 1);
+        case 64:  return arm_rfft_init_64_q15(S, 0, 1);
+        case 128: return arm_rfft_init_128_q15(S, 0, 1);
+        case 256: return arm_rfft_init_256_q15(S, 0, 1);
+        case 512: return arm_rfft_init_512_q15(S, 0, 1);
+        default:  return ARM_MATH_ARGUMENT_ERROR;
+    }
+}
+
+static arm_status bench_rfft_init_q31(arm_rfft_instance_q31 *S, uint32_t n)
+{
+    switch (n)
+    {
+        case 32:  return arm_rfft_init_32_q31(S, 0, 1);
+        case 64:  return arm_rfft_init_64_q31(S, 0, 1);
+        case 128: return arm_rfft_init_128_q31(S, 0, 1);
+        case 256: return arm_rfft_init_256_q31(S, 0, 1);
+        case 512: return arm_rfft_init_512_q31(S, 0, 1);
+        default:  return ARM_MATH_ARGUMENT_ERROR;
+    }
+}
+#endif
+
+// Size-specific inits so only the tables for these lengths are linked
+static arm_status bench_rfft_init_f32(arm_rfft_fast_instance_f32 *S, uint32_t n)
+{
+    switch (n)
+    {
+        case 32:  return arm_rfft_fast_init_32_f32(S);
+        case 64:  return arm_rfft_fast_init_64_f32(S);
+        case 128: return arm_rfft_fast_init_128_f32(S);
+        case 256: return arm_rfft_fast_init_256_f32(S);
+        case 512: return arm_rfft_fast_init_512_f32(S);
+        default:  return ARM_MATH_ARGUMENT_ERROR;
+    }
+}
+
+static bench_result_t bench_rfft_setup(void)
+{
+    if (bench.n < 32)
+    {
+        return BENCH_UNSUPPORTED;
+    }
+#if !DSP_BENCH_FIXED_RFFT
+    if (bench.type != BENCH_F32)
+    {
+        return BENCH_UNSUPPORTED;
+    }
+#endif
+
+    // Fixed-point RFFTs write the full 2N spectrum, f32 the packed N values.
+    // One output block is reused for all axes.
+    if (bench_alloc_io(bench.type == BENCH_F32 ? bench.n : 2 * bench.n) != BENCH_OK)
+    {
+        return BENCH_NO_MEM;
+    }
+
+    arm_status status;
+    switch (bench.type)
+    {
+#if DSP_BENCH_FIXED_RFFT
+        case BENCH_Q15:
+        {
+            arm_rfft_instance_q15 *S = bench_alloc(sizeof(*S));
+            status = (S != NULL) ? bench_rfft_init_q15(S, bench.n) : ARM_MATH_SIZE_MISMATCH;
+            bench.inst[0] = S;
+            break;
+        }
+        case BENCH_Q31:
+        {
+            arm_rfft_instance_q31 *S = bench_alloc(sizeof(*S));
+            status = (S != NULL) ? bench_rfft_init_q31(S, bench.n) : ARM_MATH_SIZE_MISMATCH;
+            bench.inst[0] = S;
+            break;
+        }
+#endif
+        default:
+        {
+            arm_rfft_fast_instance_f32 *S = bench_alloc(sizeof(*S));
+            status = (S != NULL) ? bench_rfft_init_f32(S, bench.n) : ARM_MATH_SIZE_MISMATCH;
+            bench.inst[0] = S;
+            break;
+        }
+    }
+
+    if (bench.inst[0] == NULL)
+    {
+        return BENCH_NO_MEM;
+    }
+    return (status == ARM_MATH_SUCCESS) ? BENCH_OK : BENCH_UNSUPPORTED;
+}
+
+static void bench_rfft_run(void)
+{
+    for (uint32_t a = 0; a < BENCH_AXES; a++)
+    {
+        switch (bench.type)
+        {
+#if DSP_BENCH_FIXED_RFFT
+            case BENCH_Q15:
+                arm_rfft_q15(bench.inst[0], bench_axis(bench.in, a), bench.out);
+                break;
+            case BENCH_Q31:
+                arm_rfft_q31(bench.inst[0], bench_axis(bench.in, a), bench.out);
+                break;
+#endif
+            default:
+                arm_rfft_fast_f32(bench.inst[0], bench_axis(bench.in, a), bench.out, 0);
+                break;
+        }
+    }
+}
+
+// =============================================================================
+// Matrix
+// =============================================================================
+
+static bench_result_t bench_matrix_setup(void)
+{
+    if (bench_alloc_io(BENCH_AXES * bench.n) != BENCH_OK)
+    {
+        return BENCH_NO_MEM;
+    }
+
+    size_t elem = bench_type_size[bench.type];
+    void *rot = bench_alloc(9 * elem);
+    if (rot == NULL)
+    {
+        return BENCH_NO_MEM;
+    }
+
+    // inst[0] = rotation, inst[1] = samples (3xN), inst[2] = result
+    switch (bench.type)
+    {
+        case BENCH_Q15:
+        {
+            arm_matrix_instance_q15 *m = bench_alloc(3 * sizeof(*m));
+            bench.work = bench_alloc(BENCH_AXES * bench.n * sizeof(q15_t));
+            if (m == NULL || bench.work == NULL)
+            {
+                return BENCH_NO_MEM;
+            }
+            for (uint32_t i = 0; i < 9; i++)
+            {
+                ((q15_t *)rot)[i] = bench_q15(bench_rotation[i]);
+            }
+            arm_mat_init_q15(&m[0], 3, 3, rot);
+            arm_mat_init_q15(&m[1], 3, bench.n, bench.in);
+            arm_mat_init_q15(&m[2], 3, bench.n, bench.out);
+            for (uint32_t i = 0; i < 3; i++)
+            {
+                bench.inst[i] = &m[i];
+            }
+            break;
+        }
+        case BENCH_Q31:
+        {
+            arm_matrix_instance_q31 *m = bench_alloc(3 * sizeof(*m));
+            if (m == NULL)
+            {
+                return BENCH_NO_MEM;
+            }
+            for (uint32_t i = 0; i < 9; i++)
+            {
+                ((q31_t *)rot)[i] = bench_q31(bench_rotation[i]);
+            }
+            arm_mat_init_q31(&m[0], 3, 3, rot);
+            arm_mat_init_q31(&m[1], 3, bench.n, bench.in);
+            arm_mat_init_q31(&m[2], 3, bench.n, bench.out);
+            for (uint32_t i = 0; i < 3; i++)
+            {
+                bench.inst[i] = &m[i];
+            }
+            break;
+        }
+        default:
+        {
+            arm_matrix_instance_f32 *m = bench_alloc(3 * sizeof(*m));
+            if (m == NULL)
+            {
+                return BENCH_NO_MEM;
+            }
+            memcpy(rot, bench_rotation, sizeof(bench_rotation));
+            arm_mat_init_f32(&m[0], 3, 3, rot);
+            arm_mat_init_f32(&m[1], 3, bench.n, bench.in);
+            arm_mat_init_f32(&m[2], 3, bench.n, bench.out);
+            for (uint32_t i = 0; i < 3; i++)
+            {
+                bench.inst[i] = &m[i];
+            }
+            break;
+        }
+    }
+
+    return BENCH_OK;
+}
+
+static void bench_matrix_run(void)
+{
+    switch (bench.type)
+    {
+        case BENCH_Q15:
+            arm_mat_mult_q15(bench.inst[0], bench.inst[1], bench.inst[2], bench.work);
+            break;
+        case BENCH_Q31:
+            arm_mat_mult_q31(bench.inst[0], bench.inst[1], bench.inst[2]);
+            break;
+        default:
+            arm_mat_mult_f32(bench.inst[0], bench.inst[1], bench.inst[2]);
+            break;
+    }
+}
+
+// =============================================================================
+// Statistics
+// =============================================================================
+
+static bench_result_t bench_stats_setup(void)
+{
+    // Results are scalars, out holds mean/var/max per axis
+    return bench_alloc_io(3 * BENCH_AXES);
+}
+
+static void bench_stats_run(void)
+{
+    uint32_t index;
+
+    for (uint32_t a = 0; a < BENCH_AXES; a++)
+    {
+        switch (bench.type)
+        {
+            case BENCH_Q15:
+            {
+                const q15_t *x = bench_axis(bench.in, a);
+                q15_t *r = (q15_t *)bench.out + 3 * a;
+                arm_mean_q15(x, bench.n, &r[0]);
+                arm_var_q15(x, bench.n, &r[1]);
+                arm_max_q15(x, bench.n, &r[2], &index);
+                break;
+            }
+            case BENCH_Q31:
+            {
+                const q31_t *x = bench_axis(bench.in, a);
+                q31_t *r = (q31_t *)bench.out + 3 * a;
+                arm_mean_q31(x, bench.n, &r[0]);
+                arm_var_q31(x, bench.n, &r[1]);
+                arm_max_q31(x, bench.n, &r[2], &index);
+                break;
+            }
+            default:
+            {
+                const float32_t *x = bench_axis(bench.in, a);
+                float32_t *r = (float32_t *)bench.out + 3 * a;
+                arm_mean_f32(x, bench.n, &r[0]);
+                arm_var_f32(x, bench.n, &r[1]);
+                arm_max_f32(x, bench.n, &r[2], &index);
+                break;
+            }
+        }
+    }
+}
+
+// =============================================================================
+// Quaternion integration
+// =============================================================================
+
+static bench_result_t bench_quat_setup(void)
+{
+    if (bench.type == BENCH_Q15)
+    {
+        return BENCH_UNSUPPORTED;
+    }
+    // out holds the attitude, then the batch's exp map work buffer
+    return bench_alloc_io(4 + 4 * bench.n);
+}
+
+/**
+ * @brief Integrates the input block from identity, batched or per sample.
+ * f32 rates are the same fractions of full scale as q31, so dt is scaled
+ * to keep both integrating the same rotation.
+ */
+static void bench_quat(bool batched)
+{
+    if (bench.type == BENCH_Q31)
+    {
+        const q31_t *g = bench.in;
+        q31_t *q = bench.out;
+        const q31_t scale = quat_half_angle_scale_q31(BENCH_QUAT_DT);
+        q[0] = INT32_MAX;
+        q[1] = q[2] = q[3] = 0;
+        if (batched)
+        {
+            quat_integrate_q31(q, g, g + bench.n, g + 2 * bench.n, bench.n, scale, q + 4);
+            return;
+        }
+        for (uint32_t i = 0; i < bench.n; i++)
+        {
+            quat_update_q31(q, g[i], g[bench.n + i], g[2 * bench.n + i], scale);
+        }
+    }
+    else
+    {
+        const float32_t *g = bench.in;
+        float32_t *q = bench.out;
+        const float32_t dt = BENCH_QUAT_DT * QUAT_GYRO_FULL_SCALE;
+        q[0] = 1.0f;
+        q[1] = q[2] = q[3] = 0.0f;
+        if (batched)
+        {
+            quat_integrate_f32(q, g, g + bench.n, g + 2 * bench.n, bench.n, dt, q + 4);
+            return;
+        }
+        for (uint32_t i = 0; i < bench.n; i++)
+        {
+            quat_update_f32(q, g[i], g[bench.n + i], g[2 * bench.n + i], dt);
+        }
+    }
+}
+
+static void bench_quat_run(void)
+{
+    bench_quat(true);
+}
+
+static void bench_quat1_run(void)
+{
+    bench_quat(false);
+}
+
+/**
+ * @brief Largest component difference between the batched and per-sample
+ * attitudes of one block, and between q31 and f32, in ppm of a unit
+ * quaternion.
+ */
+static void bench_quat_check(dsp_bench_out_t out)
+{
+    float32_t q[BENCH_TYPE_COUNT][2][4];
+    char line[96];
+
+    bench.n = 64;
+    for (uint32_t t = BENCH_Q31; t < BENCH_TYPE_COUNT; t++)
+    {
+        bench.type = (bench_type_t)t;
+        bench.used = 0;
+        if (bench_quat_setup() != BENCH_OK)
+        {
+            return;
+        }
+        bench_fill();
+        for (int batched = 0; batched < 2; batched++)
+        {
+            bench_quat(batched != 0);
+            for (int c = 0; c < 4; c++)
+            {
+                q[t][batched][c] = (t == BENCH_Q31) ? (float32_t)((q31_t *)bench.out)[c] * (1.0f / 2147483648.0f)
+                                                    : ((float32_t *)bench.out)[c];
+            }
+        }
+    }
+
+    float32_t d_q31 = 0.0f, d_f32 = 0.0f, d_fmt = 0.0f;
+    for (int c = 0; c < 4; c++)
+    {
+        d_q31 = fmaxf(d_q31, fabsf(q[BENCH_Q31][1][c] - q[BENCH_Q31][0][c]));
+        d_f32 = fmaxf(d_f32, fabsf(q[BENCH_F32][1][c] - q[BENCH_F32][0][c]));
+        d_fmt = fmaxf(d_fmt, fabsf(q[BENCH_Q31][1][c] - q[BENCH_F32][1][c]));
+    }
+    fmt_snprintf(line, sizeof(line), "quat n 64: batch vs per-sample %.2f ppm (q31) %.2f ppm (f32), q31 vs f32 %.2f ppm\r\n",
+                 d_q31 * 1e6f, d_f32 * 1e6f, d_fmt * 1e6f);
+    out(line);
+}
+
+// =============================================================================
+// Hot path
+// =============================================================================
+
+typedef struct {
+    const char *name;
+    uintptr_t fn;               // the function measured, for its placement
+    void (*run)(void);
+} bench_hot_t;
+
+static struct {
+    imu_raw_t raw;
+    imu_t imu;
+    float32_t qf[4];
+    q31_t qq[4];
+    q31_t scale;
+    uint8_t fifo[8 * FIFO_RAW_FRAME_BYTES];     // one drain burst
+    int16_t axis[6][8];
+    fifo_out_t fifo_out;
+} hot;
+
+static void bench_hot_none_run(void)
+{
+}
+
+static void bench_hot_fsync_run(void)
+{
+    fsync_edge(DWT->CYCCNT);
+}
+
+static void bench_hot_decode_run(void)
+{
+    imu_decode(&hot.raw, &hot.imu);
+}
+
+static void bench_hot_fifo_run(void)
+{
+    fifo_decode_raw(hot.fifo, 8, &hot.fifo_out);
+}
+
+static void bench_hot_quat_f32_run(void)
+{
+    quat_update_f32(hot.qf, 0.01f, -0.02f, 0.005f, BENCH_QUAT_DT * QUAT_GYRO_FULL_SCALE);
+}
+
+static void bench_hot_quat_q31_run(void)
+{
+    quat_update_q31(hot.qq, 0x00800000, -0x01000000, 0x00400000, hot.scale);
+}
+
+static const bench_hot_t bench_hot[] = {
+    {"fsync_edge",      (uintptr_t)fsync_edge,      bench_hot_fsync_run},
+    {"imu_decode",      (uintptr_t)imu_decode,      bench_hot_decode_run},
+    {"fifo_decode_raw", (uintptr_t)fifo_decode_raw, bench_hot_fifo_run},
+    {"quat_update_f32", (uintptr_t)quat_update_f32, bench_hot_quat_f32_run},
+    {"quat_update_q31", (uintptr_t)quat_update_q31, bench_hot_quat_q31_run},
+};
+
+#define BENCH_NUM_HOT (sizeof(bench_hot) / sizeof(bench_hot[0]))
+
+static const char *bench_hot_where(uintptr_t fn)
+{
+#ifdef HOST_BUILD
+    (void)fn;
+    return "host";
+#else
+    // SRAM is 0x20000000 on, flash code 0x08000000
+    return ((fn & 0xF0000000u) == 0x20000000u) ? "RAM" : "flash";
+#endif
+}
+
+/**
+ * @brief Best cycle count of one call over reps, without the call itself.
+ */
+static uint32_t bench_hot_cycles(void (*run)(void), uint32_t reps, uint32_t overhead)
+{
+    uint32_t best = UINT32_MAX;
+    for (uint32_t r = 0; r < reps; r++)
+    {
+        uint32_t start = DWT->CYCCNT;
+        run();
+        uint32_t elapsed = DWT->CYCCNT - start;
+
+        elapsed = (elapsed > overhead) ? elapsed - overhead : 0;
+        best = (elapsed < best) ? elapsed : best;
+    }
+    return best;
+}
+
+// =============================================================================
+// Runner
+// =============================================================================
+
+/**
+ * @return Cost of the timing itself, cycles
+ */
+static uint32_t bench_overhead(void)
+{
+    uint32_t overhead = UINT32_MAX;
+    for (uint32_t r = 0; r < 8; r++)
+    {
+        uint32_t start = DWT->CYCCNT;
+        uint32_t elapsed = DWT->CYCCNT - start;
+        overhead = (elapsed < overhead) ? elapsed : overhead;
+    }
+    return overhead;
+}
+
+static const bench_kernel_t bench_kernels[] = {
+    {"biquad", bench_biquad_setup, bench_biquad_run},
+    {"fir",    bench_fir_setup,    bench_fir_run},
+    {"rfft",   bench_rfft_setup,   bench_rfft_run},
+    {"matrix", bench_matrix_setup, bench_matrix_run},
+    {"stats",  bench_stats_setup,  bench_stats_run},
+    {"quat",   bench_quat_setup,   bench_quat_run},
+    {"quat1",  bench_quat_setup,   bench_quat1_run},
+};
+
+#define BENCH_NUM_KERNELS (sizeof(bench_kernels) / sizeof(bench_kernels[0]))
+
+/**
+ * @brief Runs one cell and returns the best cycle count over reps.
+ */
+static bench_result_t bench_cell(const bench_kernel_t *k, uint32_t reps, uint32_t overhead,
+                                 uint32_t *cycles)
+{
+    bench.used = 0;
+    bench.work = NULL;
+    memset(bench.inst, 0, sizeof(bench.inst));
+
+    bench_result_t res = k->setup();
+    if (res != BENCH_OK)
+    {
+        return res;
+    }
+
+    uint32_t best = UINT32_MAX;
+    for (uint32_t r = 0; r < reps; r++)
+    {
+        // Some kernels work in place on their input (RFFT)
+        bench_fill();
+
+        uint32_t start = DWT->CYCCNT;
+        k->run();
+        uint32_t elapsed = DWT->CYCCNT - start;
+
+        elapsed = (elapsed > overhead) ? elapsed - overhead : 0;
+        best = (elapsed < best) ? elapsed : best;
+    }
+
+    *cycles = best;
+    return BENCH_OK;
+}
+
+int dsp_bench_run(dsp_bench_out_t out, uint32_t reps)
+{
+    char line[128];
+    int len;
+
+    if (reps == 0)
+    {
+        reps = DSP_BENCH_DEFAULT_REPS;
+    }
+
+    bench.arena = scratch_acquire(SCRATCH_OWNER_DSP, SCRATCH_SIZE);
+    if (bench.arena == NULL)
+    {
+        out("bench: scratch arena busy\r\n");
+        return 1;
+    }
+
+    uint32_t overhead = bench_overhead();
+
+    fmt_snprintf(line, sizeof(line),
+                 "DWT cycles per sample, %d axes, best of %lu, scratch %u B\r\n",
+                 BENCH_AXES, (unsigned long)reps, (unsigned)SCRATCH_SIZE);
+    out(line);
+
+    len = fmt_snprintf(line, sizeof(line), "%-12s", "kernel");
+    for (uint32_t s = 0; s < BENCH_NUM_SIZES; s++)
+    {
+        len += fmt_snprintf(line + len, sizeof(line) - len, "%9u", (unsigned)bench_sizes[s]);
+    }
+    fmt_snprintf(line + len, sizeof(line) - len, "\r\n");
+    out(line);
+
+    for (uint32_t k = 0; k < BENCH_NUM_KERNELS; k++)
+    {
+        for (uint32_t t = 0; t < BENCH_TYPE_COUNT; t++)
+        {
+            // Keep TX interrupts out of the measurement
+            uart_tx_flush();
+
+            len = fmt_snprintf(line, sizeof(line), "%-7s %-4s", bench_kernels[k].name, bench_type_names[t]);
+            for (uint32_t s = 0; s < BENCH_NUM_SIZES; s++)
+            {
+                uint32_t cycles = 0;
+                bench.type = (bench_type_t)t;
+                bench.n = bench_sizes[s];
+
+                bench_result_t res = bench_cell(&bench_kernels[k], reps, overhead, &cycles);
+                if (res == BENCH_OK)
+                {
+                    float per_sample = (float)cycles / (float)(BENCH_AXES * bench.n);
+                    len += fmt_snprintf(line + len, sizeof(line) - len, "%9.2f", per_sample);
+                }
+                else
+                {
+                    len += fmt_snprintf(line + len, sizeof(line) - len, "%9s",
+                                        res == BENCH_UNSUPPORTED ? "n/a" : "-");
+                }
+            }
+            fmt_snprintf(line + len, sizeof(line) - len, "\r\n");
+            out(line);
+        }
+    }
+
+    out("n/a: no variant for this size, -: does not fit in scratch\r\n");
+    bench_quat_check(out);
+
+    scratch_release(SCRATCH_OWNER_DSP);
+    return 0;
+}
+
+int dsp_bench_hot(dsp_bench_out_t out, uint32_t reps)
+{
+    char line[96];
+    fsync_summary_t fs;
+
+    if (reps == 0)
+    {
+        reps = DSP_BENCH_DEFAULT_REPS;
+    }
+
+    // A sample at rest, 1 g on z and a slow roll
+    memset(&hot, 0, sizeof(hot));
+    hot.raw.acc[2] = 16384;
+    hot.raw.gyr[0] = 164;
+    hot.qf[0] = 1.0f;
+    hot.qq[0] = INT32_MAX;
+    hot.scale = quat_half_angle_scale_q31(BENCH_QUAT_DT);
+    for (int c = 0; c < 3; c++)
+    {
+        hot.fifo_out.acc[c] = hot.axis[c];
+        hot.fifo_out.gyr[c] = hot.axis[3 + c];
+    }
+    hot.fifo_out.stride = 1;
+
+    // An indirect call to an empty function is the baseline
+    uart_tx_flush();
+    const uint32_t overhead = bench_overhead();
+    const uint32_t call = bench_hot_cycles(bench_hot_none_run, reps, overhead);
+    fsync_get_summary(&fs);
+
+    fmt_snprintf(line, sizeof(line), "DWT cycles per call, best of %lu, RAMFUNC isr %d decode %d filter %d cli %d\r\n",
+                 (unsigned long)reps, RAMFUNC_ISR, RAMFUNC_DECODE, RAMFUNC_FILTER, RAMFUNC_CLI);
+    out(line);
+    fmt_snprintf(line, sizeof(line), "%-16s %-6s %7s\r\n", "function", "where", "cycles");
+    out(line);
+    for (uint32_t k = 0; k < BENCH_NUM_HOT; k++)
+    {
+        const bench_hot_t *h = &bench_hot[k];
+
+        // Made-up edges would be matched to samples
+        if (h->run == bench_hot_fsync_run && fs.enabled)
+        {
+            fmt_snprintf(line, sizeof(line), "%-16s %-6s %7s\r\n", h->name, bench_hot_where(h->fn), "-");
+            out(line);
+            continue;
+        }
+
+        uart_tx_flush();
+        uint32_t cycles = bench_hot_cycles(h->run, reps, overhead);
+        cycles = (cycles > call) ? cycles - call : 0;
+        fmt_snprintf(line, sizeof(line), "%-16s %-6s %7lu\r\n", h->name, bench_hot_where(h->fn), (unsigned long)cycles);
+        out(line);
+    }
+    if (fs.enabled)
+    {
+        out("-: fsync is on\r\n");
+    }
+    return 0;
+}
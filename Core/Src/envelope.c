@@ -0,0 +1,363 @@
+/*
+ * envelope.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: halvard
+ *
+ *  Description: envelope spectrum of one IMU channel (bearing-fault analysis)
+ */
+
+#include "envelope.h"
+#include "pipeline.h"
+#include "scratch.h"
+#include "main.h"
+#include "arm_math.h"
+#include "arm_const_structs.h"
+
+#include <math.h>
+#include <string.h>
+
+#define ENVELOPE_STAGES 2       // high-pass + low-pass section
+
+envelope_config_t envelope_config = {
+    .channel = 2,
+    .band_lo = 10.0f,
+    .band_hi = 40.0f,
+    .dec = 4,
+    .n = 128,
+    .log = false,
+};
+
+static struct {
+    bool enabled;
+    envelope_config_t active;
+    uint16_t rate_hz;           // rate the filters were designed for
+    float full_scale;
+    const arm_cfft_instance_q31 *cfft;
+
+    arm_biquad_casd_df1_inst_q31 biquad;
+    arm_fir_decimate_instance_q31 fir;
+
+    // Scratch arena layout
+    q31_t *biquad_coeffs;       // [5 * stages]
+    q31_t *biquad_state;        // [4 * stages]
+    q31_t *fir_coeffs;          // [taps]
+    q31_t *fir_state;           // [taps + dec - 1]
+    q31_t *block;               // [dec]
+    q31_t *fft;                 // [2n] interleaved re/im, filled with envelope
+    q31_t *mag;                 // [n/2 + 1] last magnitude spectrum
+    uint32_t mag_shift;         // block exponent of mag
+
+    uint32_t block_fill;
+    uint32_t fft_fill;
+    uint64_t chain_cycles;      // per block of dec samples, summed
+    uint32_t chain_blocks;
+
+    envelope_summary_t summary;
+} env;
+
+static q31_t envelope_to_q31(float x)
+{
+    // Clamp below 1.0 so the conversion can't overflow
+    if (x >= 0.999999f)
+    {
+        return INT32_MAX;
+    }
+    if (x <= -1.0f)
+    {
+        return INT32_MIN;
+    }
+    return (q31_t)(x * 2147483648.0f);
+}
+
+/**
+ * @brief RBJ cookbook high-pass or low-pass section (Q = 1/sqrt(2)) in
+ * CMSIS df1 order {b0, b1, b2, a1, a2}, halved for postShift 1.
+ */
+static void envelope_design_section(q31_t *coeffs, float f0, float fs, bool high_pass)
+{
+    float w0 = 2.0f * PI * f0 / fs;
+    float cw = cosf(w0);
+    float alpha = sinf(w0) / (2.0f * 0.70710678f);
+    float a0 = 1.0f + alpha;
+    float b1 = high_pass ? -(1.0f + cw) : (1.0f - cw);
+    float b0 = 0.5f * (high_pass ? -b1 : b1);
+
+    coeffs[0] = envelope_to_q31(0.5f * b0 / a0);
+    coeffs[1] = envelope_to_q31(0.5f * b1 / a0);
+    coeffs[2] = envelope_to_q31(0.5f * b0 / a0);
+    coeffs[3] = envelope_to_q31(0.5f * (2.0f * cw) / a0);
+    coeffs[4] = envelope_to_q31(0.5f * -(1.0f - alpha) / a0);
+}
+
+/**
+ * @brief Hamming-windowed sinc low-pass at 0.4 / dec of the input rate,
+ * unity gain at DC. Doubles as the envelope smoother and anti-alias filter.
+ */
+static void envelope_design_fir(q31_t *coeffs, int dec)
+{
+    float h[ENVELOPE_FIR_TAPS];
+    float fc = 0.4f / (float)dec;
+    float sum = 0.0f;
+
+    for (int i = 0; i < ENVELOPE_FIR_TAPS; i++)
+    {
+        float t = (float)i - 0.5f * (ENVELOPE_FIR_TAPS - 1);
+        float sinc = (t == 0.0f) ? 2.0f * fc : sinf(2.0f * PI * fc * t) / (PI * t);
+        h[i] = sinc * (0.54f - 0.46f * cosf(2.0f * PI * (float)i / (ENVELOPE_FIR_TAPS - 1)));
+        sum += h[i];
+    }
+    for (int i = 0; i < ENVELOPE_FIR_TAPS; i++)
+    {
+        coeffs[i] = envelope_to_q31(h[i] / sum);
+    }
+}
+
+/**
+ * @brief Designs the filters for the current pipeline rate and clears all
+ * filter state and partial blocks.
+ * @return 0 on success, 1 if the band does not fit the rate
+ */
+static int envelope_configure(void)
+{
+    float fs = (float)pipeline_rate_hz();
+    const envelope_config_t *cfg = &env.active;
+
+    env.rate_hz = pipeline_rate_hz();
+    if (!(cfg->band_lo > 0.0f && cfg->band_lo < cfg->band_hi && cfg->band_hi < 0.45f * fs))
+    {
+        return 1;
+    }
+
+    envelope_design_section(&env.biquad_coeffs[0], cfg->band_lo, fs, true);
+    envelope_design_section(&env.biquad_coeffs[5], cfg->band_hi, fs, false);
+    arm_biquad_cascade_df1_init_q31(&env.biquad, ENVELOPE_STAGES, env.biquad_coeffs, env.biquad_state, 1);
+
+    envelope_design_fir(env.fir_coeffs, cfg->dec);
+    arm_fir_decimate_init_q31(&env.fir, ENVELOPE_FIR_TAPS, (uint8_t)cfg->dec, env.fir_coeffs, env.fir_state,
+                              (uint32_t)cfg->dec);
+
+    env.block_fill = 0;
+    env.fft_fill = 0;
+    return 0;
+}
+
+/**
+ * @brief Magnitude (2.30, |DFT| / n) to amplitude in channel units. A sine
+ * of amplitude A under the Hann window gives |DFT| = A n / 4.
+ */
+static float envelope_amplitude(q31_t mag)
+{
+    return ldexpf((float)mag * (4.0f / 1073741824.0f) * env.full_scale, -(int)env.mag_shift);
+}
+
+static void envelope_spectrum(void)
+{
+    const uint32_t n = (uint32_t)env.active.n;
+    q31_t *x = env.fft;
+
+    // Remove the envelope's DC (mean rectified level) and apply Hann. The
+    // CFFT twiddle table holds cos(2 pi k / n) for k < 3n/4, as pairs
+    int64_t sum = 0;
+    for (uint32_t k = 0; k < n; k++)
+    {
+        sum += x[2 * k];
+    }
+    q31_t mean = (q31_t)(sum / (int64_t)n);
+    const q31_t *twiddle = env.cfft->pTwiddle;
+    q31_t peak_abs = 0;
+    for (uint32_t k = 0; k < n; k++)
+    {
+        uint32_t t = (k < 3 * n / 4) ? k : n - k;
+        int64_t hann = 0x40000000 - (twiddle[2 * t] >> 1);              // 0.5 - 0.5 cos, in 1.31
+        hann = (hann > INT32_MAX) ? INT32_MAX : hann;
+        x[2 * k] = (q31_t)(((int64_t)(x[2 * k] - mean) * hann) >> 31);
+        x[2 * k + 1] = 0;
+        q31_t a = (x[2 * k] < 0) ? -x[2 * k] : x[2 * k];
+        peak_abs = (a > peak_abs) ? a : peak_abs;
+    }
+
+    // Block floating point: the envelope's AC part is small next to the
+    // channel full scale, and arm_cmplx_mag_q31 keeps only the top bits of
+    // re^2 + im^2, so use the headroom before the FFT
+    uint32_t shift = 0;
+    while (peak_abs != 0 && peak_abs < 0x40000000 && shift < 30)
+    {
+        peak_abs <<= 1;
+        shift++;
+    }
+    arm_shift_q31(x, (int8_t)shift, x, 2 * n);
+    env.mag_shift = shift;
+
+    // The q31 CFFT scales by 1/n, arm_cmplx_mag_q31 outputs 2.30
+    arm_cfft_q31(env.cfft, x, 0, 1);
+    arm_cmplx_mag_q31(x, env.mag, n / 2 + 1);
+
+    // Largest local maxima above DC
+    envelope_peak_t *peak = env.summary.peak;
+    uint32_t bins[ENVELOPE_PEAKS] = {0};
+    q31_t vals[ENVELOPE_PEAKS] = {0};
+    for (uint32_t k = 2; k < n / 2; k++)
+    {
+        q31_t v = env.mag[k];
+        if (v <= env.mag[k - 1] || v < env.mag[k + 1])
+        {
+            continue;
+        }
+        for (int p = 0; p < ENVELOPE_PEAKS; p++)
+        {
+            if (v > vals[p])
+            {
+                for (int q = ENVELOPE_PEAKS - 1; q > p; q--)
+                {
+                    vals[q] = vals[q - 1];
+                    bins[q] = bins[q - 1];
+                }
+                vals[p] = v;
+                bins[p] = k;
+                break;
+            }
+        }
+    }
+
+    env.summary.bin_hz = (float)env.rate_hz / (float)env.active.dec / (float)n;
+    for (int p = 0; p < ENVELOPE_PEAKS; p++)
+    {
+        peak[p].freq = (float)bins[p] * env.summary.bin_hz;
+        peak[p].amp = envelope_amplitude(vals[p]);
+        if (vals[p] == 0)
+        {
+            peak[p].freq = 0.0f;
+            peak[p].amp = 0.0f;
+        }
+    }
+}
+
+int envelope_enable(void)
+{
+    envelope_disable();
+
+    const envelope_config_t *cfg = &envelope_config;
+    const arm_cfft_instance_q31 *cfft;
+    switch (cfg->n)
+    {
+        case 64:  cfft = &arm_cfft_sR_q31_len64;  break;
+        case 128: cfft = &arm_cfft_sR_q31_len128; break;
+        case 256: cfft = &arm_cfft_sR_q31_len256; break;
+        default:  return 1;
+    }
+    if (cfg->channel < 0 || cfg->channel >= IMU_CHANNELS || cfg->dec < 1 || cfg->dec > ENVELOPE_MAX_DEC)
+    {
+        return 1;
+    }
+
+    uint32_t n = (uint32_t)cfg->n;
+    uint32_t dec = (uint32_t)cfg->dec;
+    size_t words = 5 * ENVELOPE_STAGES + 4 * ENVELOPE_STAGES + ENVELOPE_FIR_TAPS
+                   + (ENVELOPE_FIR_TAPS + dec - 1) + dec + 2 * n + (n / 2 + 1);
+    q31_t *mem = scratch_acquire(SCRATCH_OWNER_ENVELOPE, words * sizeof(q31_t));
+    if (mem == NULL)
+    {
+        return 1;
+    }
+
+    memset(&env, 0, sizeof(env));
+    env.active = *cfg;
+    env.cfft = cfft;
+    env.full_scale = (cfg->channel < 3) ? ENVELOPE_ACCEL_FULL_SCALE : ENVELOPE_GYRO_FULL_SCALE;
+    env.biquad_coeffs = mem;
+    env.biquad_state = env.biquad_coeffs + 5 * ENVELOPE_STAGES;
+    env.fir_coeffs = env.biquad_state + 4 * ENVELOPE_STAGES;
+    env.fir_state = env.fir_coeffs + ENVELOPE_FIR_TAPS;
+    env.block = env.fir_state + (ENVELOPE_FIR_TAPS + dec - 1);
+    env.fft = env.block + dec;
+    env.mag = env.fft + 2 * n;
+    env.summary.ram_bytes = (uint32_t)(words * sizeof(q31_t));
+
+    if (envelope_configure() != 0)
+    {
+        scratch_release(SCRATCH_OWNER_ENVELOPE);
+        return 1;
+    }
+
+    env.enabled = true;
+    return 0;
+}
+
+void envelope_disable(void)
+{
+    if (env.enabled)
+    {
+        env.enabled = false;
+        scratch_release(SCRATCH_OWNER_ENVELOPE);
+    }
+}
+
+bool envelope_enabled(void)
+{
+    return env.enabled;
+}
+
+int envelope_process(const imu_t *imu)
+{
+    if (!env.enabled)
+    {
+        return 0;
+    }
+    if (pipeline_rate_hz() != env.rate_hz && envelope_configure() != 0)
+    {
+        // Band no longer fits below Nyquist at the new rate
+        envelope_disable();
+        return 0;
+    }
+
+    env.block[env.block_fill++] = envelope_to_q31(imu_channel(imu, env.active.channel) / env.full_scale);
+    if (env.block_fill < (uint32_t)env.active.dec)
+    {
+        return 0;
+    }
+    env.block_fill = 0;
+
+    uint32_t start = DWT->CYCCNT;
+    q31_t out;
+    arm_biquad_cascade_df1_q31(&env.biquad, env.block, env.block, (uint32_t)env.active.dec);
+    arm_abs_q31(env.block, env.block, (uint32_t)env.active.dec);
+    arm_fir_decimate_q31(&env.fir, env.block, &out, (uint32_t)env.active.dec);
+    env.chain_cycles += DWT->CYCCNT - start;
+    env.chain_blocks++;
+
+    env.fft[2 * env.fft_fill] = out;
+    env.fft_fill++;
+    if (env.fft_fill < (uint32_t)env.active.n)
+    {
+        return 0;
+    }
+    env.fft_fill = 0;
+
+    start = DWT->CYCCNT;
+    envelope_spectrum();
+    env.summary.fft_cycles = DWT->CYCCNT - start;
+    env.summary.chain_cycles = (uint32_t)(env.chain_cycles / ((uint64_t)env.chain_blocks * env.active.dec));
+    env.summary.spectra++;
+
+    return 1;
+}
+
+void envelope_get_summary(envelope_summary_t *summary)
+{
+    *summary = env.summary;
+}
+
+void envelope_get_active(envelope_config_t *config)
+{
+    *config = env.active;
+}
+
+float envelope_bin(uint32_t bin)
+{
+    if (env.summary.spectra == 0 || bin > (uint32_t)env.active.n / 2)
+    {
+        return 0.0f;
+    }
+    return envelope_amplitude(env.mag[bin]);
+}
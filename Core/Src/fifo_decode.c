@@ -0,0 +1,107 @@
+/*
+ * fifo_decode.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: halvard
+ *
+ *  Description: word-wise decode of big-endian MPU6050 FIFO packets
+ */
+
+#include "fifo_decode.h"
+#include "main.h"
+#include "mem_sections.h"
+
+#include <string.h>
+
+/**
+ * @brief 32-bit load at any alignment (a single LDR on the M3).
+ */
+static inline uint32_t ld32(const uint8_t *p)
+{
+    uint32_t w;
+    memcpy(&w, p, sizeof(w));
+    return w;
+}
+
+static inline uint16_t ld16(const uint8_t *p)
+{
+    uint16_t h;
+    memcpy(&h, p, sizeof(h));
+    return h;
+}
+
+/**
+ * @brief Three big-endian samples, the first two from one word.
+ */
+static inline void decode3(const uint8_t *p, int16_t *const axis[3], uint32_t at)
+{
+    const uint32_t w = __REV16(ld32(p));
+    axis[0][at] = (int16_t)w;
+    axis[1][at] = (int16_t)(w >> 16);
+    axis[2][at] = (int16_t)__REV16(ld16(p + 4));
+}
+
+/**
+ * @brief accel xyz then gyro xyz, three words.
+ */
+static inline void decode6(const uint8_t *p, int16_t *const acc[3], int16_t *const gyr[3], uint32_t at)
+{
+    const uint32_t w0 = __REV16(ld32(p));
+    const uint32_t w1 = __REV16(ld32(p + 4));
+    const uint32_t w2 = __REV16(ld32(p + 8));
+    acc[0][at] = (int16_t)w0;
+    acc[1][at] = (int16_t)(w0 >> 16);
+    acc[2][at] = (int16_t)w1;
+    gyr[0][at] = (int16_t)(w1 >> 16);
+    gyr[1][at] = (int16_t)w2;
+    gyr[2][at] = (int16_t)(w2 >> 16);
+}
+
+uint16_t fifo_dmp_packet_bytes(uint8_t fields)
+{
+    return ((fields & FIFO_DMP_QUAT) ? 16 : 0) + ((fields & FIFO_DMP_ACCEL) ? 6 : 0)
+           + ((fields & FIFO_DMP_GYRO) ? 6 : 0) + ((fields & FIFO_DMP_GESTURE) ? 4 : 0);
+}
+
+MEM_RAMFUNC(RAMFUNC_DECODE, fifo_decode_raw)
+void fifo_decode_raw(const uint8_t *buf, uint16_t frames, const fifo_out_t *out)
+{
+    for (uint32_t i = 0, at = 0; i < frames; i++, at += out->stride, buf += FIFO_RAW_FRAME_BYTES)
+    {
+        decode6(buf, out->acc, out->gyr, at);
+    }
+}
+
+MEM_RAMFUNC(RAMFUNC_DECODE, fifo_decode_dmp)
+void fifo_decode_dmp(const uint8_t *buf, uint16_t frames, uint8_t fields, const fifo_out_t *out)
+{
+    const uint16_t len = fifo_dmp_packet_bytes(fields);
+    const uint8_t motion = fields & (FIFO_DMP_ACCEL | FIFO_DMP_GYRO);
+
+    for (uint32_t i = 0, at = 0, qat = 0; i < frames; i++, at += out->stride, qat += out->quat_stride, buf += len)
+    {
+        const uint8_t *p = buf;
+        if (fields & FIFO_DMP_QUAT)
+        {
+            for (int c = 0; c < 4; c++)
+            {
+                out->quat[c][qat] = (int32_t)__REV(ld32(p + 4 * c));
+            }
+            p += 16;
+        }
+
+        // Both together are laid out like a raw frame
+        if (motion == (FIFO_DMP_ACCEL | FIFO_DMP_GYRO))
+        {
+            decode6(p, out->acc, out->gyr, at);
+        }
+        else if (motion == FIFO_DMP_ACCEL)
+        {
+            decode3(p, out->acc, at);
+        }
+        else if (motion == FIFO_DMP_GYRO)
+        {
+            decode3(p, out->gyr, at);
+        }
+    }
+}
@@ -0,0 +1,513 @@
+/*
+ * fmt.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: halvard
+ *
+ *  Description: allocation-free formatted output (printf subset)
+ *
+ *  Everything is formatted through a character sink, so the caller decides
+ *  where the bytes go (a stack buffer, the UART TX ring, ...). Nothing here
+ *  touches newlib stdio, the reent struct or the heap.
+ */
+
+#include "fmt.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define FMT_FLAG_LEFT   0x01
+#define FMT_FLAG_ZERO   0x02
+#define FMT_FLAG_PLUS   0x04
+#define FMT_FLAG_SPACE  0x08
+
+#define FMT_FLOAT_MAX_PRECISION 6
+#define FMT_FLOAT_MAX_VALUE     4294967040.0f // largest float below 2^32
+
+typedef struct {
+    fmt_sink_t sink;
+    void *ctx;
+    int count;
+} fmt_out_t;
+
+typedef struct {
+    char *buf;
+    size_t size;
+    size_t pos;
+} fmt_buffer_t;
+
+static const uint32_t fmt_pow10[FMT_FLOAT_MAX_PRECISION + 1] = {
+    1, 10, 100, 1000, 10000, 100000, 1000000
+};
+
+// =============================================================================
+// Output helpers
+// =============================================================================
+
+static void fmt_put(fmt_out_t *out, char c)
+{
+    out->sink(c, out->ctx);
+    out->count++;
+}
+
+static void fmt_pad(fmt_out_t *out, char c, int n)
+{
+    while (n-- > 0)
+    {
+        fmt_put(out, c);
+    }
+}
+
+/**
+ * @brief Emits sign/prefix, zero fill and digits, padded to the field width
+ * @param digits Digits in natural (most significant first) order
+ */
+static void fmt_emit(fmt_out_t *out, const char *prefix, const char *digits, int ndigits,
+                     int zeros, int width, uint8_t flags)
+{
+    int plen = 0;
+    while (prefix[plen] != '\0')
+    {
+        plen++;
+    }
+
+    int pad = width - (plen + zeros + ndigits);
+
+    if (!(flags & FMT_FLAG_LEFT) && !(flags & FMT_FLAG_ZERO))
+    {
+        fmt_pad(out, ' ', pad);
+    }
+    for (int i = 0; i < plen; i++)
+    {
+        fmt_put(out, prefix[i]);
+    }
+    if (!(flags & FMT_FLAG_LEFT) && (flags & FMT_FLAG_ZERO))
+    {
+        fmt_pad(out, '0', pad);
+    }
+    fmt_pad(out, '0', zeros);
+    for (int i = 0; i < ndigits; i++)
+    {
+        fmt_put(out, digits[i]);
+    }
+    if (flags & FMT_FLAG_LEFT)
+    {
+        fmt_pad(out, ' ', pad);
+    }
+}
+
+/**
+ * @brief Writes value in the given base into the end of buf
+ * @return Pointer to the first digit
+ */
+static char *fmt_utoa(char *end, uint64_t value, unsigned base, bool upper)
+{
+    const char *digits = upper ? "0123456789ABCDEF" : "0123456789abcdef";
+    char *p = end;
+
+    // 32-bit fast path, avoids the 64-bit division helper for the common case
+    if (value <= UINT32_MAX)
+    {
+        uint32_t v = (uint32_t)value;
+        do
+        {
+            *--p = digits[v % base];
+            v /= base;
+        } while (v != 0);
+        return p;
+    }
+
+    do
+    {
+        *--p = digits[value % base];
+        value /= base;
+    } while (value != 0);
+    return p;
+}
+
+static const char *fmt_sign_prefix(bool negative, uint8_t flags)
+{
+    if (negative)
+    {
+        return "-";
+    }
+    if (flags & FMT_FLAG_PLUS)
+    {
+        return "+";
+    }
+    if (flags & FMT_FLAG_SPACE)
+    {
+        return " ";
+    }
+    return "";
+}
+
+// =============================================================================
+// Conversions
+// =============================================================================
+
+static void fmt_integer(fmt_out_t *out, uint64_t magnitude, bool negative, unsigned base,
+                        bool upper, const char *prefix, int width, int precision, uint8_t flags)
+{
+    char buf[24];
+    char *end = buf + sizeof(buf);
+    char *digits = end;
+
+    // printf semantics: "%.0d" with value 0 prints nothing
+    if (!(precision == 0 && magnitude == 0))
+    {
+        digits = fmt_utoa(end, magnitude, base, upper);
+    }
+
+    int ndigits = (int)(end - digits);
+    int zeros = 0;
+    if (precision >= 0)
+    {
+        zeros = (precision > ndigits) ? precision - ndigits : 0;
+        flags &= (uint8_t)~FMT_FLAG_ZERO;
+    }
+
+    if (prefix == NULL)
+    {
+        prefix = fmt_sign_prefix(negative, flags);
+    }
+    fmt_emit(out, prefix, digits, ndigits, zeros, width, flags);
+}
+
+/**
+ * @brief Fixed-point %f: integer part and scaled fraction as two uint32
+ *
+ * Values are handled in single precision; magnitudes at or above 2^32 are
+ * printed as "ovf" rather than pulling in a full dtoa.
+ */
+static void fmt_float(fmt_out_t *out, float value, int width, int precision, uint8_t flags)
+{
+    char buf[24];
+    char *end = buf + sizeof(buf);
+    char *p = end;
+
+    if (precision < 0)
+    {
+        precision = FMT_FLOAT_MAX_PRECISION;
+    }
+    if (precision > FMT_FLOAT_MAX_PRECISION)
+    {
+        precision = FMT_FLOAT_MAX_PRECISION;
+    }
+
+    bool negative = (value < 0.0f);
+    if (negative)
+    {
+        value = -value;
+    }
+
+    if (value != value)
+    {
+        fmt_emit(out, "", "nan", 3, 0, width, flags & FMT_FLAG_LEFT);
+        return;
+    }
+    if (value >= FMT_FLOAT_MAX_VALUE)
+    {
+        const char *text = (value > 3.4028235e38f) ? "inf" : "ovf";
+        fmt_emit(out, fmt_sign_prefix(negative, flags), text, 3, 0, width, flags & FMT_FLAG_LEFT);
+        return;
+    }
+
+    uint32_t scale = fmt_pow10[precision];
+    uint32_t ipart = (uint32_t)value;
+    uint32_t fpart = (uint32_t)((value - (float)ipart) * (float)scale + 0.5f);
+    if (fpart >= scale)
+    {
+        fpart -= scale;
+        ipart++;
+    }
+
+    if (precision > 0)
+    {
+        for (int i = 0; i < precision; i++)
+        {
+            *--p = (char)('0' + fpart % 10);
+            fpart /= 10;
+        }
+        *--p = '.';
+    }
+    p = fmt_utoa(p, ipart, 10, false);
+
+    // Don't print "-0.000" for values that round to zero
+    if (negative && ipart == 0)
+    {
+        bool all_zero = true;
+        for (char *q = p; q < end; q++)
+        {
+            if (*q != '0' && *q != '.')
+            {
+                all_zero = false;
+                break;
+            }
+        }
+        negative = !all_zero;
+    }
+
+    fmt_emit(out, fmt_sign_prefix(negative, flags), p, (int)(end - p), 0, width, flags);
+}
+
+static void fmt_string(fmt_out_t *out, const char *s, int width, int precision, uint8_t flags)
+{
+    if (s == NULL)
+    {
+        s = "(null)";
+    }
+
+    int len = 0;
+    while (s[len] != '\0' && (precision < 0 || len < precision))
+    {
+        len++;
+    }
+    fmt_emit(out, "", s, len, 0, width, flags & FMT_FLAG_LEFT);
+}
+
+// =============================================================================
+// Public API
+// =============================================================================
+
+int fmt_vformat(fmt_sink_t sink, void *ctx, const char *format, va_list args)
+{
+    fmt_out_t out = { sink, ctx, 0 };
+
+    while (*format != '\0')
+    {
+        if (*format != '%')
+        {
+            fmt_put(&out, *format++);
+            continue;
+        }
+        format++;
+
+        // Flags
+        uint8_t flags = 0;
+        for (;;)
+        {
+            if (*format == '-')      flags |= FMT_FLAG_LEFT;
+            else if (*format == '0') flags |= FMT_FLAG_ZERO;
+            else if (*format == '+') flags |= FMT_FLAG_PLUS;
+            else if (*format == ' ') flags |= FMT_FLAG_SPACE;
+            else break;
+            format++;
+        }
+
+        // Width
+        int width = 0;
+        if (*format == '*')
+        {
+            width = va_arg(args, int);
+            if (width < 0)
+            {
+                flags |= FMT_FLAG_LEFT;
+                width = -width;
+            }
+            format++;
+        }
+        while (*format >= '0' && *format <= '9')
+        {
+            width = width * 10 + (*format++ - '0');
+        }
+
+        // Precision
+        int precision = -1;
+        if (*format == '.')
+        {
+            format++;
+            precision = 0;
+            if (*format == '*')
+            {
+                precision = va_arg(args, int);
+                format++;
+            }
+            while (*format >= '0' && *format <= '9')
+            {
+                precision = precision * 10 + (*format++ - '0');
+            }
+        }
+
+        // Length
+        int longs = 0;
+        bool size_arg = false;
+        while (*format == 'l' || *format == 'h' || *format == 'z')
+        {
+            if (*format == 'l') longs++;
+            if (*format == 'z') size_arg = true;
+            format++;
+        }
+
+        char conv = *format;
+        if (conv == '\0')
+        {
+            break;
+        }
+        format++;
+
+        switch (conv)
+        {
+            case 'd':
+            case 'i':
+            {
+                int64_t v;
+                if (longs >= 2)      v = va_arg(args, long long);
+                else if (longs == 1) v = va_arg(args, long);
+                else                 v = va_arg(args, int);
+                uint64_t mag = (v < 0) ? (uint64_t)0 - (uint64_t)v : (uint64_t)v;
+                fmt_integer(&out, mag, v < 0, 10, false, NULL, width, precision, flags);
+                break;
+            }
+            case 'u':
+            case 'x':
+            case 'X':
+            {
+                uint64_t v;
+                if (longs >= 2)      v = va_arg(args, unsigned long long);
+                else if (longs == 1) v = va_arg(args, unsigned long);
+                else if (size_arg)   v = va_arg(args, size_t);
+                else                 v = va_arg(args, unsigned int);
+                unsigned base = (conv == 'u') ? 10 : 16;
+                fmt_integer(&out, v, false, base, conv == 'X', "", width, precision,
+                            flags & (FMT_FLAG_LEFT | FMT_FLAG_ZERO));
+                break;
+            }
+            case 'p':
+            {
+                uintptr_t v = (uintptr_t)va_arg(args, void *);
+                fmt_integer(&out, v, false, 16, false, "0x", width, -1, flags & FMT_FLAG_LEFT);
+                break;
+            }
+            case 'f':
+            case 'F':
+                fmt_float(&out, (float)va_arg(args, double), width, precision, flags);
+                break;
+            case 'c':
+            {
+                char c = (char)va_arg(args, int);
+                fmt_emit(&out, "", &c, 1, 0, width, flags & FMT_FLAG_LEFT);
+                break;
+            }
+            case 's':
+                fmt_string(&out, va_arg(args, const char *), width, precision, flags);
+                break;
+            case '%':
+                fmt_put(&out, '%');
+                break;
+            default:
+                // Unknown conversion: echo it so the mistake is visible
+                fmt_put(&out, '%');
+                fmt_put(&out, conv);
+                break;
+        }
+    }
+
+    return out.count;
+}
+
+static void fmt_buffer_sink(char c, void *ctx)
+{
+    fmt_buffer_t *b = (fmt_buffer_t *)ctx;
+    if (b->pos + 1 < b->size)
+    {
+        b->buf[b->pos] = c;
+    }
+    b->pos++;
+}
+
+int fmt_vsnprintf(char *buf, size_t size, const char *format, va_list args)
+{
+    fmt_buffer_t b = { buf, size, 0 };
+    int len = fmt_vformat(fmt_buffer_sink, &b, format, args);
+
+    if (size > 0)
+    {
+        buf[(b.pos < size) ? b.pos : size - 1] = '\0';
+    }
+    return len;
+}
+
+int fmt_snprintf(char *buf, size_t size, const char *format, ...)
+{
+    va_list args;
+    va_start(args, format);
+    int len = fmt_vsnprintf(buf, size, format, args);
+    va_end(args);
+    return len;
+}
+
+float fmt_strtof(const char *s, const char **end)
+{
+    const char *p = s;
+    bool negative = false;
+    bool any_digits = false;
+    float value = 0.0f;
+
+    while (*p == ' ' || *p == '\t')
+    {
+        p++;
+    }
+    if (*p == '+' || *p == '-')
+    {
+        negative = (*p == '-');
+        p++;
+    }
+
+    while (*p >= '0' && *p <= '9')
+    {
+        value = value * 10.0f + (float)(*p++ - '0');
+        any_digits = true;
+    }
+    if (*p == '.')
+    {
+        p++;
+        float weight = 0.1f;
+        while (*p >= '0' && *p <= '9')
+        {
+            value += weight * (float)(*p++ - '0');
+            weight *= 0.1f;
+            any_digits = true;
+        }
+    }
+
+    if (!any_digits)
+    {
+        if (end != NULL)
+        {
+            *end = s;
+        }
+        return 0.0f;
+    }
+
+    if (*p == 'e' || *p == 'E')
+    {
+        const char *q = p + 1;
+        bool exp_negative = false;
+        int exponent = 0;
+
+        if (*q == '+' || *q == '-')
+        {
+            exp_negative = (*q == '-');
+            q++;
+        }
+        if (*q >= '0' && *q <= '9')
+        {
+            while (*q >= '0' && *q <= '9')
+            {
+                exponent = exponent * 10 + (*q++ - '0');
+            }
+            while (exponent-- > 0)
+            {
+                value = exp_negative ? value / 10.0f : value * 10.0f;
+            }
+            p = q;
+        }
+    }
+
+    if (end != NULL)
+    {
+        *end = p;
+    }
+    return negative ? -value : value;
+}
@@ -0,0 +1,155 @@
+/*
+ * fsync.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: halvard
+ *
+ *  Description: FSYNC external sync, sample tagging and edge timestamps
+ */
+
+#include "fsync.h"
+#include "driver_mpu6050_basic.h"
+#include "imu_replay.h"
+#include "imu_sample.h"
+#include "main.h"
+#include "mem_sections.h"
+#include "pipeline.h"
+
+#include <string.h>
+
+fsync_config_t fsync_config = {
+    .log = false,
+};
+
+static struct {
+    volatile uint32_t edge[FSYNC_EDGES];    // DWT->CYCCNT, written by the EXTI interrupt
+    volatile uint32_t edge_head;
+    uint32_t edge_tail;
+
+    fsync_event_t event[FSYNC_EVENTS];
+    volatile uint32_t event_head;           // events since boot
+
+    fsync_summary_t summary;
+} fs;
+
+int fsync_enable(void)
+{
+    if (mpu6050_set_extern_sync(mpu6050_basic_handle(), MPU6050_EXTERN_SYNC_TEMP_OUT_L) != 0)
+    {
+        return 1;
+    }
+
+    // Event numbers carry on, so readers stay valid across a re-enable
+    fs.edge_tail = fs.edge_head;
+    memset(&fs.summary, 0, sizeof(fs.summary));
+    fs.summary.enabled = true;
+    return 0;
+}
+
+void fsync_disable(void)
+{
+    fs.summary.enabled = false;
+    mpu6050_set_extern_sync(mpu6050_basic_handle(), MPU6050_EXTERN_SYNC_INPUT_DISABLED);
+}
+
+MEM_RAMFUNC(RAMFUNC_ISR, fsync_edge)
+void fsync_edge(uint32_t cycles)
+{
+    if (!fs.summary.enabled)
+    {
+        return;
+    }
+    fs.summary.edges++;
+    if (fs.edge_head - fs.edge_tail >= FSYNC_EDGES)
+    {
+        fs.summary.missed++;
+        return;
+    }
+    fs.edge[fs.edge_head % FSYNC_EDGES] = cycles;
+    fs.edge_head++;
+}
+
+int fsync_process(const imu_t *imu)
+{
+    (void)imu;
+    fsync_summary_t *s = &fs.summary;
+    if (!s->enabled || imu_replay_active())
+    {
+        return 0;
+    }
+
+    imu_raw_t raw;
+    imu_range_t range;
+    imu_sample_stats_t stats;
+    imu_last_raw(&raw, &range);
+    imu_sample_get_stats(&stats);
+    const uint32_t read = imu_sample_cycles();
+    const uint32_t window = 2u * (SystemCoreClock / pipeline_rate_hz());
+
+    // Edges before the read: the oldest one belongs to this sample if it
+    // is tagged; edges during or after the read wait for the next sample
+    while (fs.edge_tail != fs.edge_head)
+    {
+        const uint32_t age = read - fs.edge[fs.edge_tail % FSYNC_EDGES];
+        if ((int32_t)age < 0 || age <= window)
+        {
+            break;
+        }
+        fs.edge_tail++;
+        s->missed++;
+    }
+    if ((raw.temp & 1) == 0)
+    {
+        return 0;
+    }
+
+    fsync_event_t ev = { .sample = stats.published, .edge = 0, .read = read };
+    if (fs.edge_tail != fs.edge_head && (int32_t)(read - fs.edge[fs.edge_tail % FSYNC_EDGES]) >= 0)
+    {
+        ev.edge = fs.edge[fs.edge_tail % FSYNC_EDGES];
+        fs.edge_tail++;
+
+        const float us = (float)(read - ev.edge) * (1e6f / (float)SystemCoreClock);
+        s->offset_min_us = (s->events == s->orphans || us < s->offset_min_us) ? us : s->offset_min_us;
+        s->offset_max_us = (s->events == s->orphans || us > s->offset_max_us) ? us : s->offset_max_us;
+        s->offset_us = us;
+    }
+    else
+    {
+        s->orphans++;
+    }
+    s->events++;
+
+    fs.event[fs.event_head % FSYNC_EVENTS] = ev;
+    fs.event_head++;
+    return 1;
+}
+
+void fsync_reader_init(fsync_reader_t *reader)
+{
+    reader->next = fs.event_head;
+    reader->lost = 0;
+}
+
+int fsync_read(fsync_reader_t *reader, fsync_event_t *event)
+{
+    // Events are written by fsync_process() in the main loop, like the readers
+    const uint32_t head = fs.event_head;
+    if (head - reader->next > FSYNC_EVENTS)
+    {
+        reader->lost += head - reader->next - FSYNC_EVENTS;
+        reader->next = head - FSYNC_EVENTS;
+    }
+    if (reader->next == head)
+    {
+        return 1;
+    }
+    *event = fs.event[reader->next % FSYNC_EVENTS];
+    reader->next++;
+    return 0;
+}
+
+void fsync_get_summary(fsync_summary_t *summary)
+{
+    *summary = fs.summary;
+}
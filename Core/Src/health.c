@@ -0,0 +1,260 @@
+/*
+ * health.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: halvard
+ *
+ *  Description: streaming sensor-health checks on every IMU sample
+ */
+
+#include "health.h"
+#include "fmt.h"
+#include "main.h"
+#include "mem_sections.h"
+
+#include <math.h>
+#include <string.h>
+
+#define HEALTH_ALPHA            (1.0f / 32.0f)  // noise floor average
+#define HEALTH_RAIL_LO          (-32768)
+#define HEALTH_RAIL_HI          32767
+
+health_config_t health_config = {
+    .stuck = 50,
+    .noise = 4.0f,
+    .rate = 0.5f,
+    .learn = 200,
+    .log = false,
+};
+
+typedef struct {
+    int16_t count;              // previous raw count
+    uint32_t same;              // samples in a row with that count
+    float last;                 // previous converted value
+    float power;                // mean square change, learning sum first
+} health_track_t;
+
+static struct {
+    health_config_t active;
+    bool enabled;
+    float lo, hi;               // noise band as power ratios
+    health_track_t track[IMU_CHANNELS];
+    bool timed;                 // last_cycles is the previous sample's read
+    uint32_t last_cycles;
+    uint32_t intervals;         // learned from so far
+    uint64_t interval_sum;
+    uint32_t interval;          // learned, cycles
+    uint32_t band;              // allowed deviation, cycles
+    health_summary_t summary;
+} hl = {
+    .enabled = true,            // checks nothing until the first health_reset()
+};
+
+// Sensor axis of each NED channel (imu_to_ned() swaps x and y)
+static const uint8_t health_sensor_axis[3] = {1, 0, 2};
+
+int health_reset(void)
+{
+    const health_config_t *cfg = &health_config;
+    if (cfg->stuck < 0 || cfg->noise < 0.0f || (cfg->noise > 0.0f && cfg->noise <= 1.0f)
+        || cfg->rate < 0.0f || cfg->rate >= 1.0f || cfg->learn < 2)
+    {
+        return 1;
+    }
+
+    const bool enabled = hl.enabled;
+    memset(&hl, 0, sizeof(hl));
+    hl.active = *cfg;
+    hl.enabled = enabled;
+    hl.hi = cfg->noise * cfg->noise;
+    hl.lo = (hl.hi > 0.0f) ? 1.0f / hl.hi : 0.0f;
+    return 0;
+}
+
+void health_enable(bool enable)
+{
+    hl.enabled = enable;
+}
+
+bool health_enabled(void)
+{
+    return hl.enabled;
+}
+
+/**
+ * @brief Stuck and noise checks of one channel.
+ * @param count Raw count, for the stuck check: a range or calibration
+ *              change moves the converted value but not the register
+ * @param value Converted value, for the noise floor in physical units
+ * @return IMU_HEALTH_* flags of the channel
+ */
+MEM_RAMFUNC(RAMFUNC_DECODE, health_channel)
+static uint8_t health_channel(int ch, int16_t count, float value, bool learning)
+{
+    health_track_t *t = &hl.track[ch];
+    health_channel_t *c = &hl.summary.channel[ch];
+    const uint8_t bit = (uint8_t)(1u << ch);
+    uint8_t flags = 0;
+
+    const float d = value - t->last;
+    t->same = (count == t->count && hl.summary.samples > 0) ? t->same + 1 : 0;
+    t->count = count;
+    t->last = value;
+
+    if (hl.active.stuck > 0 && t->same >= (uint32_t)hl.active.stuck)
+    {
+        flags |= IMU_HEALTH_STUCK;
+        c->stuck += ((hl.summary.stuck_mask & bit) == 0);
+        hl.summary.stuck_mask |= bit;
+    }
+    else
+    {
+        hl.summary.stuck_mask &= (uint8_t)~bit;
+    }
+
+    // The first sample has no change to measure
+    if (hl.summary.samples == 0)
+    {
+        return flags;
+    }
+    if (learning)
+    {
+        t->power += d * d;
+        if (hl.summary.samples == (uint32_t)hl.active.learn - 1)
+        {
+            t->power /= (float)(hl.active.learn - 1);
+            c->baseline = sqrtf(t->power);
+        }
+        return flags;
+    }
+
+    t->power += (d * d - t->power) * HEALTH_ALPHA;
+    c->floor = sqrtf(t->power);
+
+    // A channel quiet all through learning has no floor to compare with
+    const float base = c->baseline * c->baseline;
+    if (hl.hi > 0.0f && base > 0.0f && (t->power > base * hl.hi || t->power < base * hl.lo))
+    {
+        flags |= IMU_HEALTH_NOISE;
+        c->noisy += ((hl.summary.noise_mask & bit) == 0);
+        hl.summary.noise_mask |= bit;
+    }
+    else
+    {
+        hl.summary.noise_mask &= (uint8_t)~bit;
+    }
+    return flags;
+}
+
+/**
+ * @brief Learns the read interval over the first timed samples, then
+ * checks each one against it.
+ */
+MEM_RAMFUNC(RAMFUNC_DECODE, health_rate)
+static uint8_t health_rate(uint32_t cycles)
+{
+    uint8_t flags = 0;
+
+    if (hl.timed)
+    {
+        const uint32_t interval = cycles - hl.last_cycles;
+        // learn samples have learn - 1 intervals, like the noise floors
+        if (hl.intervals < (uint32_t)hl.active.learn - 1)
+        {
+            hl.interval_sum += interval;
+            if (++hl.intervals == (uint32_t)hl.active.learn - 1)
+            {
+                hl.interval = (uint32_t)(hl.interval_sum / hl.intervals);
+                hl.band = (uint32_t)((float)hl.interval * hl.active.rate);
+                hl.summary.interval_us = (uint32_t)((uint64_t)hl.interval * 1000000u / SystemCoreClock);
+            }
+            flags |= IMU_HEALTH_LEARNING;
+        }
+        else if (hl.band > 0 && interval > hl.interval + hl.band)
+        {
+            hl.summary.late++;
+            flags |= IMU_HEALTH_RATE;
+        }
+        else if (hl.band > 0 && interval < hl.interval - hl.band)
+        {
+            hl.summary.early++;
+            flags |= IMU_HEALTH_RATE;
+        }
+    }
+    else if (hl.intervals < (uint32_t)hl.active.learn - 1)
+    {
+        flags |= IMU_HEALTH_LEARNING;
+    }
+    hl.timed = true;
+    hl.last_cycles = cycles;
+    return flags;
+}
+
+MEM_RAMFUNC(RAMFUNC_DECODE, health_check)
+void health_check(imu_t *imu, const imu_raw_t *raw, uint32_t cycles, bool timed)
+{
+    if (!hl.enabled)
+    {
+        imu->health = 0;
+        return;
+    }
+
+    const bool learning = hl.summary.samples < (uint32_t)hl.active.learn;
+    uint8_t flags = learning ? IMU_HEALTH_LEARNING : 0;
+
+    for (int i = 0; i < 3; i++)
+    {
+        const int16_t a = raw->acc[health_sensor_axis[i]];
+        const int16_t g = raw->gyr[health_sensor_axis[i]];
+        if (a == HEALTH_RAIL_LO || a == HEALTH_RAIL_HI)
+        {
+            hl.summary.channel[i].saturated++;
+            flags |= IMU_HEALTH_SATURATED;
+        }
+        if (g == HEALTH_RAIL_LO || g == HEALTH_RAIL_HI)
+        {
+            hl.summary.channel[3 + i].saturated++;
+            flags |= IMU_HEALTH_SATURATED;
+        }
+        flags |= health_channel(i, a, imu->acc[i], learning);
+        flags |= health_channel(3 + i, g, imu->gyr[i], learning);
+    }
+
+    if (timed)
+    {
+        flags |= health_rate(cycles);
+    }
+    else
+    {
+        // The next timed sample has no interval to check
+        hl.timed = false;
+    }
+
+    hl.summary.samples++;
+    hl.summary.flags = flags;
+    imu->health = flags;
+}
+
+void health_get_summary(health_summary_t *summary)
+{
+    *summary = hl.summary;
+}
+
+void health_format(uint8_t flags, char *buf, size_t size)
+{
+    static const char *const names[] = {"stuck", "saturated", "noise", "rate", "learning"};
+    size_t len = 0;
+
+    buf[0] = '\0';
+    for (uint32_t i = 0; i < sizeof(names) / sizeof(names[0]) && len < size; i++)
+    {
+        if (flags & (1u << i))
+        {
+            len += (size_t)fmt_snprintf(buf + len, size - len, "%s%s", (len > 0) ? "," : "", names[i]);
+        }
+    }
+    if (len == 0)
+    {
+        fmt_snprintf(buf, size, "ok");
+    }
+}
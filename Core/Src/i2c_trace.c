@@ -0,0 +1,137 @@
+/*
+ * i2c_trace.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: halvard
+ *
+ *  Description: I2C transaction tracer for the MPU6050 bus interface
+ */
+
+#include "i2c_trace.h"
+
+#include <string.h>
+
+#ifdef ENABLE_I2C_TRACE
+
+// Only the bus owner (main loop) transfers, so no locking
+static struct {
+    i2c_trace_record_t ring[I2C_TRACE_RECORDS];
+    uint32_t head;                          // records since the last clear
+    i2c_trace_stat_t stat[I2C_TRACE_REGS];
+    i2c_trace_summary_t summary;
+} i2c_trace;
+
+void i2c_trace_record(uint32_t start, uint8_t flags, uint8_t reg, uint16_t len)
+{
+    const uint32_t cycles = DWT->CYCCNT - start;
+
+    i2c_trace_record_t *r = &i2c_trace.ring[i2c_trace.head % I2C_TRACE_RECORDS];
+    r->start = start;
+    r->cycles = cycles;
+    r->len = len;
+    r->reg = reg;
+    r->flags = flags;
+    i2c_trace.head++;
+
+    i2c_trace_summary_t *s = &i2c_trace.summary;
+    const uint8_t write = flags & I2C_TRACE_WRITE;
+    const uint8_t error = (flags & I2C_TRACE_ERROR) ? 1 : 0;
+    s->count++;
+    s->bytes += len;
+    s->cycles += cycles;
+    s->errors += error;
+
+    i2c_trace_stat_t *st = NULL;
+    for (uint8_t i = 0; i < s->regs; i++)
+    {
+        if (i2c_trace.stat[i].reg == reg && i2c_trace.stat[i].write == write)
+        {
+            st = &i2c_trace.stat[i];
+            break;
+        }
+    }
+    if (st == NULL)
+    {
+        if (s->regs == I2C_TRACE_REGS)
+        {
+            s->untracked++;
+            return;
+        }
+        st = &i2c_trace.stat[s->regs++];
+        memset(st, 0, sizeof(*st));
+        st->reg = reg;
+        st->write = write;
+    }
+    st->count++;
+    st->bytes += len;
+    st->cycles += cycles;
+    st->max = (cycles > st->max) ? cycles : st->max;
+    st->errors += error;
+}
+
+bool i2c_trace_available(void)
+{
+    return true;
+}
+
+void i2c_trace_clear(void)
+{
+    memset(&i2c_trace, 0, sizeof(i2c_trace));
+}
+
+void i2c_trace_get_summary(i2c_trace_summary_t *summary)
+{
+    *summary = i2c_trace.summary;
+}
+
+int i2c_trace_get_stat(uint8_t index, i2c_trace_stat_t *stat)
+{
+    if (index >= i2c_trace.summary.regs)
+    {
+        return 1;
+    }
+    *stat = i2c_trace.stat[index];
+    return 0;
+}
+
+int i2c_trace_get_record(uint32_t age, i2c_trace_record_t *record)
+{
+    if (age >= i2c_trace.head || age >= I2C_TRACE_RECORDS)
+    {
+        return 1;
+    }
+    *record = i2c_trace.ring[(i2c_trace.head - 1 - age) % I2C_TRACE_RECORDS];
+    return 0;
+}
+
+#else
+
+bool i2c_trace_available(void)
+{
+    return false;
+}
+
+void i2c_trace_clear(void)
+{
+}
+
+void i2c_trace_get_summary(i2c_trace_summary_t *summary)
+{
+    memset(summary, 0, sizeof(*summary));
+}
+
+int i2c_trace_get_stat(uint8_t index, i2c_trace_stat_t *stat)
+{
+    (void)index;
+    (void)stat;
+    return 1;
+}
+
+int i2c_trace_get_record(uint32_t age, i2c_trace_record_t *record)
+{
+    (void)age;
+    (void)record;
+    return 1;
+}
+
+#endif
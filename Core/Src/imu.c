@@ -8,32 +8,117 @@
  */
 
 #include "imu.h"
-#include "driver_mpu6050_basic.h"
+#include "health.h"
+#include "imu_replay.h"
+#include "imu_sample.h"
 #include "util.h"
+#include "main.h"
+#include "mem_sections.h"
+
+// The one backend of this build; calls through it compile to direct calls
+static const imu_backend_t backend = IMU_BACKEND_OPS;
+
+static uint32_t imu_sample_start;     // DWT->CYCCNT, see imu_sample_cycles()
+
+// Range codes of the sensor, backend defaults +-2 g, +-2000 dps
+static uint8_t imu_accel_range = 0;
+static uint8_t imu_gyro_range = 3;
+
+// Raw counts of the last sample and the range they were read with
+static imu_raw_t imu_raw;
+static imu_range_t imu_raw_range = {.accel = 0, .gyro = 3, .switches = 0};
 
 int imu_init(imu_t *imu)
 {
     zeromem(imu, sizeof(imu_t));
 
-    if(mpu6050_basic_init(MPU6050_ADDRESS_AD0_LOW) != 0)
+    if(backend.init() != 0)
     {
-        print("MPU6050 init failed!\r\n");
+        print("%s init failed!\r\n", backend.name);
         return 1;
     }
-    print("MPU6050 ok\r\n");
+    print("%s ok\r\n", backend.name);
+    health_reset();
     return 0;
 }
-int imu_process(imu_t *imu)
+
+/**
+ * @brief Range code (0..3) of a full scale that is base << code.
+ */
+static uint8_t imu_range_code(uint32_t full_scale, uint32_t base)
 {
-    float* acc = imu->acc;
-    float* gyr = imu->gyr;
-    if(mpu6050_basic_read(acc, gyr) != 0)
+    uint8_t code = 0;
+    while(code < 3 && (base << code) < full_scale)
+    {
+        code++;
+    }
+    return code;
+}
+
+int imu_configure(const imu_backend_config_t *cfg)
+{
+    if(backend.configure(cfg) != 0)
     {
-        print("MPU6050 read failed!\r\n");
         return 1;
     }
+    imu_accel_range = imu_range_code(cfg->accel_range_g, 2);
+    imu_gyro_range = imu_range_code(cfg->gyro_range_dps, 250);
+    health_reset();
+    return 0;
+}
 
-    // convert to mps2 and map to NED frame
+int imu_set_range(uint8_t accel, uint8_t gyro)
+{
+    // A recording keeps the ranges it was made with
+    if(accel > 3 || gyro > 3 || imu_replay_active())
+    {
+        return 1;
+    }
+    if(accel == imu_accel_range && gyro == imu_gyro_range)
+    {
+        return 0;
+    }
+    if(backend.set_range(accel, gyro) != 0)
+    {
+        return 1;
+    }
+    imu_accel_range = accel;
+    imu_gyro_range = gyro;
+    return 0;
+}
+
+void imu_get_range(uint8_t *accel, uint8_t *gyro)
+{
+    *accel = imu_accel_range;
+    *gyro = imu_gyro_range;
+}
+
+/**
+ * @brief Tags the sample just read with its range.
+ */
+static void imu_tag_range(uint8_t accel, uint8_t gyro)
+{
+    if(accel != imu_raw_range.accel || gyro != imu_raw_range.gyro)
+    {
+        imu_raw_range.accel = accel;
+        imu_raw_range.gyro = gyro;
+        imu_raw_range.switches++;
+    }
+}
+
+const char *imu_backend_name(void)
+{
+    return backend.name;
+}
+
+/**
+ * @brief Sensor axes [g], [dps] to the NED body frame in [m/s^2], [dps].
+ */
+MEM_RAMFUNC(RAMFUNC_DECODE, imu_to_ned)
+static void imu_to_ned(imu_t *imu)
+{
+    float* acc = imu->acc;
+    float* gyr = imu->gyr;
     float accel[3] = {acc[0], acc[1], acc[2]};
     float gyro[3] = {gyr[0], gyr[1], gyr[2]};
 
@@ -43,10 +128,102 @@ int imu_process(imu_t *imu)
     gyr[0] = gyro[1];
     gyr[1] = gyro[0];
     gyr[2] = gyro[2];
+}
+
+MEM_RAMFUNC(RAMFUNC_DECODE, imu_process)
+int imu_process(imu_t *imu)
+{
+    imu_sample_start = DWT->CYCCNT;
+
+    float* acc = imu->acc;
+    float* gyr = imu->gyr;
+    if(imu_replay_active())
+    {
+        // Recorded frames stand in for the sensor (see imu_replay.h)
+        if(imu_replay_read(acc, gyr) != 0)
+        {
+            return 1;
+        }
+        uint8_t accel, gyro;
+        imu_replay_last_frame(&imu_raw, &accel, &gyro);
+        imu_tag_range(accel, gyro);
+    }
+    else
+    {
+        if(backend.read(&imu_raw) != 0)
+        {
+            print("%s read failed!\r\n", backend.name);
+            return 1;
+        }
+        backend.decode(&imu_raw, acc, gyr);
+        imu_tag_range(imu_accel_range, imu_gyro_range);
+    }
+
+    // convert to mps2 and map to NED frame
+    imu_to_ned(imu);
+
+    // Flags go out with the sample; a recording's read times are the replay's
+    health_check(imu, &imu_raw, imu_sample_start, !imu_replay_active());
+
+    // Latest sample for readers outside the main loop (imu_sample.h)
+    imu_sample_publish(imu, &imu_raw_range, imu_sample_start);
+    return 0;
+}
+
+MEM_RAMFUNC(RAMFUNC_DECODE, imu_decode)
+void imu_decode(const imu_raw_t *raw, imu_t *imu)
+{
+    backend.decode(raw, imu->acc, imu->gyr);
+    imu_to_ned(imu);
+}
+
+int imu_drain(imu_t *imu, uint16_t max, uint16_t *count)
+{
+    imu_raw_t raw[IMU_DRAIN_CHUNK];
+    uint16_t n = 0;
+
+    *count = 0;
+    do
+    {
+        uint16_t want = max - *count;
+        want = (want < IMU_DRAIN_CHUNK) ? want : IMU_DRAIN_CHUNK;
+        if(backend.drain(raw, want, &n) != 0)
+        {
+            return 1;
+        }
+        for(uint16_t i = 0; i < n; i++)
+        {
+            imu_t *out = &imu[(*count)++];
+            imu_decode(&raw[i], out);
+            health_check(out, &raw[i], 0, false);
+        }
+    } while(n == IMU_DRAIN_CHUNK && *count < max);
     return 0;
 }
 
+float imu_channel(const imu_t *imu, int channel)
+{
+    return (channel < 3) ? imu->acc[channel] : imu->gyr[channel - 3];
+}
+
+uint32_t imu_sample_cycles(void)
+{
+    return imu_sample_start;
+}
+
+void imu_last_raw(imu_raw_t *raw, imu_range_t *range)
+{
+    *raw = imu_raw;
+    *range = imu_raw_range;
+}
+
+const char *imu_channel_name(int channel)
+{
+    static const char *const names[IMU_CHANNELS] = {"ax", "ay", "az", "gx", "gy", "gz"};
+    return (channel >= 0 && channel < IMU_CHANNELS) ? names[channel] : "?";
+}
+
 void imu_deinit(void)
 {
-    mpu6050_basic_deinit();
+    backend.deinit();
 }
\ No newline at end of file
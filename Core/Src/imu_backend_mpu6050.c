@@ -0,0 +1,271 @@
+/*
+ * imu_backend_mpu6050.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: halvard
+ *
+ *  Description: MPU6050 IMU backend (LibDriver, I2C1)
+ */
+
+#include "imu_backend_mpu6050.h"
+#include "driver_mpu6050_basic.h"
+#include "driver_mpu6050_interface.h"
+#include "fifo_decode.h"
+#include "imu_replay.h"
+#include "mem_sections.h"
+
+#include <string.h>
+
+#define REG_GYRO_CONFIG     0x1B        // FS_SEL in bits 4:3
+#define REG_ACCEL_CONFIG    0x1C        // AFS_SEL in bits 4:3
+#define REG_ACCEL_XOUT_H    0x3B
+#define FS_SEL_MASK         0x18
+#define FIFO_CHUNK_FRAMES   8           // frames per FIFO burst
+
+#define WARM_MAGIC          0x4D50574Du // "MWPM"
+#define WARM_REGS           38          // bytes in warm_spans
+#define WARM_LAYOUT_VERSION 1u      // bump when warm_spans, the image or init() writes change
+
+static const float gyro_lsb[4] = {131.0f, 65.5f, 32.8f, 16.4f};
+
+// Configuration registers init() leaves behind: SMPLRT_DIV..INT_ENABLE
+// and I2C_MST_DELAY_CTRL..PWR_MGMT_2. Read in two bursts that step around
+// INT_STATUS (cleared by a read) and the data registers.
+static const uint8_t warm_spans[2][2] = {{0x19, 0x38}, {0x67, 0x6C}};
+
+// Image of those registers after the last cold init. Not zeroed at startup,
+// so it survives an MCU-only reset; the CRC rejects power-up garbage, and
+// covers WARM_LAYOUT_VERSION so firmware reading a different register set
+// doesn't adopt the image. The registers themselves are compared on the
+// chip, so any build with the same layout can warm-start.
+static struct {
+    uint32_t magic;
+    uint32_t crc;
+    uint8_t regs[WARM_REGS];
+} warm_image MEM_RAM_BUFFER(warm_image);
+
+static struct {
+    bool fifo;
+    bool warm;                          // last init kept the chip's configuration
+    float accel_lsb;                    // counts per g
+    float gyro_lsb;                     // counts per dps
+    uint8_t config[2];                  // GYRO_CONFIG, ACCEL_CONFIG as on the chip
+} mpu;
+
+static int16_t be16(const uint8_t *p)
+{
+    return (int16_t)(((uint16_t)p[0] << 8) | p[1]);
+}
+
+static uint32_t warm_crc(const uint8_t regs[WARM_REGS])
+{
+    const uint32_t version = WARM_LAYOUT_VERSION;
+    return imu_replay_crc32(imu_replay_crc32(0, &version, sizeof(version)), regs, WARM_REGS);
+}
+
+static int warm_read(uint8_t regs[WARM_REGS])
+{
+    uint8_t n = 0;
+    for (int i = 0; i < 2; i++)
+    {
+        const uint8_t len = (uint8_t)(warm_spans[i][1] - warm_spans[i][0] + 1);
+        if (mpu6050_get_reg(mpu6050_basic_handle(), warm_spans[i][0], &regs[n], len) != 0)
+        {
+            return 1;
+        }
+        n += len;
+    }
+    return 0;
+}
+
+/**
+ * @brief After an MCU-only reset the chip usually still runs with what
+ * the last cold init wrote; then attaching is enough.
+ */
+static bool warm_start(void)
+{
+    uint8_t regs[WARM_REGS];
+
+    if (warm_image.magic != WARM_MAGIC
+        || warm_image.crc != warm_crc(warm_image.regs)
+        || mpu6050_basic_attach(MPU6050_ADDRESS_AD0_LOW) != 0)
+    {
+        return false;
+    }
+    if (warm_read(regs) != 0 || memcmp(regs, warm_image.regs, WARM_REGS) != 0)
+    {
+        mpu6050_basic_handle()->inited = 0;
+        return false;
+    }
+    return true;
+}
+
+int imu_backend_mpu6050_init(void)
+{
+    mpu.warm = warm_start();
+    if (mpu.warm)
+    {
+        mpu6050_interface_debug_print("mpu6050: configuration kept, no reset.\n");
+    }
+    else
+    {
+        warm_image.magic = 0;
+        if (mpu6050_basic_init(MPU6050_ADDRESS_AD0_LOW) != 0 || warm_read(warm_image.regs) != 0)
+        {
+            return 1;
+        }
+        warm_image.crc = warm_crc(warm_image.regs);
+        warm_image.magic = WARM_MAGIC;
+    }
+    mpu.fifo = false;
+    mpu.accel_lsb = 16384.0f;           // MPU6050_BASIC_DEFAULT_ACCELEROMETER_RANGE
+    mpu.gyro_lsb = 16.4f;               // MPU6050_BASIC_DEFAULT_GYROSCOPE_RANGE
+    return mpu6050_get_reg(mpu6050_basic_handle(), REG_GYRO_CONFIG, mpu.config, 2) != 0;
+}
+
+int imu_backend_mpu6050_configure(const imu_backend_config_t *cfg)
+{
+    mpu6050_handle_t *h = mpu6050_basic_handle();
+
+    int accel = -1, gyro = -1;
+    for (int i = 0; i < 4; i++)
+    {
+        accel = (cfg->accel_range_g == (2u << i)) ? i : accel;
+        gyro = (cfg->gyro_range_dps == (250u << i)) ? i : gyro;
+    }
+    // 1 kHz internal rate with the DLPF on
+    if (accel < 0 || gyro < 0 || cfg->rate_hz < 4 || cfg->rate_hz > 1000)
+    {
+        return 1;
+    }
+
+    const mpu6050_bool_t fifo = cfg->fifo ? MPU6050_BOOL_TRUE : MPU6050_BOOL_FALSE;
+    if (mpu6050_set_accelerometer_range(h, (mpu6050_accelerometer_range_t)accel) != 0
+        || mpu6050_set_gyroscope_range(h, (mpu6050_gyroscope_range_t)gyro) != 0
+        || mpu6050_set_sample_rate_divider(h, (uint8_t)(1000 / cfg->rate_hz - 1)) != 0
+        || mpu6050_set_fifo(h, MPU6050_BOOL_FALSE) != 0
+        || mpu6050_set_fifo_enable(h, MPU6050_FIFO_TEMP, MPU6050_BOOL_FALSE) != 0
+        || mpu6050_set_fifo_enable(h, MPU6050_FIFO_XG, fifo) != 0
+        || mpu6050_set_fifo_enable(h, MPU6050_FIFO_YG, fifo) != 0
+        || mpu6050_set_fifo_enable(h, MPU6050_FIFO_ZG, fifo) != 0
+        || mpu6050_set_fifo_enable(h, MPU6050_FIFO_ACCEL, fifo) != 0)
+    {
+        return 1;
+    }
+    if (cfg->fifo && (mpu6050_fifo_reset(h) != 0 || mpu6050_set_fifo(h, MPU6050_BOOL_TRUE) != 0))
+    {
+        return 1;
+    }
+
+    mpu.fifo = cfg->fifo;
+    mpu.accel_lsb = (float)(16384 >> accel);
+    mpu.gyro_lsb = gyro_lsb[gyro];
+    return mpu6050_get_reg(h, REG_GYRO_CONFIG, mpu.config, 2) != 0;
+}
+
+int imu_backend_mpu6050_set_range(uint8_t accel, uint8_t gyro)
+{
+    if (mpu.fifo || accel > 3 || gyro > 3)
+    {
+        return 1;
+    }
+
+    // From the cached registers, so a switch is one write of the bytes
+    // that change instead of the driver's read-modify-write per range
+    uint8_t config[2] = {
+        (uint8_t)((mpu.config[0] & ~FS_SEL_MASK) | (gyro << 3)),
+        (uint8_t)((mpu.config[1] & ~FS_SEL_MASK) | (accel << 3)),
+    };
+    const int first = (config[0] == mpu.config[0]) ? 1 : 0;
+    const int last = (config[1] == mpu.config[1]) ? 0 : 1;
+    if (first <= last
+        && mpu6050_set_reg(mpu6050_basic_handle(), (uint8_t)(REG_GYRO_CONFIG + first),
+                           &config[first], (uint16_t)(last - first + 1)) != 0)
+    {
+        return 1;
+    }
+
+    mpu.config[0] = config[0];
+    mpu.config[1] = config[1];
+    mpu.accel_lsb = (float)(16384 >> accel);
+    mpu.gyro_lsb = gyro_lsb[gyro];
+    return 0;
+}
+
+MEM_RAMFUNC(RAMFUNC_DECODE, imu_backend_mpu6050_read)
+int imu_backend_mpu6050_read(imu_raw_t *raw)
+{
+    uint8_t buf[14];
+    if (mpu6050_get_reg(mpu6050_basic_handle(), REG_ACCEL_XOUT_H, buf, sizeof(buf)) != 0)
+    {
+        return 1;
+    }
+    raw->acc[0] = be16(&buf[0]);
+    raw->acc[1] = be16(&buf[2]);
+    raw->acc[2] = be16(&buf[4]);
+    raw->temp = be16(&buf[6]);
+    raw->gyr[0] = be16(&buf[8]);
+    raw->gyr[1] = be16(&buf[10]);
+    raw->gyr[2] = be16(&buf[12]);
+    return 0;
+}
+
+MEM_RAMFUNC(RAMFUNC_DECODE, imu_backend_mpu6050_decode)
+void imu_backend_mpu6050_decode(const imu_raw_t *raw, float acc[3], float gyr[3])
+{
+    // Divided rather than scaled, to match the driver's conversion bit for bit
+    for (int i = 0; i < 3; i++)
+    {
+        acc[i] = (float)raw->acc[i] / mpu.accel_lsb;
+        gyr[i] = (float)raw->gyr[i] / mpu.gyro_lsb;
+    }
+}
+
+int imu_backend_mpu6050_drain(imu_raw_t *raw, uint16_t max, uint16_t *count)
+{
+    mpu6050_handle_t *h = mpu6050_basic_handle();
+    uint8_t buf[FIFO_CHUNK_FRAMES * FIFO_RAW_FRAME_BYTES];
+    uint16_t bytes;
+
+    *count = 0;
+    if (!mpu.fifo || mpu6050_get_fifo_count(h, &bytes) != 0)
+    {
+        return 1;
+    }
+
+    uint16_t frames = bytes / FIFO_RAW_FRAME_BYTES;
+    frames = (frames < max) ? frames : max;
+    while (*count < frames)
+    {
+        uint16_t n = frames - *count;
+        n = (n < FIFO_CHUNK_FRAMES) ? n : FIFO_CHUNK_FRAMES;
+        if (mpu6050_fifo_get(h, buf, n * FIFO_RAW_FRAME_BYTES) != 0)
+        {
+            return 1;
+        }
+        // Straight into the frames, imu_raw_t being all int16_t
+        imu_raw_t *r = &raw[*count];
+        const fifo_out_t out = {
+            .acc = {&r->acc[0], &r->acc[1], &r->acc[2]},
+            .gyr = {&r->gyr[0], &r->gyr[1], &r->gyr[2]},
+            .stride = sizeof(imu_raw_t) / sizeof(int16_t),
+        };
+        fifo_decode_raw(buf, n, &out);
+        for (uint16_t i = 0; i < n; i++)
+        {
+            r[i].temp = 0;
+        }
+        *count += n;
+    }
+    return 0;
+}
+
+bool imu_backend_mpu6050_warm(void)
+{
+    return mpu.warm;
+}
+
+void imu_backend_mpu6050_deinit(void)
+{
+    mpu6050_basic_deinit();
+}
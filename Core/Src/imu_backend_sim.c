@@ -0,0 +1,161 @@
+/*
+ * imu_backend_sim.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: halvard
+ *
+ *  Description: simulated IMU backend, synthetic motion without a bus
+ */
+
+#include "imu_backend_sim.h"
+#include "main.h"
+
+#include <math.h>
+
+#define SIM_PI              3.14159265f
+#define SIM_NOISE_COUNTS    4           // peak, per axis
+#define SIM_TEMP_RAW        (-3920)     // 25 degC: (25 - 36.53) * 340
+
+static struct {
+    imu_backend_config_t cfg;
+    float accel_lsb;                    // counts per g
+    float gyro_lsb;                     // counts per dps
+    uint32_t start;                     // HAL_GetTick() of sample 0
+    uint32_t drained;                   // next sample drain() returns
+    uint32_t noise;                     // LCG state
+    uint32_t shock_start;               // first sample of the shock
+    uint16_t shock_len;
+    float shock_g;
+} sim;
+
+static uint32_t sim_now(void)
+{
+    return (uint32_t)((uint64_t)(HAL_GetTick() - sim.start) * sim.cfg.rate_hz / 1000u);
+}
+
+static int16_t sim_counts(float value, float lsb)
+{
+    sim.noise = sim.noise * 1664525u + 1013904223u;
+    float c = value * lsb + (float)((int32_t)(sim.noise >> 29) - SIM_NOISE_COUNTS);
+    c = (c > 32767.0f) ? 32767.0f : ((c < -32768.0f) ? -32768.0f : c);
+    return (int16_t)lrintf(c);
+}
+
+/**
+ * @brief Sample k in sensor axes: imu_process() maps sensor y/x/z to NED
+ * x/y/z, so a roll about NED x tilts gravity into sensor x and turns
+ * about sensor y.
+ */
+static void sim_sample(uint32_t k, imu_raw_t *raw)
+{
+    const float w = 2.0f * SIM_PI * IMU_SIM_ROLL_HZ;
+    const float phase = w * (float)k / (float)sim.cfg.rate_hz;
+    const float roll = IMU_SIM_ROLL_AMPLITUDE * (SIM_PI / 180.0f) * sinf(phase);
+    const float rate = IMU_SIM_ROLL_AMPLITUDE * w * cosf(phase);   // [dps]
+
+    float shock = 0.0f;
+    if (k - sim.shock_start < sim.shock_len)
+    {
+        shock = sim.shock_g * sinf(SIM_PI * (float)(k - sim.shock_start + 1) / (float)(sim.shock_len + 1));
+    }
+
+    raw->acc[0] = sim_counts(sinf(roll), sim.accel_lsb);
+    raw->acc[1] = sim_counts(0.0f, sim.accel_lsb);
+    raw->acc[2] = sim_counts(cosf(roll) + shock, sim.accel_lsb);
+    raw->gyr[0] = sim_counts(0.0f, sim.gyro_lsb);
+    raw->gyr[1] = sim_counts(rate, sim.gyro_lsb);
+    raw->gyr[2] = sim_counts(0.0f, sim.gyro_lsb);
+    raw->temp = SIM_TEMP_RAW;
+}
+
+int imu_backend_sim_init(void)
+{
+    const imu_backend_config_t defaults = {
+        .rate_hz = 50, .accel_range_g = 2, .gyro_range_dps = 2000, .fifo = false,
+    };
+    sim.noise = 1;
+    return imu_backend_sim_configure(&defaults);
+}
+
+static const float gyro_lsb[4] = {131.0f, 65.5f, 32.8f, 16.4f};
+
+int imu_backend_sim_configure(const imu_backend_config_t *cfg)
+{
+    int accel = -1, gyro = -1;
+    for (int i = 0; i < 4; i++)
+    {
+        accel = (cfg->accel_range_g == (2u << i)) ? i : accel;
+        gyro = (cfg->gyro_range_dps == (250u << i)) ? i : gyro;
+    }
+    if (accel < 0 || gyro < 0 || cfg->rate_hz < 4 || cfg->rate_hz > 1000)
+    {
+        return 1;
+    }
+
+    sim.cfg = *cfg;
+    sim.accel_lsb = (float)(16384 >> accel);
+    sim.gyro_lsb = gyro_lsb[gyro];
+    sim.start = HAL_GetTick();
+    sim.drained = 0;
+    return 0;
+}
+
+int imu_backend_sim_set_range(uint8_t accel, uint8_t gyro)
+{
+    if (sim.cfg.fifo || accel > 3 || gyro > 3)
+    {
+        return 1;
+    }
+    sim.cfg.accel_range_g = (uint8_t)(2u << accel);
+    sim.cfg.gyro_range_dps = (uint16_t)(250u << gyro);
+    sim.accel_lsb = (float)(16384 >> accel);
+    sim.gyro_lsb = gyro_lsb[gyro];
+    return 0;
+}
+
+void imu_backend_sim_shock(float g, uint16_t samples)
+{
+    sim.shock_start = sim_now() + 1;
+    sim.shock_len = samples;
+    sim.shock_g = g;
+}
+
+int imu_backend_sim_read(imu_raw_t *raw)
+{
+    sim_sample(sim_now(), raw);
+    return 0;
+}
+
+void imu_backend_sim_decode(const imu_raw_t *raw, float acc[3], float gyr[3])
+{
+    for (int i = 0; i < 3; i++)
+    {
+        acc[i] = (float)raw->acc[i] / sim.accel_lsb;
+        gyr[i] = (float)raw->gyr[i] / sim.gyro_lsb;
+    }
+}
+
+int imu_backend_sim_drain(imu_raw_t *raw, uint16_t max, uint16_t *count)
+{
+    *count = 0;
+    if (!sim.cfg.fifo)
+    {
+        return 1;
+    }
+
+    // Samples beyond the FIFO's capacity were overwritten before this drain
+    const uint32_t now = sim_now();
+    if (now - sim.drained > IMU_SIM_FIFO_SAMPLES)
+    {
+        sim.drained = now - IMU_SIM_FIFO_SAMPLES;
+    }
+    while (sim.drained < now && *count < max)
+    {
+        sim_sample(sim.drained++, &raw[(*count)++]);
+    }
+    return 0;
+}
+
+void imu_backend_sim_deinit(void)
+{
+}
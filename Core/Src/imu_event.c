@@ -0,0 +1,132 @@
+/*
+ * imu_event.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: halvard
+ *
+ *  Description: timestamped sensor event queue (DMP gestures, pedometer,
+ *  MPU6050 interrupts)
+ */
+
+#include "imu_event.h"
+#include "driver_mpu6050_basic.h"
+#include "fmt.h"
+#include "main.h"
+#include "mem_sections.h"
+
+imu_event_config_t imu_event_config = {
+    .step_ms = 1000,
+    .log = false,
+};
+
+// Written below head before it is read, so no need to zero it
+static imu_event_t imu_event_ring[IMU_EVENT_QUEUE] MEM_RAM_BUFFER(imu_event_ring);
+
+static struct {
+    volatile uint32_t head;     // events queued since boot
+    uint32_t step_tick;         // HAL_GetTick() of the last pedometer read
+    uint32_t steps;             // last pedometer count queued
+    bool steps_valid;
+} q;
+
+void imu_event_push(imu_event_type_t type, uint8_t code, uint32_t value)
+{
+    const uint32_t tick = HAL_GetTick();
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    const uint32_t pos = q.head;
+    imu_event_t *ev = &imu_event_ring[pos % IMU_EVENT_QUEUE];
+    ev->tick = tick;
+    ev->value = value;
+    ev->seq = (uint16_t)pos;
+    ev->type = (uint8_t)type;
+    ev->code = code;
+    q.head = pos + 1;
+    __set_PRIMASK(primask);
+}
+
+void imu_event_reader_init(imu_event_reader_t *reader)
+{
+    reader->next = q.head;
+    reader->lost = 0;
+}
+
+int imu_event_read(imu_event_reader_t *reader, imu_event_t *event)
+{
+    int res = 1;
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    const uint32_t head = q.head;
+    if (head - reader->next > IMU_EVENT_QUEUE)
+    {
+        reader->lost += head - reader->next - IMU_EVENT_QUEUE;
+        reader->next = head - IMU_EVENT_QUEUE;
+    }
+    if (reader->next != head)
+    {
+        *event = imu_event_ring[reader->next % IMU_EVENT_QUEUE];
+        reader->next++;
+        res = 0;
+    }
+    __set_PRIMASK(primask);
+    return res;
+}
+
+void imu_event_poll_steps(void)
+{
+    mpu6050_handle_t *h = mpu6050_basic_handle();
+    const uint32_t now = HAL_GetTick();
+    if (imu_event_config.step_ms <= 0 || h->dmp_inited != 1
+        || now - q.step_tick < (uint32_t)imu_event_config.step_ms)
+    {
+        return;
+    }
+    q.step_tick = now;
+
+    uint32_t steps;
+    if (mpu6050_dmp_get_pedometer_step_count(h, &steps) != 0)
+    {
+        return;
+    }
+    if (!q.steps_valid || steps != q.steps)
+    {
+        q.steps = steps;
+        q.steps_valid = true;
+        imu_event_push(IMU_EVENT_STEPS, 0, steps);
+    }
+}
+
+uint32_t imu_event_count(void)
+{
+    return q.head;
+}
+
+void imu_event_format(const imu_event_t *event, char *buf, size_t size)
+{
+    static const char *const taps[] = {"?", "x up", "x down", "y up", "y down", "z up", "z down"};
+    static const char *const orients[] = {"portrait", "landscape", "reverse portrait", "reverse landscape"};
+    const unsigned long tick = (unsigned long)event->tick;
+
+    switch (event->type)
+    {
+        case IMU_EVENT_TAP:
+            fmt_snprintf(buf, size, "%lu ms tap %s x%lu", tick,
+                         taps[(event->code < 7) ? event->code : 0], (unsigned long)event->value);
+            break;
+        case IMU_EVENT_ORIENT:
+            fmt_snprintf(buf, size, "%lu ms orient %s", tick, (event->code < 4) ? orients[event->code] : "?");
+            break;
+        case IMU_EVENT_STEPS:
+            fmt_snprintf(buf, size, "%lu ms steps %lu", tick, (unsigned long)event->value);
+            break;
+        case IMU_EVENT_MOTION:
+            fmt_snprintf(buf, size, "%lu ms motion", tick);
+            break;
+        case IMU_EVENT_FIFO_OVERFLOW:
+            fmt_snprintf(buf, size, "%lu ms fifo overflow", tick);
+            break;
+        default:
+            fmt_snprintf(buf, size, "%lu ms event %u", tick, (unsigned)event->type);
+            break;
+    }
+}
@@ -0,0 +1,227 @@
+/*
+ * imu_replay.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: halvard
+ *
+ *  Description: deterministic replay of recorded MPU6050 register frames
+ */
+
+#include "imu_replay.h"
+#include "timer_module.h"
+
+#include <string.h>
+
+// LSB per g / per dps for each range setting, as in driver_mpu6050.c
+static const float replay_accel_lsb[4] = {16384.0f, 8192.0f, 4096.0f, 2048.0f};
+static const float replay_gyro_lsb[4] = {131.0f, 65.5f, 32.8f, 16.4f};
+
+static struct {
+    const uint8_t *frames;
+    uint32_t count;
+    uint32_t next;
+    uint16_t rate_hz;
+    uint8_t accel_range;
+    uint8_t gyro_range;
+    bool active;
+} replay;
+
+static uint16_t replay_le16(const uint8_t *p)
+{
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t replay_le32(const uint8_t *p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static int16_t replay_be16(const uint8_t *p)
+{
+    return (int16_t)((p[0] << 8) | p[1]);
+}
+
+int imu_replay_open(const uint8_t *image, size_t size)
+{
+    imu_replay_close();
+
+    if (image == NULL || size < IMU_REPLAY_HEADER_SIZE)
+    {
+        return 1;
+    }
+    if (memcmp(image, "IMUR", 4) != 0 || image[4] != IMU_REPLAY_VERSION
+        || image[5] > 3 || image[6] > 3 || image[7] != IMU_REPLAY_FRAME_SIZE)
+    {
+        return 1;
+    }
+
+    uint32_t count = replay_le32(&image[12]);
+    if (count > (size - IMU_REPLAY_HEADER_SIZE) / IMU_REPLAY_FRAME_SIZE)
+    {
+        return 1;
+    }
+
+    replay.frames = image + IMU_REPLAY_HEADER_SIZE;
+    replay.count = count;
+    replay.next = 0;
+    replay.rate_hz = replay_le16(&image[8]);
+    replay.accel_range = image[5];
+    replay.gyro_range = image[6];
+    replay.active = true;
+
+    return 0;
+}
+
+void imu_replay_close(void)
+{
+    memset(&replay, 0, sizeof(replay));
+}
+
+bool imu_replay_active(void)
+{
+    return replay.active;
+}
+
+uint32_t imu_replay_remaining(void)
+{
+    return replay.count - replay.next;
+}
+
+uint16_t imu_replay_rate_hz(void)
+{
+    return replay.rate_hz;
+}
+
+int imu_replay_read(float accel_g[3], float gyro_dps[3])
+{
+    if (!replay.active || replay.next >= replay.count)
+    {
+        return 1;
+    }
+
+    const uint8_t *f = &replay.frames[replay.next * IMU_REPLAY_FRAME_SIZE];
+    replay.next++;
+
+    // ACCEL_XOUT_H..ACCEL_ZOUT_L, TEMP_OUT_H/L, GYRO_XOUT_H..GYRO_ZOUT_L
+    for (int i = 0; i < 3; i++)
+    {
+        accel_g[i] = (float)replay_be16(&f[2 * i]) / replay_accel_lsb[replay.accel_range];
+        gyro_dps[i] = (float)replay_be16(&f[8 + 2 * i]) / replay_gyro_lsb[replay.gyro_range];
+    }
+
+    return 0;
+}
+
+int imu_replay_last_frame(imu_raw_t *raw, uint8_t *accel_range, uint8_t *gyro_range)
+{
+    if (!replay.active || replay.next == 0)
+    {
+        return 1;
+    }
+
+    const uint8_t *f = &replay.frames[(replay.next - 1) * IMU_REPLAY_FRAME_SIZE];
+    for (int i = 0; i < 3; i++)
+    {
+        raw->acc[i] = replay_be16(&f[2 * i]);
+        raw->gyr[i] = replay_be16(&f[8 + 2 * i]);
+    }
+    raw->temp = replay_be16(&f[6]);
+    *accel_range = replay.accel_range;
+    *gyro_range = replay.gyro_range;
+    return 0;
+}
+
+int imu_replay_run(imu_t *imu, imu_replay_pace_t pace, imu_replay_sink_t sink, void *ctx,
+                   imu_replay_stats_t *stats)
+{
+    memset(stats, 0, sizeof(*stats));
+    if (!replay.active)
+    {
+        return 1;
+    }
+
+    uint64_t period_us = (replay.rate_hz != 0) ? 1000000u / replay.rate_hz : 0;
+    uint64_t start = micros();
+    uint64_t due = start;
+
+    while (imu_replay_remaining() > 0)
+    {
+        if (pace == IMU_REPLAY_REALTIME)
+        {
+            while (micros() < due)
+            {
+            }
+            due += period_us;
+        }
+
+        if (imu_process(imu) != 0)
+        {
+            return 1;
+        }
+        // The measurement only: padding and health flags aren't replayed data
+        stats->crc = imu_replay_crc32(stats->crc, imu->acc, sizeof(imu->acc));
+        stats->crc = imu_replay_crc32(stats->crc, imu->gyr, sizeof(imu->gyr));
+        stats->samples++;
+
+        if (sink != NULL)
+        {
+            sink(imu, ctx);
+        }
+    }
+
+    uint64_t elapsed = micros() - start;
+    stats->elapsed_us = (uint32_t)elapsed;
+    stats->samples_per_s = (elapsed > 0) ? (uint32_t)((uint64_t)stats->samples * 1000000u / elapsed) : 0;
+
+    return 0;
+}
+
+#ifdef HOST_BUILD
+static const uint8_t *replay_host_slot;
+static size_t replay_host_slot_size;
+
+void imu_replay_set_flash_slot(const uint8_t *image, size_t size)
+{
+    replay_host_slot = image;
+    replay_host_slot_size = size;
+}
+#endif
+
+int imu_replay_flash_slot(const uint8_t **image, size_t *size)
+{
+#ifdef HOST_BUILD
+    if (replay_host_slot == NULL)
+    {
+        return 1;
+    }
+    *image = replay_host_slot;
+    *size = replay_host_slot_size;
+    return 0;
+#else
+    // Defined in STM32F103RBTX_FLASH.ld
+    extern const uint8_t _replay_start[];
+    extern const uint8_t _replay_size[];
+
+    *image = _replay_start;
+    *size = (size_t)_replay_size;
+    return 0;
+#endif
+}
+
+uint32_t imu_replay_crc32(uint32_t crc, const void *data, size_t len)
+{
+    // Nibble table: 64 bytes of flash instead of 1 KB
+    static const uint32_t table[16] = {
+        0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+        0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C
+    };
+    const uint8_t *p = (const uint8_t *)data;
+
+    crc = ~crc;
+    for (size_t i = 0; i < len; i++)
+    {
+        crc = table[(crc ^ p[i]) & 0x0F] ^ (crc >> 4);
+        crc = table[(crc ^ (p[i] >> 4)) & 0x0F] ^ (crc >> 4);
+    }
+    return ~crc;
+}
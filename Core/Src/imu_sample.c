@@ -0,0 +1,96 @@
+/*
+ * imu_sample.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: halvard
+ *
+ *  Description: tear-free publication of the latest IMU sample
+ */
+
+#include "imu_sample.h"
+#include "main.h"
+
+#include <string.h>
+
+static struct {
+    imu_sample_t slot[2];
+    volatile uint32_t seq;      // samples published, slot[seq & 1] is the latest
+    imu_sample_stats_t stats;
+} pub;
+
+#ifdef HOST_BUILD
+void (*imu_sample_preempt_hook)(int writer);
+
+#define IMU_SAMPLE_PREEMPT(writer)                  \
+    do                                              \
+    {                                               \
+        if (imu_sample_preempt_hook != NULL)        \
+        {                                           \
+            imu_sample_preempt_hook(writer);        \
+        }                                           \
+    } while (0)
+
+void imu_sample_reset(void)
+{
+    memset(&pub, 0, sizeof(pub));
+}
+#else
+#define IMU_SAMPLE_PREEMPT(writer) do { } while (0)
+#endif
+
+/**
+ * @brief Word by word, so on the host the other side can run between any
+ * two words.
+ */
+static void imu_sample_copy(imu_sample_t *dst, const imu_sample_t *src, int writer)
+{
+    uint8_t *d = (uint8_t *)dst;
+    const uint8_t *s = (const uint8_t *)src;
+    for (size_t i = 0; i < sizeof(imu_sample_t); i += sizeof(uint32_t))
+    {
+        memcpy(&d[i], &s[i], sizeof(uint32_t));
+        IMU_SAMPLE_PREEMPT(writer);
+    }
+}
+
+void imu_sample_publish(const imu_t *imu, const imu_range_t *range, uint32_t cycles)
+{
+    const uint32_t seq = pub.seq + 1;
+    imu_sample_t sample = { .imu = *imu, .range = *range, .seq = seq, .cycles = cycles };
+
+    imu_sample_copy(&pub.slot[seq & 1], &sample, 1);
+    __DMB();                    // slot complete before it becomes visible
+    pub.seq = seq;
+    pub.stats.published = seq;
+}
+
+int imu_sample_snapshot(imu_sample_t *out)
+{
+    uint32_t retries = 0;
+    for (;;)
+    {
+        const uint32_t seq = pub.seq;
+        if (seq == 0)
+        {
+            return 1;
+        }
+        __DMB();
+        imu_sample_copy(out, &pub.slot[seq & 1], 0);
+        __DMB();
+        if (pub.seq - seq < 2)
+        {
+            break;
+        }
+        retries++;
+    }
+
+    pub.stats.snapshots++;
+    pub.stats.retries += retries;
+    pub.stats.retries_max = (retries > pub.stats.retries_max) ? retries : pub.stats.retries_max;
+    return 0;
+}
+
+void imu_sample_get_stats(imu_sample_stats_t *stats)
+{
+    *stats = pub.stats;
+}
@@ -27,17 +27,19 @@
 /* USER CODE BEGIN Includes */
 #include "util.h"
 #include "imu.h"
+#include "pipeline.h"
 #include "cli.h"
 #include "cli_impl.h"
+#include "boot.h"
 #include "timer_module.h"
+#include "uart_tx.h"
+#include "mem_sections.h"
 
 #include "stm32f1xx.h"
 #include <stdint.h>
 
-#include <math.h>
 #include <sys/unistd.h>
 #include <errno.h>
-#include <stdio.h>
 
 /* USER CODE END Includes */
 
@@ -60,7 +62,7 @@
 
 /* USER CODE BEGIN PV */
 // DMA buffer for UART RX 
-uint8_t dma_buffer[DMA_BUFFER_SIZE];
+uint8_t dma_buffer[DMA_BUFFER_SIZE] MEM_RAM_BUFFER(dma_buffer);
 volatile uint16_t offset = 0;
 /* USER CODE END PV */
 
@@ -73,6 +75,12 @@ void SystemClock_Config(void);
 /* Private user code ---------------------------------------------------------*/
 /* USER CODE BEGIN 0 */
 
+// Banner and prompt, deferred into the sensor settle time
+static void cli_start(void)
+{
+  cli_user_init(dma_buffer, DMA_BUFFER_SIZE, (volatile uint32_t*)&hdma_usart2_rx.Instance->CNDTR);
+}
+
 /* USER CODE END 0 */
 
 /**
@@ -84,6 +92,9 @@ int main(void)
 
   /* USER CODE BEGIN 1 */
 
+  // DWT from here; phases are marked as they end
+  boot_start();
+
   /* USER CODE END 1 */
 
   /* MCU Configuration--------------------------------------------------------*/
@@ -92,6 +103,7 @@ int main(void)
   HAL_Init();
 
   /* USER CODE BEGIN Init */
+  boot_mark("HAL_Init");
 
   /* USER CODE END Init */
 
@@ -99,6 +111,7 @@ int main(void)
   SystemClock_Config();
 
   /* USER CODE BEGIN SysInit */
+  boot_mark("clock");
 
   /* USER CODE END SysInit */
 
@@ -108,12 +121,23 @@ int main(void)
   MX_USART2_UART_Init();
   MX_I2C1_Init();
   /* USER CODE BEGIN 2 */
+  boot_mark("MX_Init");
 
-  timer_module_init();
+  // Interrupt-driven console output (see uart_tx.c)
+  uart_tx_init(&huart2);
 
   // Start DMA for UART RX
   HAL_UARTEx_ReceiveToIdle_DMA(&huart2, dma_buffer, DMA_BUFFER_SIZE);
   __HAL_DMA_DISABLE_IT(&hdma_usart2_rx, DMA_IT_HT);
+  // RX runs free in circular mode; don't let a line error abort it now that
+  // the USART2 IRQ is enabled for TX
+  __HAL_UART_DISABLE_IT(&huart2, UART_IT_PE);
+  __HAL_UART_DISABLE_IT(&huart2, UART_IT_ERR);
+  boot_mark("console");
+
+  // Initialize CLI (user implementation with all commands and variables)
+  // in the first sensor wait; input is only read from the main loop
+  boot_defer(cli_start);
 
   // Initialize imu
   imu_t imu;
@@ -121,11 +145,12 @@ int main(void)
   {
     return 1;
   }
+  boot_run_deferred();
+  boot_mark("imu_init");
 
-  print("Initialized!\r\n");
-
-  // Initialize CLI (user implementation with all commands and variables)
-  cli_user_init(dma_buffer, DMA_BUFFER_SIZE, (volatile uint32_t*)&hdma_usart2_rx.Instance->CNDTR);
+  char boot_line[128];
+  boot_format(boot_line, sizeof(boot_line));
+  print("Initialized! %s\r\n", boot_line);
 
   /* USER CODE END 2 */
 
@@ -170,16 +195,8 @@ int main(void)
       return 1;
     }
 
-    // If logging is enabled, continuously print IMU data
-    // Press Enter to stop logging and return to CLI
-    if(imu_logging_enabled)
-    {
-      // Send imu data to console as formatted string
-      // Format: <ax> <ay> <az> <gx> <gy> <gz>
-      printf("%f %f %f %f %f %f\r\n", 
-             imu.acc[0], imu.acc[1], imu.acc[2], 
-             imu.gyr[0], imu.gyr[1], imu.gyr[2]);
-    }
+    // Processing stages and console telemetry (imulog, ...)
+    pipeline_process(&imu);
 
     /* USER CODE END WHILE */
 
@@ -243,30 +260,11 @@ void HAL_UARTEx_RxEventCallback(UART_HandleTypeDef *huart, uint16_t Size)
 	}
 }
 
+// stdio is not used by the firmware (see fmt.c); any stray newlib output
+// still goes through the non-blocking TX ring instead of HAL_UART_Transmit.
 int _write(int fd, char* ptr, int len) {
-  HAL_StatusTypeDef hstatus;
-
   if (fd == STDOUT_FILENO || fd == STDERR_FILENO) {
-    hstatus = HAL_UART_Transmit(&huart2, (uint8_t *) ptr, len, HAL_MAX_DELAY);
-    if (hstatus == HAL_OK)
-      return len;
-    else
-      return EIO;
-  }
-  errno = EBADF;
-  return -1;
-}
-
-int _read(int fd, char* ptr, int len) {
-  (void)len;
-  HAL_StatusTypeDef hstatus;
-
-  if (fd == STDIN_FILENO) {
-    hstatus = HAL_UART_Receive(&huart2, (uint8_t *) ptr, 1, HAL_MAX_DELAY);
-    if (hstatus == HAL_OK)
-      return 1;
-    else
-      return EIO;
+    return uart_tx_write((const uint8_t *) ptr, (uint16_t) len);
   }
   errno = EBADF;
   return -1;
@@ -0,0 +1,352 @@
+/*
+ * mfcc.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: halvard
+ *
+ *  Description: MFCC feature vectors of one IMU channel (machine-state fingerprints)
+ */
+
+#include "mfcc.h"
+#include "pipeline.h"
+#include "scratch.h"
+#include "main.h"
+#include "arm_math.h"
+#include "arm_const_structs.h"
+
+#include <math.h>
+#include <string.h>
+
+#ifndef ARM_MFCC_CFFT_BASED
+#error "mfcc.c needs CMSIS-DSP built with ARM_MFCC_CFFT_BASED (see mfcc.h)"
+#endif
+
+mfcc_config_t mfcc_config = {
+    .channel = 2,
+    .n = 128,
+    .mels = 16,
+    .coeffs = 12,
+    .qbits = 15,
+    .log = false,
+};
+
+static struct {
+    bool enabled;
+    mfcc_config_t active;
+    uint16_t rate_hz;           // rate the mel filters were designed for
+    float full_scale;
+    uint32_t elem;              // bytes per sample, 2 (q15) or 4 (q31)
+    uint32_t fill;
+
+    union {
+        arm_mfcc_instance_q15 q15;
+        arm_mfcc_instance_q31 q31;
+    } inst;
+
+    // Scratch arena layout, 4-byte arrays first
+    uint32_t *filter_pos;       // [mels]
+    uint32_t *filter_len;       // [mels]
+    q31_t *tmp;                 // [n] q15, [2n] q31: complex FFT buffer
+    void *hist;                 // [n] input history
+    void *frame;                // [n] kernel input, overwritten
+    void *window;               // [n]
+    void *filter_coefs;         // [n + 2 + mels], see mfcc_design()
+    void *dct;                  // [coeffs * mels]
+    void *out;                  // [coeffs]
+
+    float ref[MFCC_MAX_COEFFS];
+    mfcc_summary_t summary;
+} mf;
+
+static void mfcc_store(void *dst, uint32_t i, float x)
+{
+    if (mf.elem == sizeof(q31_t))
+    {
+        q31_t v = (x >= 0.999999f) ? INT32_MAX : ((x <= -1.0f) ? INT32_MIN : (q31_t)(x * 2147483648.0f));
+        ((q31_t *)dst)[i] = v;
+    }
+    else
+    {
+        q15_t v = (x >= 32767.0f / 32768.0f) ? INT16_MAX : ((x <= -1.0f) ? INT16_MIN : (q15_t)(x * 32768.0f));
+        ((q15_t *)dst)[i] = v;
+    }
+}
+
+static float mfcc_hz_to_mel(float f)
+{
+    return 1127.0f * logf(1.0f + f / 700.0f);
+}
+
+static float mfcc_mel_to_hz(float m)
+{
+    return 700.0f * (expf(m / 1127.0f) - 1.0f);
+}
+
+/**
+ * @brief Window, mel filter bank and DCT matrix for the pipeline rate.
+ *
+ * Triangular filters are spaced evenly on the mel scale between 0 and fs/2,
+ * each peaking at 1.0 on its centre frequency. Only the non-zero weights
+ * are stored (filter_pos/filter_len index into them). Neighbouring filters
+ * overlap by at most one triangle side, so they hold fewer than n/2 + 2
+ * weights between them; a filter narrower than a bin gets the single bin
+ * nearest its centre, which bounds the total by n + 2 + mels.
+ */
+static void mfcc_design(void)
+{
+    const uint32_t n = (uint32_t)mf.active.n;
+    const uint32_t mels = (uint32_t)mf.active.mels;
+    const uint32_t coeffs = (uint32_t)mf.active.coeffs;
+    const float fs = (float)pipeline_rate_hz();
+
+    for (uint32_t k = 0; k < n; k++)
+    {
+        mfcc_store(mf.window, k, 0.5f - 0.5f * cosf(2.0f * PI * (float)k / (float)n));
+    }
+
+    const float mel_max = mfcc_hz_to_mel(0.5f * fs);
+    const uint32_t bins = n / 2 + 1;
+    uint32_t pos = 0;
+    for (uint32_t i = 0; i < mels; i++)
+    {
+        // Triangle corners as fractional bins
+        float b0 = mfcc_mel_to_hz(mel_max * (float)i / (float)(mels + 1)) / fs * (float)n;
+        float b1 = mfcc_mel_to_hz(mel_max * (float)(i + 1) / (float)(mels + 1)) / fs * (float)n;
+        float b2 = mfcc_mel_to_hz(mel_max * (float)(i + 2) / (float)(mels + 1)) / fs * (float)n;
+
+        uint32_t first = (uint32_t)floorf(b0) + 1;
+        uint32_t last = (uint32_t)ceilf(b2) - 1;
+        last = (last >= bins) ? bins - 1 : last;
+        mf.filter_pos[i] = first;
+        mf.filter_len[i] = 0;
+        for (uint32_t k = first; k <= last; k++)
+        {
+            float x = (float)k;
+            float w = (x <= b1) ? (x - b0) / (b1 - b0) : (b2 - x) / (b2 - b1);
+            mfcc_store(mf.filter_coefs, pos + mf.filter_len[i], w);
+            mf.filter_len[i]++;
+        }
+        if (mf.filter_len[i] == 0)
+        {
+            uint32_t k = (uint32_t)(b1 + 0.5f);
+            mf.filter_pos[i] = (k >= bins) ? bins - 1 : k;
+            mf.filter_len[i] = 1;
+            mfcc_store(mf.filter_coefs, pos, 1.0f);
+        }
+        pos += mf.filter_len[i];
+    }
+
+    // Orthonormal DCT-II rows
+    for (uint32_t k = 0; k < coeffs; k++)
+    {
+        float scale = sqrtf(2.0f / (float)mels) * ((k == 0) ? 0.70710678f : 1.0f);
+        for (uint32_t m = 0; m < mels; m++)
+        {
+            mfcc_store(mf.dct, k * mels + m, scale * cosf(PI / (float)mels * ((float)m + 0.5f) * (float)k));
+        }
+    }
+
+    mf.rate_hz = pipeline_rate_hz();
+}
+
+static void mfcc_frame(void)
+{
+    const uint32_t n = (uint32_t)mf.active.n;
+    const uint32_t coeffs = (uint32_t)mf.active.coeffs;
+    float *features = mf.summary.features;
+
+    if (mf.elem == sizeof(q31_t))
+    {
+        q31_t *frame = mf.frame;
+        q31_t mean;
+        arm_mean_q31(mf.hist, n, &mean);
+        arm_offset_q31(mf.hist, -mean, frame, n);
+        arm_mfcc_q31(&mf.inst.q31, frame, mf.out, mf.tmp);
+        for (uint32_t k = 0; k < coeffs; k++)
+        {
+            features[k] = (float)((q31_t *)mf.out)[k] * (1.0f / 8388608.0f);   // q8.23
+        }
+    }
+    else
+    {
+        q15_t *frame = mf.frame;
+        q15_t mean;
+        arm_mean_q15(mf.hist, n, &mean);
+        arm_offset_q15(mf.hist, (q15_t)-mean, frame, n);
+        arm_mfcc_q15(&mf.inst.q15, frame, mf.out, mf.tmp);
+        for (uint32_t k = 0; k < coeffs; k++)
+        {
+            features[k] = (float)((q15_t *)mf.out)[k] * (1.0f / 128.0f);       // q8.7
+        }
+    }
+
+    if (mf.summary.reference)
+    {
+        float sum = 0.0f;
+        for (uint32_t k = 1; k < coeffs; k++)
+        {
+            float d = features[k] - mf.ref[k];
+            sum += d * d;
+        }
+        mf.summary.distance = sqrtf(sum);
+    }
+}
+
+int mfcc_enable(void)
+{
+    mfcc_disable();
+
+    const mfcc_config_t *cfg = &mfcc_config;
+    const arm_cfft_instance_q15 *cfft15;
+    const arm_cfft_instance_q31 *cfft31;
+    switch (cfg->n)
+    {
+        case 64:  cfft15 = &arm_cfft_sR_q15_len64;  cfft31 = &arm_cfft_sR_q31_len64;  break;
+        case 128: cfft15 = &arm_cfft_sR_q15_len128; cfft31 = &arm_cfft_sR_q31_len128; break;
+        case 256: cfft15 = &arm_cfft_sR_q15_len256; cfft31 = &arm_cfft_sR_q31_len256; break;
+        default:  return 1;
+    }
+    if (cfg->channel < 0 || cfg->channel >= IMU_CHANNELS
+        || cfg->mels < 2 || cfg->mels > MFCC_MAX_MELS || cfg->mels > cfg->n / 2
+        || cfg->coeffs < 1 || cfg->coeffs > MFCC_MAX_COEFFS || cfg->coeffs > cfg->mels
+        || (cfg->qbits != 15 && cfg->qbits != 31))
+    {
+        return 1;
+    }
+
+    const uint32_t n = (uint32_t)cfg->n;
+    const uint32_t mels = (uint32_t)cfg->mels;
+    const uint32_t coeffs = (uint32_t)cfg->coeffs;
+    const uint32_t elem = (cfg->qbits == 31) ? sizeof(q31_t) : sizeof(q15_t);
+    const uint32_t tmp_words = (cfg->qbits == 31) ? 2 * n : n;
+    const uint32_t coef_count = n + 2 + mels;
+    size_t bytes = 2 * mels * sizeof(uint32_t) + tmp_words * sizeof(q31_t)
+                   + elem * (3 * n + coef_count + coeffs * mels + coeffs);
+    uint8_t *mem = scratch_acquire(SCRATCH_OWNER_MFCC, bytes);
+    if (mem == NULL)
+    {
+        return 1;
+    }
+
+    memset(&mf, 0, sizeof(mf));
+    mf.active = *cfg;
+    mf.elem = elem;
+    mf.full_scale = (cfg->channel < 3) ? MFCC_ACCEL_FULL_SCALE : MFCC_GYRO_FULL_SCALE;
+    mf.filter_pos = (uint32_t *)mem;
+    mf.filter_len = mf.filter_pos + mels;
+    mf.tmp = (q31_t *)(mf.filter_len + mels);
+    mf.hist = mf.tmp + tmp_words;
+    mf.frame = (uint8_t *)mf.hist + elem * n;
+    mf.window = (uint8_t *)mf.frame + elem * n;
+    mf.filter_coefs = (uint8_t *)mf.window + elem * n;
+    mf.dct = (uint8_t *)mf.filter_coefs + elem * coef_count;
+    mf.out = (uint8_t *)mf.dct + elem * coeffs * mels;
+    mf.summary.ram_bytes = (uint32_t)bytes;
+
+    mfcc_design();
+
+    // Same as arm_mfcc_init_q15/q31, minus arm_cfft_init_*, which would
+    // link the tables of every FFT length
+    if (cfg->qbits == 31)
+    {
+        arm_mfcc_instance_q31 *s = &mf.inst.q31;
+        s->fftLen = n;
+        s->nbMelFilters = mels;
+        s->nbDctOutputs = coeffs;
+        s->dctCoefs = mf.dct;
+        s->filterPos = mf.filter_pos;
+        s->filterLengths = mf.filter_len;
+        s->filterCoefs = mf.filter_coefs;
+        s->windowCoefs = mf.window;
+        s->cfft = *cfft31;
+    }
+    else
+    {
+        arm_mfcc_instance_q15 *s = &mf.inst.q15;
+        s->fftLen = n;
+        s->nbMelFilters = mels;
+        s->nbDctOutputs = coeffs;
+        s->dctCoefs = mf.dct;
+        s->filterPos = mf.filter_pos;
+        s->filterLengths = mf.filter_len;
+        s->filterCoefs = mf.filter_coefs;
+        s->windowCoefs = mf.window;
+        s->cfft = *cfft15;
+    }
+
+    mf.enabled = true;
+    return 0;
+}
+
+void mfcc_disable(void)
+{
+    if (mf.enabled)
+    {
+        mf.enabled = false;
+        scratch_release(SCRATCH_OWNER_MFCC);
+    }
+}
+
+bool mfcc_enabled(void)
+{
+    return mf.enabled;
+}
+
+int mfcc_process(const imu_t *imu)
+{
+    if (!mf.enabled)
+    {
+        return 0;
+    }
+    if (pipeline_rate_hz() != mf.rate_hz)
+    {
+        mfcc_design();
+    }
+
+    mfcc_store(mf.hist, mf.fill, imu_channel(imu, mf.active.channel) / mf.full_scale);
+    mf.fill++;
+
+    const uint32_t n = (uint32_t)mf.active.n;
+    if (mf.fill < n)
+    {
+        return 0;
+    }
+
+    uint32_t start = DWT->CYCCNT;
+    mfcc_frame();
+    uint32_t cycles = DWT->CYCCNT - start;
+
+    mf.summary.frames++;
+    mf.summary.cycles = cycles;
+    mf.summary.cycles_max = (cycles > mf.summary.cycles_max) ? cycles : mf.summary.cycles_max;
+
+    // Slide by half a frame
+    const uint32_t hop = n / 2;
+    memmove(mf.hist, (uint8_t *)mf.hist + mf.elem * hop, mf.elem * (n - hop));
+    mf.fill = n - hop;
+
+    return 1;
+}
+
+void mfcc_get_summary(mfcc_summary_t *summary)
+{
+    *summary = mf.summary;
+}
+
+void mfcc_get_active(mfcc_config_t *config)
+{
+    *config = mf.active;
+}
+
+int mfcc_set_reference(void)
+{
+    if (!mf.enabled || mf.summary.frames == 0)
+    {
+        return 1;
+    }
+
+    memcpy(mf.ref, mf.summary.features, sizeof(mf.ref));
+    mf.summary.reference = true;
+    mf.summary.distance = 0.0f;
+    return 0;
+}
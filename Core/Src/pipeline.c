@@ -0,0 +1,183 @@
+/*
+ * pipeline.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: halvard
+ *
+ *  Description: processing stages run on every IMU sample
+ */
+
+#include "pipeline.h"
+#include "anc.h"
+#include "autorange.h"
+#include "capture.h"
+#include "control.h"
+#include "envelope.h"
+#include "fsync.h"
+#include "health.h"
+#include "imu_event.h"
+#include "main.h"
+#include "mfcc.h"
+#include "timesync.h"
+#include "xcorr.h"
+#include "cli_impl.h"
+#include "util.h"
+
+static uint16_t pipeline_rate = PIPELINE_DEFAULT_RATE_HZ;
+static imu_event_reader_t pipeline_events;     // console telemetry reader
+static fsync_reader_t pipeline_fsync;
+static uint8_t pipeline_health;                // flags of the previous sample
+
+void pipeline_process(imu_t *imu)
+{
+    // Control first: its latency counts from the sample read
+    if (control_process(imu) && control_config.log)
+    {
+        control_config_t cc;
+        control_summary_t cs;
+        control_get_active(&cc);
+        control_get_summary(&cs);
+        print("pid %lu", (unsigned long)cs.steps);
+        for (int i = 0; i < cc.loops; i++)
+        {
+            print(" %.2f %.3f", cs.input[i], cs.output[i]);
+        }
+        print(" %lu cyc\r\n", (unsigned long)cs.latency);
+    }
+
+    // Right after the read, so a switch is written well before the next one
+    if (autorange_process(imu) && autorange_config.log)
+    {
+        autorange_summary_t as;
+        autorange_get_summary(&as);
+        print("range %u g %u dps after sample %lu\r\n", 2u << as.accel.range, 250u << as.gyro.range,
+              (unsigned long)as.accel.samples);
+    }
+
+    // Raw frames, before any stage can modify the sample
+    if (capture_process(imu))
+    {
+        capture_summary_t cs;
+        capture_get_summary(&cs);
+        print("capture %s at sample %lu, peak %.2f g\r\n", capture_trigger_name(cs.trigger),
+              (unsigned long)cs.trigger_sample, cs.peak);
+    }
+
+    // Only reads back the tag, so anywhere after the read will do
+    fsync_process(imu);
+    if (fsync_config.log)
+    {
+        fsync_event_t ev;
+        while (fsync_read(&pipeline_fsync, &ev) == 0)
+        {
+            if (ev.edge != 0)
+            {
+                print("fsync sample %lu, edge %.0f us before read\r\n", (unsigned long)ev.sample,
+                      (float)(ev.read - ev.edge) * (1e6f / (float)SystemCoreClock));
+            }
+            else
+            {
+                print("fsync sample %lu, no edge\r\n", (unsigned long)ev.sample);
+            }
+        }
+    }
+    else
+    {
+        fsync_reader_init(&pipeline_fsync);
+    }
+
+    anc_process(imu);
+
+    if (xcorr_process(imu) && xcorr_config.log)
+    {
+        // Summaries only: the correlated streams never leave the stage
+        xcorr_summary_t xs;
+        xcorr_get_summary(&xs);
+        print("xcorr %lu lag %.2f %.0f us rho %.3f\r\n", (unsigned long)xs.blocks,
+              xs.lag, xs.lag * 1e6f / (float)pipeline_rate, xs.rho);
+    }
+
+    if (envelope_process(imu) && envelope_config.log)
+    {
+        envelope_summary_t es;
+        envelope_get_summary(&es);
+        print("env %lu peaks %.2f Hz %.4f, %.2f Hz %.4f, %.2f Hz %.4f\r\n", (unsigned long)es.spectra,
+              es.peak[0].freq, es.peak[0].amp, es.peak[1].freq, es.peak[1].amp,
+              es.peak[2].freq, es.peak[2].amp);
+    }
+
+    if (mfcc_process(imu) && mfcc_config.log)
+    {
+        mfcc_config_t mc;
+        mfcc_summary_t ms;
+        mfcc_get_active(&mc);
+        mfcc_get_summary(&ms);
+        print("mfcc %lu", (unsigned long)ms.frames);
+        for (int k = 0; k < mc.coeffs; k++)
+        {
+            print(" %.2f", ms.features[k]);
+        }
+        if (ms.reference)
+        {
+            print(" d %.3f", ms.distance);
+        }
+        print("\r\n");
+    }
+
+    // Health flags come with the sample (imu_process()); only changes print
+    if (imu->health != pipeline_health && health_config.log)
+    {
+        char flags[48];
+        health_format(imu->health, flags, sizeof(flags));
+        print("health %s\r\n", flags);
+    }
+    pipeline_health = imu->health;
+
+    // Sensor events queued by the driver callbacks, printed here rather
+    // than from the callbacks
+    imu_event_poll_steps();
+    if (imu_event_config.log)
+    {
+        imu_event_t ev;
+        char line[48];
+        while (imu_event_read(&pipeline_events, &ev) == 0)
+        {
+            imu_event_format(&ev, line, sizeof(line));
+            print("event %s\r\n", line);
+        }
+    }
+    else
+    {
+        imu_event_reader_init(&pipeline_events);
+    }
+
+    // If logging is enabled, continuously print IMU data
+    // Format: [@<host us>] <ax> <ay> <az> <gx> <gy> <gz> [!<health flags, hex>]
+    // The host time of the read is there once the host clock is synced
+    if (imu_logging_enabled && timesync_locked())
+    {
+        print("@%llu ", (unsigned long long)timesync_host_us(timesync_cycles_us(imu_sample_cycles())));
+    }
+    if (imu_logging_enabled && imu->health == 0)
+    {
+        print("%f %f %f %f %f %f\r\n",
+              imu->acc[0], imu->acc[1], imu->acc[2],
+              imu->gyr[0], imu->gyr[1], imu->gyr[2]);
+    }
+    else if (imu_logging_enabled)
+    {
+        print("%f %f %f %f %f %f !%02X\r\n",
+              imu->acc[0], imu->acc[1], imu->acc[2],
+              imu->gyr[0], imu->gyr[1], imu->gyr[2], imu->health);
+    }
+}
+
+void pipeline_set_rate_hz(uint16_t rate_hz)
+{
+    pipeline_rate = (rate_hz != 0) ? rate_hz : PIPELINE_DEFAULT_RATE_HZ;
+}
+
+uint16_t pipeline_rate_hz(void)
+{
+    return pipeline_rate;
+}
@@ -0,0 +1,92 @@
+/*
+ * pwm.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: halvard
+ *
+ *  Description: four-channel PWM output on TIM3
+ */
+
+#include "pwm.h"
+#include "main.h"
+
+static uint32_t pwm_period;     // ARR + 1, in PWM_TICK_HZ ticks
+
+static volatile uint32_t *pwm_ccr(int channel)
+{
+    switch (channel)
+    {
+        case 0:  return &TIM3->CCR1;
+        case 1:  return &TIM3->CCR2;
+        case 2:  return &TIM3->CCR3;
+        default: return &TIM3->CCR4;
+    }
+}
+
+int pwm_init(uint32_t freq_hz)
+{
+    if (freq_hz < 16 || freq_hz > 100000)
+    {
+        return 1;
+    }
+
+    __HAL_RCC_TIM3_CLK_ENABLE();
+    __HAL_RCC_GPIOA_CLK_ENABLE();
+    __HAL_RCC_GPIOB_CLK_ENABLE();
+
+    GPIO_InitTypeDef gpio = {0};
+    gpio.Mode = GPIO_MODE_AF_PP;
+    gpio.Speed = GPIO_SPEED_FREQ_LOW;
+    gpio.Pin = GPIO_PIN_6 | GPIO_PIN_7;
+    HAL_GPIO_Init(GPIOA, &gpio);
+    gpio.Pin = GPIO_PIN_0 | GPIO_PIN_1;
+    HAL_GPIO_Init(GPIOB, &gpio);
+
+    // APB1 timers run at twice PCLK1 whenever the APB1 prescaler isn't 1
+    uint32_t timer_clock = HAL_RCC_GetPCLK1Freq();
+    if ((RCC->CFGR & RCC_CFGR_PPRE1) != RCC_CFGR_PPRE1_DIV1)
+    {
+        timer_clock *= 2;
+    }
+
+    pwm_period = PWM_TICK_HZ / freq_hz;
+
+    TIM3->CR1 = 0;
+    TIM3->PSC = timer_clock / PWM_TICK_HZ - 1;
+    TIM3->ARR = pwm_period - 1;
+    TIM3->CCR1 = 0;
+    TIM3->CCR2 = 0;
+    TIM3->CCR3 = 0;
+    TIM3->CCR4 = 0;
+    TIM3->CCMR1 = (6U << TIM_CCMR1_OC1M_Pos) | TIM_CCMR1_OC1PE
+                | (6U << TIM_CCMR1_OC2M_Pos) | TIM_CCMR1_OC2PE;
+    TIM3->CCMR2 = (6U << TIM_CCMR2_OC3M_Pos) | TIM_CCMR2_OC3PE
+                | (6U << TIM_CCMR2_OC4M_Pos) | TIM_CCMR2_OC4PE;
+    TIM3->CCER = TIM_CCER_CC1E | TIM_CCER_CC2E | TIM_CCER_CC3E | TIM_CCER_CC4E;
+    TIM3->CR1 = TIM_CR1_ARPE;
+    TIM3->EGR = TIM_EGR_UG;     // load PSC/ARR now
+    TIM3->CR1 |= TIM_CR1_CEN;
+
+    return 0;
+}
+
+void pwm_set(int channel, float duty)
+{
+    if (channel < 0 || channel >= PWM_CHANNELS || pwm_period == 0)
+    {
+        return;
+    }
+
+    duty = (duty < 0.0f) ? 0.0f : ((duty > 1.0f) ? 1.0f : duty);
+    *pwm_ccr(channel) = (uint32_t)(duty * (float)pwm_period + 0.5f);
+}
+
+float pwm_duty(int channel)
+{
+    if (channel < 0 || channel >= PWM_CHANNELS || pwm_period == 0)
+    {
+        return 0.0f;
+    }
+
+    return (float)*pwm_ccr(channel) / (float)pwm_period;
+}
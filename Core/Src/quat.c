@@ -0,0 +1,207 @@
+/*
+ * quat.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: halvard
+ *
+ *  Description: batched quaternion attitude integration from gyro samples
+ */
+
+#include "quat.h"
+#include "mem_sections.h"
+#include "arm_math.h"
+
+#include <string.h>
+
+// =============================================================================
+// f32
+// =============================================================================
+
+static inline void quat_expmap1_f32(float32_t gx, float32_t gy, float32_t gz, float32_t half_dt,
+                                    float32_t *dq)
+{
+    float32_t rate = sqrtf(gx * gx + gy * gy + gz * gz);
+    if (rate == 0.0f)
+    {
+        dq[0] = 1.0f;
+        dq[1] = 0.0f;
+        dq[2] = 0.0f;
+        dq[3] = 0.0f;
+        return;
+    }
+
+    float32_t s, c;
+    arm_sin_cos_f32(rate * half_dt, &s, &c);       // degrees
+    float32_t k = s / rate;
+    dq[0] = c;
+    dq[1] = gx * k;
+    dq[2] = gy * k;
+    dq[3] = gz * k;
+}
+
+void quat_expmap_f32(const float32_t *gx, const float32_t *gy, const float32_t *gz,
+                     uint32_t n, float32_t dt, float32_t *dq)
+{
+    const float32_t half_dt = 0.5f * dt;
+    for (uint32_t i = 0; i < n; i++)
+    {
+        quat_expmap1_f32(gx[i], gy[i], gz[i], half_dt, &dq[4 * i]);
+    }
+}
+
+MEM_RAMFUNC(RAMFUNC_FILTER, quat_normalize_f32)
+void quat_normalize_f32(float32_t *q, uint32_t n)
+{
+    for (uint32_t i = 0; i < n; i++, q += 4)
+    {
+        float32_t k = 1.5f - 0.5f * (q[0] * q[0] + q[1] * q[1] + q[2] * q[2] + q[3] * q[3]);
+        q[0] *= k;
+        q[1] *= k;
+        q[2] *= k;
+        q[3] *= k;
+    }
+}
+
+void quat_integrate_f32(float32_t *q, const float32_t *gx, const float32_t *gy,
+                        const float32_t *gz, uint32_t n, float32_t dt, float32_t *work)
+{
+    float32_t r[4];
+
+    quat_expmap_f32(gx, gy, gz, n, dt, work);
+    for (uint32_t i = 0; i < n; i++)
+    {
+        arm_quaternion_product_single_f32(q, &work[4 * i], r);
+        memcpy(q, r, sizeof(r));
+    }
+    quat_normalize_f32(q, 1);
+}
+
+MEM_RAMFUNC(RAMFUNC_FILTER, quat_update_f32)
+void quat_update_f32(float32_t *q, float32_t gx, float32_t gy, float32_t gz, float32_t dt)
+{
+    float32_t dq[4], r[4];
+
+    quat_expmap1_f32(gx, gy, gz, 0.5f * dt, dq);
+    arm_quaternion_product_single_f32(q, dq, r);
+    memcpy(q, r, sizeof(r));
+    quat_normalize_f32(q, 1);
+}
+
+// =============================================================================
+// q31
+// =============================================================================
+
+q31_t quat_half_angle_scale_q31(float32_t dt)
+{
+    float32_t scale = QUAT_GYRO_FULL_SCALE * 0.5f * dt / 180.0f;
+    return (scale >= 1.0f) ? INT32_MAX : (q31_t)(scale * 2147483648.0f);
+}
+
+static inline void quat_expmap1_q31(q31_t gx, q31_t gy, q31_t gz, q31_t scale, q31_t *dq)
+{
+    // Half-angle vector as fractions of 180 degrees
+    q31_t ax = (q31_t)(((q63_t)gx * scale) >> 31);
+    q31_t ay = (q31_t)(((q63_t)gy * scale) >> 31);
+    q31_t az = (q31_t)(((q63_t)gz * scale) >> 31);
+    uint64_t sq = (uint64_t)((q63_t)ax * ax) + (uint64_t)((q63_t)ay * ay) + (uint64_t)((q63_t)az * az);
+    if (sq == 0)
+    {
+        dq[0] = INT32_MAX;
+        dq[1] = 0;
+        dq[2] = 0;
+        dq[3] = 0;
+        return;
+    }
+
+    // |a| from a normalised square (even shift e into [2^60, 2^62)), so
+    // small rotations keep their precision: norm = |a| 2^(e/2). The scale
+    // limit keeps |a| below 0.5, so sq < 2^62 and e >= 0
+    int e = (__builtin_clzll(sq) - 2) & ~1;
+    q31_t norm;
+    arm_sqrt_q31((q31_t)((sq << e) >> 31), &norm);
+    q31_t angle = norm >> (e / 2);
+
+    q31_t s, c;
+    arm_sin_cos_q31(angle, &s, &c);
+
+    // dq_xyz = a sin / |a| = a (s / norm) 2^(e/2)
+    q31_t quot;
+    int16_t shift;
+    arm_divide_q31(s, norm, &quot, &shift);
+    int down = 31 - shift - e / 2;
+    dq[0] = c;
+    if (down > 0)
+    {
+        dq[1] = clip_q63_to_q31(((q63_t)ax * quot) >> down);
+        dq[2] = clip_q63_to_q31(((q63_t)ay * quot) >> down);
+        dq[3] = clip_q63_to_q31(((q63_t)az * quot) >> down);
+    }
+    else
+    {
+        dq[1] = clip_q63_to_q31(((q63_t)ax * quot) << -down);
+        dq[2] = clip_q63_to_q31(((q63_t)ay * quot) << -down);
+        dq[3] = clip_q63_to_q31(((q63_t)az * quot) << -down);
+    }
+}
+
+void quat_expmap_q31(const q31_t *gx, const q31_t *gy, const q31_t *gz,
+                     uint32_t n, q31_t scale, q31_t *dq)
+{
+    for (uint32_t i = 0; i < n; i++)
+    {
+        quat_expmap1_q31(gx[i], gy[i], gz[i], scale, &dq[4 * i]);
+    }
+}
+
+MEM_RAMFUNC(RAMFUNC_FILTER, quat_product_q31)
+void quat_product_q31(const q31_t *a, const q31_t *b, q31_t *r)
+{
+    q63_t w = (q63_t)a[0] * b[0] - (q63_t)a[1] * b[1] - (q63_t)a[2] * b[2] - (q63_t)a[3] * b[3];
+    q63_t x = (q63_t)a[0] * b[1] + (q63_t)a[1] * b[0] + (q63_t)a[2] * b[3] - (q63_t)a[3] * b[2];
+    q63_t y = (q63_t)a[0] * b[2] - (q63_t)a[1] * b[3] + (q63_t)a[2] * b[0] + (q63_t)a[3] * b[1];
+    q63_t z = (q63_t)a[0] * b[3] + (q63_t)a[1] * b[2] - (q63_t)a[2] * b[1] + (q63_t)a[3] * b[0];
+    r[0] = clip_q63_to_q31(w >> 31);
+    r[1] = clip_q63_to_q31(x >> 31);
+    r[2] = clip_q63_to_q31(y >> 31);
+    r[3] = clip_q63_to_q31(z >> 31);
+}
+
+MEM_RAMFUNC(RAMFUNC_FILTER, quat_normalize_q31)
+void quat_normalize_q31(q31_t *q, uint32_t n)
+{
+    for (uint32_t i = 0; i < n; i++, q += 4)
+    {
+        // |q|^2 in 2.62 -> 2.30, factor (3 - |q|^2) / 2 in 2.30
+        q63_t sq = (q63_t)q[0] * q[0] + (q63_t)q[1] * q[1] + (q63_t)q[2] * q[2] + (q63_t)q[3] * q[3];
+        q31_t k = 0x60000000 - (q31_t)(sq >> 33);
+        q[0] = clip_q63_to_q31(((q63_t)q[0] * k) >> 30);
+        q[1] = clip_q63_to_q31(((q63_t)q[1] * k) >> 30);
+        q[2] = clip_q63_to_q31(((q63_t)q[2] * k) >> 30);
+        q[3] = clip_q63_to_q31(((q63_t)q[3] * k) >> 30);
+    }
+}
+
+void quat_integrate_q31(q31_t *q, const q31_t *gx, const q31_t *gy, const q31_t *gz,
+                        uint32_t n, q31_t scale, q31_t *work)
+{
+    q31_t r[4];
+
+    quat_expmap_q31(gx, gy, gz, n, scale, work);
+    for (uint32_t i = 0; i < n; i++)
+    {
+        quat_product_q31(q, &work[4 * i], r);
+        memcpy(q, r, sizeof(r));
+    }
+    quat_normalize_q31(q, 1);
+}
+
+MEM_RAMFUNC(RAMFUNC_FILTER, quat_update_q31)
+void quat_update_q31(q31_t *q, q31_t gx, q31_t gy, q31_t gz, q31_t scale)
+{
+    q31_t dq[4], r[4];
+
+    quat_expmap1_q31(gx, gy, gz, scale, dq);
+    quat_product_q31(q, dq, r);
+    memcpy(q, r, sizeof(r));
+    quat_normalize_q31(q, 1);
+}
@@ -0,0 +1,74 @@
+/*
+ * scratch.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: halvard
+ *
+ *  Description: shared scratch arena for work buffers with disjoint lifetimes
+ */
+
+#include "scratch.h"
+#include "mem_sections.h"
+
+static uint64_t scratch_arena[SCRATCH_SIZE / sizeof(uint64_t)] MEM_SCRATCH(scratch_arena);
+static scratch_owner_t scratch_current = SCRATCH_OWNER_NONE;
+static size_t scratch_max_request = 0;
+
+static const char *const scratch_names[SCRATCH_OWNER_COUNT] = {
+    [SCRATCH_OWNER_NONE] = "none",
+    [SCRATCH_OWNER_DSP]  = "dsp",
+    [SCRATCH_OWNER_ANC]  = "anc",
+    [SCRATCH_OWNER_XCORR] = "xcorr",
+    [SCRATCH_OWNER_ENVELOPE] = "envelope",
+    [SCRATCH_OWNER_MFCC] = "mfcc",
+};
+
+void *scratch_acquire(scratch_owner_t owner, size_t size)
+{
+    if (owner == SCRATCH_OWNER_NONE || owner >= SCRATCH_OWNER_COUNT)
+    {
+        return NULL;
+    }
+    if (size > scratch_max_request)
+    {
+        scratch_max_request = size;
+    }
+    if (size > sizeof(scratch_arena))
+    {
+        return NULL;
+    }
+    if (scratch_current != SCRATCH_OWNER_NONE && scratch_current != owner)
+    {
+        return NULL;
+    }
+
+    scratch_current = owner;
+    return scratch_arena;
+}
+
+void scratch_release(scratch_owner_t owner)
+{
+    if (scratch_current == owner)
+    {
+        scratch_current = SCRATCH_OWNER_NONE;
+    }
+}
+
+scratch_owner_t scratch_owner(void)
+{
+    return scratch_current;
+}
+
+size_t scratch_high_water(void)
+{
+    return scratch_max_request;
+}
+
+const char *scratch_owner_name(scratch_owner_t owner)
+{
+    if (owner >= SCRATCH_OWNER_COUNT)
+    {
+        return "?";
+    }
+    return scratch_names[owner];
+}
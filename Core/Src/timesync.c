@@ -0,0 +1,214 @@
+/*
+ * timesync.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: halvard
+ *
+ *  Description: two-way time sync with the host over the console UART
+ */
+
+#include "timesync.h"
+#include "fmt.h"
+#include "imu_replay.h"
+#include "main.h"
+#include "timer_module.h"
+#include "uart_tx.h"
+
+#include <math.h>
+#include <string.h>
+
+timesync_config_t timesync_config = {
+    .gate = 200,
+    .lock = 8,
+};
+
+typedef struct {
+    uint64_t at;                // device time of the exchange, (t2 + t3) / 2
+    int64_t offset;             // device - host, us
+    uint32_t delay;             // us
+} timesync_exchange_t;
+
+static struct {
+    timesync_exchange_t window[TIMESYNC_WINDOW];
+    uint32_t head;              // next slot to write
+    bool pending;               // t1..t3 of request seq wait for its t4
+    uint32_t seq;
+    uint64_t t1, t2, t3;
+    uint64_t ref;               // device time the fit is anchored at
+    int64_t offset;             // at ref, us
+    float skew;                 // offset change per device us
+    timesync_summary_t summary;
+} ts;
+
+void timesync_reset(void)
+{
+    memset(&ts, 0, sizeof(ts));
+}
+
+/**
+ * @brief float to the nearest integer, without pulling in libm's llround.
+ */
+static int64_t timesync_round(float v)
+{
+    return (int64_t)((v >= 0.0f) ? v + 0.5f : v - 0.5f);
+}
+
+/**
+ * @brief Least-squares line through the offsets of the exchanges within the
+ * delay gate. Times and offsets stay int64 microseconds relative to the
+ * newest exchange and to their (integer) means; only the centred products,
+ * a few seconds times a few hundred us, go through float.
+ */
+static void timesync_fit(const timesync_exchange_t *newest)
+{
+    const uint32_t n = (ts.summary.exchanges < TIMESYNC_WINDOW) ? ts.summary.exchanges : TIMESYNC_WINDOW;
+    uint32_t dmin = UINT32_MAX;
+    for (uint32_t i = 0; i < n; i++)
+    {
+        dmin = (ts.window[i].delay < dmin) ? ts.window[i].delay : dmin;
+    }
+    const uint32_t gate = (timesync_config.gate > 0) ? (uint32_t)timesync_config.gate : 0;
+
+    int64_t sx = 0, sy = 0;
+    uint32_t used = 0;
+    for (uint32_t i = 0; i < n; i++)
+    {
+        const timesync_exchange_t *e = &ts.window[i];
+        if (e->delay <= dmin + gate)
+        {
+            sx += (int64_t)(e->at - newest->at);
+            sy += e->offset - newest->offset;
+            used++;
+        }
+    }
+    const int64_t mx = sx / (int64_t)used, my = sy / (int64_t)used;
+
+    float sdx = 0.0f, sdy = 0.0f, sxx = 0.0f, sxy = 0.0f;
+    for (uint32_t i = 0; i < n; i++)
+    {
+        const timesync_exchange_t *e = &ts.window[i];
+        if (e->delay <= dmin + gate)
+        {
+            const float dx = (float)((int64_t)(e->at - newest->at) - mx);
+            const float dy = (float)(e->offset - newest->offset - my);
+            sdx += dx;
+            sdy += dy;
+            sxx += dx * dx;
+            sxy += dx * dy;
+        }
+    }
+
+    // A line needs two exchanges some time apart, until then the skew stays
+    const float mdx = sdx / (float)used, mdy = sdy / (float)used;
+    const float vxx = sxx - sdx * mdx;
+    if (used >= 2 && vxx > 1.0f)
+    {
+        ts.skew = (sxy - sdx * mdy) / vxx;
+    }
+
+    float ss = 0.0f;
+    for (uint32_t i = 0; i < n; i++)
+    {
+        const timesync_exchange_t *e = &ts.window[i];
+        if (e->delay <= dmin + gate)
+        {
+            const float dx = (float)((int64_t)(e->at - newest->at) - mx);
+            const float dy = (float)(e->offset - newest->offset - my);
+            const float r = dy - mdy - ts.skew * (dx - mdx);
+            ss += r * r;
+        }
+    }
+
+    ts.ref = newest->at;
+    ts.offset = newest->offset + my + timesync_round(mdy - ts.skew * ((float)mx + mdx));
+    ts.summary.used = used;
+    ts.summary.delay_min_us = dmin;
+    ts.summary.rms_us = sqrtf(ss / (float)used);
+    ts.summary.skew_ppm = ts.skew * 1e6f;
+    ts.summary.locked = (ts.summary.exchanges >= (uint32_t)timesync_config.lock);
+}
+
+static void timesync_complete(uint64_t t4)
+{
+    // A reply can't arrive before its request was sent
+    if (t4 < ts.t1)
+    {
+        return;
+    }
+    timesync_exchange_t *e = &ts.window[ts.head];
+    const int64_t up = (int64_t)(ts.t2 - ts.t1);
+    const int64_t down = (int64_t)(ts.t3 - t4);
+    const uint64_t turn = ts.t3 - ts.t2;
+    const uint64_t rtt = t4 - ts.t1;
+
+    e->at = ts.t2 + turn / 2;
+    e->offset = (up + down) / 2;
+    e->delay = (rtt > turn) ? (uint32_t)(rtt - turn) : 0;
+    ts.head = (ts.head + 1) % TIMESYNC_WINDOW;
+    ts.summary.exchanges++;
+    ts.summary.delay_us = e->delay;
+    timesync_fit(e);
+}
+
+int timesync_request(uint32_t seq, uint64_t t1, bool has_t4, uint64_t t4, uint64_t t2)
+{
+    // t4 belongs to the previous request; anything else was lost on the way
+    if (has_t4 && ts.pending && ts.seq + 1 == seq)
+    {
+        timesync_complete(t4);
+    }
+    ts.summary.requests++;
+
+    char line[32];
+    uint8_t frame[TIMESYNC_FRAME_BYTES + 4];
+    const uint16_t len = (uint16_t)fmt_snprintf(line, sizeof(line), "sync %lu: %u bytes\r\n",
+                                                (unsigned long)seq, (unsigned)TIMESYNC_FRAME_BYTES);
+
+    // t3 as late as possible: the header goes out right after it
+    const uint64_t t3 = micros();
+    const uint64_t t[3] = {t1, t2, t3};
+    for (int i = 0; i < 3; i++)
+    {
+        for (int b = 0; b < 8; b++)
+        {
+            frame[8 * i + b] = (uint8_t)(t[i] >> (8 * b));
+        }
+    }
+    const uint32_t crc = imu_replay_crc32(0, frame, TIMESYNC_FRAME_BYTES);
+    for (int b = 0; b < 4; b++)
+    {
+        frame[TIMESYNC_FRAME_BYTES + b] = (uint8_t)(crc >> (8 * b));
+    }
+
+    ts.pending = true;
+    ts.seq = seq;
+    ts.t1 = t1;
+    ts.t2 = t2;
+    ts.t3 = t3;
+    const uint16_t sent = uart_tx_write((const uint8_t *)line, len);
+    return (sent != len || uart_tx_write(frame, sizeof(frame)) != sizeof(frame));
+}
+
+bool timesync_locked(void)
+{
+    return ts.summary.locked;
+}
+
+uint64_t timesync_host_us(uint64_t device_us)
+{
+    const float dt = (float)(int64_t)(device_us - ts.ref);
+    return device_us - (uint64_t)(ts.offset + timesync_round(ts.skew * dt));
+}
+
+uint64_t timesync_cycles_us(uint32_t cycles)
+{
+    const uint64_t now = micros();
+    const uint32_t age = (DWT->CYCCNT - cycles) / (SystemCoreClock / 1000000u);
+    return (age < now) ? now - age : 0;
+}
+
+void timesync_get_summary(timesync_summary_t *summary)
+{
+    *summary = ts.summary;
+    summary->offset_us = ts.offset + timesync_round(ts.skew * (float)(int64_t)(micros() - ts.ref));
+}
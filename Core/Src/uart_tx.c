@@ -0,0 +1,153 @@
+/*
+ * uart_tx.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: halvard
+ *
+ *  Description: interrupt-driven UART transmit ring
+ *
+ *  head/tail are free-running 16-bit indices (masked on access). The ring
+ *  hands the longest contiguous run to HAL_UART_Transmit_IT() and the TX
+ *  complete callback advances tail and starts the next run.
+ */
+
+#include "uart_tx.h"
+#include "mem_sections.h"
+
+#define UART_TX_MASK (UART_TX_BUFFER_SIZE - 1)
+
+// Upper bound on bytes copied per critical section
+#define UART_TX_COPY_CHUNK 64
+
+static uint8_t uart_tx_buffer[UART_TX_BUFFER_SIZE] MEM_RAM_BUFFER(uart_tx_buffer);
+static volatile uint16_t uart_tx_head = 0;
+static volatile uint16_t uart_tx_tail = 0;
+static volatile uint16_t uart_tx_inflight = 0;
+static volatile uint32_t uart_tx_drop_count = 0;
+static UART_HandleTypeDef *uart_tx_huart = NULL;
+
+/**
+ * @brief Starts the next contiguous run if the UART is idle.
+ * Must be called with interrupts disabled or from the TX complete ISR.
+ */
+static void uart_tx_kick(void)
+{
+    if (uart_tx_huart == NULL || uart_tx_inflight != 0)
+    {
+        return;
+    }
+
+    uint16_t used = (uint16_t)(uart_tx_head - uart_tx_tail);
+    if (used == 0)
+    {
+        return;
+    }
+
+    uint16_t start = uart_tx_tail & UART_TX_MASK;
+    uint16_t run = UART_TX_BUFFER_SIZE - start;
+    if (run > used)
+    {
+        run = used;
+    }
+
+    uart_tx_inflight = run;
+    if (HAL_UART_Transmit_IT(uart_tx_huart, &uart_tx_buffer[start], run) != HAL_OK)
+    {
+        // UART busy/locked, retried on the next write or flush
+        uart_tx_inflight = 0;
+    }
+}
+
+static void uart_tx_kick_locked(void)
+{
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    uart_tx_kick();
+    __set_PRIMASK(primask);
+}
+
+void uart_tx_init(UART_HandleTypeDef *huart)
+{
+    uart_tx_huart = huart;
+    uart_tx_head = 0;
+    uart_tx_tail = 0;
+    uart_tx_inflight = 0;
+    uart_tx_drop_count = 0;
+}
+
+uint16_t uart_tx_write(const uint8_t *data, uint16_t len)
+{
+    // Waiting for space only works if the TX interrupt can still fire
+    bool can_wait = (__get_IPSR() == 0) && (__get_PRIMASK() == 0);
+    uint16_t written = 0;
+
+    while (written < len)
+    {
+        uint32_t primask = __get_PRIMASK();
+        __disable_irq();
+
+        uint16_t space = UART_TX_BUFFER_SIZE - (uint16_t)(uart_tx_head - uart_tx_tail);
+        uint16_t n = len - written;
+        n = (n < space) ? n : space;
+        n = (n < UART_TX_COPY_CHUNK) ? n : UART_TX_COPY_CHUNK;
+
+        uint16_t head = uart_tx_head;
+        for (uint16_t i = 0; i < n; i++)
+        {
+            uart_tx_buffer[(uint16_t)(head + i) & UART_TX_MASK] = data[written + i];
+        }
+        uart_tx_head = head + n;
+        written += n;
+
+        uart_tx_kick();
+        __set_PRIMASK(primask);
+
+        if (n == 0 && !can_wait)
+        {
+            uart_tx_drop_count += len - written;
+            break;
+        }
+    }
+
+    return written;
+}
+
+uint16_t uart_tx_space(void)
+{
+    return UART_TX_BUFFER_SIZE - (uint16_t)(uart_tx_head - uart_tx_tail);
+}
+
+void uart_tx_putc(char c)
+{
+    uart_tx_write((const uint8_t *)&c, 1);
+}
+
+void uart_tx_flush(void)
+{
+    if (__get_IPSR() != 0 || __get_PRIMASK() != 0)
+    {
+        return;
+    }
+
+    while (uart_tx_head != uart_tx_tail)
+    {
+        uart_tx_kick_locked();
+    }
+}
+
+uint32_t uart_tx_dropped(void)
+{
+    return uart_tx_drop_count;
+}
+
+void HAL_UART_TxCpltCallback(UART_HandleTypeDef *huart)
+{
+    if (huart != uart_tx_huart)
+    {
+        return;
+    }
+
+    uart_tx_tail += uart_tx_inflight;
+    uart_tx_inflight = 0;
+    uart_tx_kick();
+}
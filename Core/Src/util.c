@@ -9,23 +9,56 @@
 
 #include "util.h"
 #include "config.h"
+#include "fmt.h"
+#include "uart_tx.h"
 
 #include <stdarg.h>
 #include <string.h>
 
+// Formatted output is staged in small chunks before entering the TX ring
+#define PRINT_CHUNK_SIZE 32
+
+typedef struct {
+    char buf[PRINT_CHUNK_SIZE];
+    uint16_t len;
+} print_chunk_t;
+
 void zeromem(void* pdata, size_t size)
 {
     memset(pdata, 0, size);
 }
 
-void print(const char* format, ...)
+static void print_sink(char c, void *ctx)
+{
+    print_chunk_t *chunk = (print_chunk_t *)ctx;
+    chunk->buf[chunk->len++] = c;
+    if (chunk->len == PRINT_CHUNK_SIZE)
+    {
+        uart_tx_write((const uint8_t *)chunk->buf, chunk->len);
+        chunk->len = 0;
+    }
+}
+
+void vprint(const char* format, va_list args)
 {
 #ifndef ENABLE_LOGGING
     (void)format;
+    (void)args;
 #else
+    print_chunk_t chunk;
+    chunk.len = 0;
+    fmt_vformat(print_sink, &chunk, format, args);
+    if (chunk.len > 0)
+    {
+        uart_tx_write((const uint8_t *)chunk.buf, chunk.len);
+    }
+#endif
+}
+
+void print(const char* format, ...)
+{
     va_list args;
     va_start(args, format);
-    vprintf(format, args);
+    vprint(format, args);
     va_end(args);
-#endif
-}
\ No newline at end of file
+}
@@ -0,0 +1,238 @@
+/*
+ * xcorr.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: halvard
+ *
+ *  Description: sliding-block cross-correlation between two IMU channels
+ */
+
+#include "xcorr.h"
+#include "scratch.h"
+#include "main.h"
+#include "arm_math.h"
+
+#include <string.h>
+
+// Energy both blocks are scaled to. By Cauchy-Schwarz no partial sum of
+// the correlation can exceed it, so the 2.30 accumulator neither wraps nor
+// saturates the 1.15 output, and no single sample can exceed q15 range
+#define XCORR_TARGET_ENERGY (0.9f * 1073741824.0f)
+
+xcorr_config_t xcorr_config = {
+    .a = 0,
+    .b = 2,
+    .n = 128,
+    .maxlag = 16,
+    .log = false,
+};
+
+static struct {
+    bool enabled;
+    xcorr_config_t active;
+    uint32_t m;                 // correlated length of b, n - 2*maxlag
+    uint32_t fill;
+
+    // Scratch arena layout
+    q15_t *hist_a;              // [n]
+    q15_t *hist_b;              // [n]
+    q15_t *work_a;              // [n]
+    q15_t *work_b;              // [m]
+    q15_t *corr;                // [2n - 1]
+    q15_t *corr_scratch;        // [n + 2m - 2]
+
+    xcorr_summary_t summary;
+} xc;
+
+static q15_t xcorr_to_q15(float x, float full_scale)
+{
+    float v = x / full_scale * 32768.0f;
+    if (v >= 32767.0f)
+    {
+        return INT16_MAX;
+    }
+    if (v <= -32768.0f)
+    {
+        return INT16_MIN;
+    }
+    return (q15_t)v;
+}
+
+/**
+ * @brief dst = (src - mean) scaled to XCORR_TARGET_ENERGY.
+ * @return Energy of dst, 0 for a constant block
+ */
+static q63_t xcorr_normalise(const q15_t *src, q15_t *dst, uint32_t len)
+{
+    q15_t mean;
+    q63_t energy;
+
+    arm_mean_q15(src, len, &mean);
+    arm_offset_q15(src, (q15_t)-mean, dst, len);
+    arm_power_q15(dst, len, &energy);
+    if (energy == 0)
+    {
+        return 0;
+    }
+
+    // arm_scale_q15 multiplies by fract * 2^shift, fract in 1.15
+    float scale = sqrtf(XCORR_TARGET_ENERGY / (float)energy);
+    int8_t shift = 0;
+    while (scale >= 1.0f && shift < 15)
+    {
+        scale *= 0.5f;
+        shift++;
+    }
+    q15_t fract = (scale >= 32767.0f / 32768.0f) ? INT16_MAX : (q15_t)(scale * 32768.0f);
+    arm_scale_q15(dst, fract, shift, dst, len);
+
+    arm_power_q15(dst, len, &energy);
+    return energy;
+}
+
+static void xcorr_block(void)
+{
+    const uint32_t n = (uint32_t)xc.active.n;
+    const uint32_t lag_max = (uint32_t)xc.active.maxlag;
+    const uint32_t m = xc.m;
+
+    q63_t energy_a = xcorr_normalise(xc.hist_a, xc.work_a, n);
+    q63_t energy_b = xcorr_normalise(xc.hist_b + lag_max, xc.work_b, m);
+    if (energy_a == 0 || energy_b == 0)
+    {
+        xc.summary.lag = 0.0f;
+        xc.summary.rho = 0.0f;
+        return;
+    }
+
+    arm_correlate_fast_opt_q15(xc.work_a, n, xc.work_b, m, xc.corr, xc.corr_scratch);
+
+    // corr[n - 1 + k] pairs work_a[k + i] with work_b[i]; work_b starts at
+    // block offset maxlag, so k = maxlag - lag
+    const q15_t *valid = &xc.corr[n - 1];
+    q15_t peak_abs;
+    uint32_t k;
+    arm_absmax_q15(valid, 2 * lag_max + 1, &peak_abs, &k);
+    float peak = (float)valid[k];
+
+    // Parabolic refinement on the signed peak
+    float frac = 0.0f;
+    if (k > 0 && k < 2 * lag_max)
+    {
+        float sign = (peak < 0.0f) ? -1.0f : 1.0f;
+        float y0 = sign * peak;
+        float ym = sign * (float)valid[k - 1];
+        float yp = sign * (float)valid[k + 1];
+        float denom = ym - 2.0f * y0 + yp;
+        if (denom < 0.0f)
+        {
+            frac = 0.5f * (ym - yp) / denom;
+        }
+    }
+    xc.summary.lag = (float)lag_max - ((float)k + frac);
+
+    // Normalise by the energy of the part of a that overlaps b at the peak
+    q63_t energy_a_seg;
+    arm_power_q15(&xc.work_a[k], m, &energy_a_seg);
+    float rho = 0.0f;
+    if (energy_a_seg > 0)
+    {
+        rho = peak * 32768.0f / sqrtf((float)energy_a_seg * (float)energy_b);
+    }
+    xc.summary.rho = (rho > 1.0f) ? 1.0f : ((rho < -1.0f) ? -1.0f : rho);
+}
+
+int xcorr_enable(void)
+{
+    xcorr_disable();
+
+    const xcorr_config_t *cfg = &xcorr_config;
+    if (cfg->a < 0 || cfg->a >= IMU_CHANNELS || cfg->b < 0 || cfg->b >= IMU_CHANNELS
+        || cfg->n < XCORR_MIN_N || cfg->n > XCORR_MAX_N || (cfg->n & 1) != 0
+        || cfg->maxlag < 1 || cfg->maxlag > cfg->n / 4)
+    {
+        return 1;
+    }
+
+    uint32_t n = (uint32_t)cfg->n;
+    uint32_t m = n - 2 * (uint32_t)cfg->maxlag;
+    size_t words = 3 * n + m + (2 * n - 1) + (n + 2 * m - 2);
+    q15_t *mem = scratch_acquire(SCRATCH_OWNER_XCORR, words * sizeof(q15_t));
+    if (mem == NULL)
+    {
+        return 1;
+    }
+
+    memset(&xc, 0, sizeof(xc));
+    xc.active = *cfg;
+    xc.m = m;
+    xc.hist_a = mem;
+    xc.hist_b = xc.hist_a + n;
+    xc.work_a = xc.hist_b + n;
+    xc.work_b = xc.work_a + n;
+    xc.corr = xc.work_b + m;
+    xc.corr_scratch = xc.corr + (2 * n - 1);
+
+    xc.enabled = true;
+    return 0;
+}
+
+void xcorr_disable(void)
+{
+    if (xc.enabled)
+    {
+        xc.enabled = false;
+        scratch_release(SCRATCH_OWNER_XCORR);
+    }
+}
+
+bool xcorr_enabled(void)
+{
+    return xc.enabled;
+}
+
+int xcorr_process(const imu_t *imu)
+{
+    if (!xc.enabled)
+    {
+        return 0;
+    }
+
+    float fs_a = (xc.active.a < 3) ? XCORR_ACCEL_FULL_SCALE : XCORR_GYRO_FULL_SCALE;
+    float fs_b = (xc.active.b < 3) ? XCORR_ACCEL_FULL_SCALE : XCORR_GYRO_FULL_SCALE;
+    xc.hist_a[xc.fill] = xcorr_to_q15(imu_channel(imu, xc.active.a), fs_a);
+    xc.hist_b[xc.fill] = xcorr_to_q15(imu_channel(imu, xc.active.b), fs_b);
+    xc.fill++;
+
+    const uint32_t n = (uint32_t)xc.active.n;
+    if (xc.fill < n)
+    {
+        return 0;
+    }
+
+    uint32_t start = DWT->CYCCNT;
+    xcorr_block();
+    uint32_t cycles = DWT->CYCCNT - start;
+
+    xc.summary.blocks++;
+    xc.summary.cycles = cycles;
+    xc.summary.cycles_max = (cycles > xc.summary.cycles_max) ? cycles : xc.summary.cycles_max;
+
+    // Slide by half a block
+    const uint32_t hop = n / 2;
+    memmove(xc.hist_a, xc.hist_a + hop, (n - hop) * sizeof(q15_t));
+    memmove(xc.hist_b, xc.hist_b + hop, (n - hop) * sizeof(q15_t));
+    xc.fill = n - hop;
+
+    return 1;
+}
+
+void xcorr_get_summary(xcorr_summary_t *summary)
+{
+    *summary = xc.summary;
+}
+
+void xcorr_get_active(xcorr_config_t *config)
+{
+    *config = xc.active;
+}
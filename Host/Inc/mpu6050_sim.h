@@ -0,0 +1,70 @@
+/*
+ * mpu6050_sim.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: halvard
+ *
+ *  Description: MPU6050 register model behind the host I2C shim
+ *
+ *  Enough of the chip for the LibDriver driver to run unmodified: register
+ *  file with power-on defaults, self-clearing reset bits, auto-increment
+ *  burst access, the FIFO behind FIFO_R_W and the DMP memory window behind
+ *  BANK_SEL/MEM_START_ADDR/MEM_R_W. Sensor values are whatever was last set
+ *  with mpu6050_sim_set_raw(); nothing is generated on its own.
+ */
+
+#ifndef HOST_MPU6050_SIM_H_
+#define HOST_MPU6050_SIM_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+// 8-bit bus address the simulated chip answers on (AD0 low)
+#define MPU6050_SIM_ADDRESS 0xD0
+
+#define MPU6050_SIM_FIFO_SIZE 1024
+
+/**
+ * @brief Power-on reset: defaults, empty FIFO, 1 g on +Z and zero rate.
+ */
+void mpu6050_sim_reset(void);
+
+/**
+ * @brief Sets the output registers (raw counts, as the chip would report
+ * them for the configured ranges). If the FIFO is enabled the enabled
+ * sources are appended to it like one sample period.
+ */
+void mpu6050_sim_set_raw(const int16_t accel[3], int16_t temp, const int16_t gyro[3]);
+
+/**
+ * @brief Rising edge on FSYNC: latched until the next mpu6050_sim_set_raw(),
+ * which puts it in the LSB of the output EXT_SYNC_SET selects.
+ */
+void mpu6050_sim_fsync(void);
+
+/**
+ * @brief Appends raw bytes to the FIFO (DMP packets, crafted frames).
+ * @return Bytes accepted; the rest is dropped and sets the overflow flag.
+ */
+uint16_t mpu6050_sim_fifo_push(const uint8_t *data, uint16_t len);
+
+/**
+ * @brief Register access used by the I2C shim.
+ * @return 0 on success, 1 if the access falls outside the register map
+ */
+uint8_t mpu6050_sim_read(uint8_t reg, uint8_t *buf, uint16_t len);
+uint8_t mpu6050_sim_write(uint8_t reg, const uint8_t *buf, uint16_t len);
+
+/**
+ * @brief Direct register peek for tests (no side effects).
+ */
+uint8_t mpu6050_sim_peek(uint8_t reg);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HOST_MPU6050_SIM_H_ */
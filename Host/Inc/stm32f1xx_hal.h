@@ -0,0 +1,167 @@
+/*
+ * stm32f1xx_hal.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: halvard
+ *
+ *  Description: host stand-in for the STM32F1 HAL (host build only)
+ *
+ *  Found ahead of the real HAL on the host include path, so Core sources
+ *  build unchanged for x86 Linux. Only the subset Core actually uses is
+ *  provided: HAL status/handle types, HAL_GetTick/HAL_Delay, the I2C memory
+ *  transfers, UART transmit, the DWT cycle counter and the PRIMASK/IPSR
+ *  intrinsics. The implementation lives in Host/Src/hal_shim.c; I2C traffic
+ *  to the MPU6050 address is served by the register model in mpu6050_sim.c.
+ */
+
+#ifndef HOST_STM32F1XX_HAL_H_
+#define HOST_STM32F1XX_HAL_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// =============================================================================
+// Core types
+// =============================================================================
+
+typedef enum
+{
+    HAL_OK       = 0x00U,
+    HAL_ERROR    = 0x01U,
+    HAL_BUSY     = 0x02U,
+    HAL_TIMEOUT  = 0x03U
+} HAL_StatusTypeDef;
+
+typedef struct
+{
+    volatile uint32_t CNDTR;
+} DMA_Channel_TypeDef;
+
+typedef struct
+{
+    DMA_Channel_TypeDef *Instance;
+} DMA_HandleTypeDef;
+
+typedef struct
+{
+    void *Instance;
+    volatile uint32_t ErrorCode;
+} UART_HandleTypeDef;
+
+typedef struct
+{
+    void *Instance;
+    volatile uint32_t ErrorCode;
+} I2C_HandleTypeDef;
+
+#define I2C_MEMADD_SIZE_8BIT  0x00000001U
+#define I2C_MEMADD_SIZE_16BIT 0x00000010U
+
+#define HAL_MAX_DELAY 0xFFFFFFFFU
+
+// =============================================================================
+// Cortex-M core stand-ins
+// =============================================================================
+
+// Core clock the DWT counter is scaled to (matches SystemClock_Config)
+#define HOST_CORE_CLOCK_HZ 72000000U
+
+typedef struct
+{
+    volatile uint32_t CTRL;
+    volatile uint32_t CYCCNT;
+} DWT_Type;
+
+typedef struct
+{
+    volatile uint32_t DEMCR;
+} CoreDebug_Type;
+
+#define DWT_CTRL_CYCCNTENA_Msk       (1UL << 0)
+#define CoreDebug_DEMCR_TRCENA_Msk   (1UL << 24)
+
+// CMSIS core clock variable, fixed at HOST_CORE_CLOCK_HZ
+extern uint32_t SystemCoreClock;
+
+extern CoreDebug_Type host_core_debug;
+extern volatile uint32_t host_primask;
+extern volatile uint32_t host_ipsr;
+
+/**
+ * @brief Brings CYCCNT up to date with the host clock and returns the DWT
+ * block. CYCCNT advances at HOST_CORE_CLOCK_HZ from wall time (none with
+ * HOST_CLOCK=virtual) plus any virtual time added by HAL_Delay(); writes
+ * to CYCCNT are kept as an offset.
+ */
+DWT_Type *host_dwt_sync(void);
+
+#define DWT       (host_dwt_sync())
+#define CoreDebug (&host_core_debug)
+
+static inline void __disable_irq(void)      { host_primask = 1U; }
+static inline void __enable_irq(void)       { host_primask = 0U; }
+static inline uint32_t __get_PRIMASK(void)  { return host_primask; }
+static inline void __set_PRIMASK(uint32_t primask) { host_primask = primask; }
+static inline uint32_t __get_IPSR(void)     { return host_ipsr; }
+static inline void __DSB(void)              { __atomic_thread_fence(__ATOMIC_SEQ_CST); }
+static inline void __DMB(void)              { __atomic_thread_fence(__ATOMIC_SEQ_CST); }
+static inline void __NOP(void)              { }
+static inline uint32_t __REV(uint32_t value)   { return __builtin_bswap32(value); }
+static inline uint32_t __REV16(uint32_t value) { return ((value & 0x00FF00FFU) << 8) | ((value >> 8) & 0x00FF00FFU); }
+
+// =============================================================================
+// HAL functions
+// =============================================================================
+
+uint32_t HAL_GetTick(void);
+
+/**
+ * @brief Does not sleep: advances the virtual clock by Delay ms so driver
+ * timeouts and reset waits complete instantly on the host.
+ */
+void HAL_Delay(uint32_t Delay);
+
+HAL_StatusTypeDef HAL_I2C_Mem_Read(I2C_HandleTypeDef *hi2c, uint16_t DevAddress,
+                                   uint16_t MemAddress, uint16_t MemAddSize,
+                                   uint8_t *pData, uint16_t Size, uint32_t Timeout);
+HAL_StatusTypeDef HAL_I2C_Mem_Write(I2C_HandleTypeDef *hi2c, uint16_t DevAddress,
+                                    uint16_t MemAddress, uint16_t MemAddSize,
+                                    uint8_t *pData, uint16_t Size, uint32_t Timeout);
+
+HAL_StatusTypeDef HAL_UART_Transmit(UART_HandleTypeDef *huart, const uint8_t *pData,
+                                    uint16_t Size, uint32_t Timeout);
+
+/**
+ * @brief Writes the data to the UART sink and calls HAL_UART_TxCpltCallback()
+ * before returning, as if the transfer finished instantly.
+ */
+HAL_StatusTypeDef HAL_UART_Transmit_IT(UART_HandleTypeDef *huart, const uint8_t *pData,
+                                       uint16_t Size);
+void HAL_UART_TxCpltCallback(UART_HandleTypeDef *huart);
+
+// =============================================================================
+// Host-only controls
+// =============================================================================
+
+/**
+ * @brief Output sink for everything transmitted on any UART. Defaults to
+ * stdout; tests can capture the console by installing their own.
+ */
+typedef void (*host_uart_sink_t)(const uint8_t *data, uint16_t len);
+void host_uart_set_sink(host_uart_sink_t sink);
+
+/**
+ * @brief Advances the virtual clock (HAL_GetTick and DWT) by us microseconds.
+ */
+void host_advance_us(uint64_t us);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HOST_STM32F1XX_HAL_H_ */
@@ -0,0 +1,158 @@
+/*
+ * autorange_test.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: halvard
+ *
+ *  Description: host test of auto-ranging across a shock (IMU_BACKEND_SIM)
+ *
+ *      ./autorange_test
+ *
+ *  The synthetic sensor rolls slowly at 100 Hz, +-2 g and +-2000 dps, with
+ *  auto-ranging and the event capture armed:
+ *
+ *  - quiet: the gyro steps down to +-250 dps, one range per hold time,
+ *    and the accelerometer stays at +-2 g;
+ *  - a 6 g half-sine shock on z over 5 samples: the first sample clips at
+ *    +-2 g and sends the accelerometer straight to +-16 g, the others must
+ *    read the shock to within 0.05 g;
+ *  - quiet again: back down to +-2 g.
+ *
+ *  Every published sample is checked against the previous one: outside the
+ *  shock, a sample decoded at the wrong scale would jump by a factor of 2
+ *  or more, so consecutive samples must stay within 0.05 g / 2 dps. Range
+ *  tags must change exactly at the switches. The capture window across
+ *  the shock must peak at 7 g. Exits 0 if all of that holds.
+ */
+
+#include "autorange.h"
+#include "capture.h"
+#include "imu.h"
+#include "imu_backend_sim.h"
+#include "imu_sample.h"
+#include "uart_tx.h"
+#include "usart.h"
+
+#include <math.h>
+#include <stdio.h>
+
+#define TEST_G          9.81f
+#define SHOCK_G         6.0f
+#define SHOCK_SAMPLES   5
+
+static imu_sample_t prev;
+static uint32_t tag_changes;
+static uint32_t jumps;
+static uint32_t shock_errors;
+
+/**
+ * @brief One 10 ms sample through the IMU, auto-ranging and capture.
+ * @param shock Index of the sample within the shock, 1.., or 0 outside
+ */
+static void step(int shock)
+{
+    imu_t imu;
+    imu_sample_t s;
+
+    HAL_Delay(10);
+    if (imu_process(&imu) != 0 || imu_sample_snapshot(&s) != 0)
+    {
+        printf("sample read failed\n");
+        jumps++;
+        return;
+    }
+    autorange_process(&imu);
+    capture_process(&imu);
+
+    if (prev.seq != 0 && s.range.switches != prev.range.switches)
+    {
+        tag_changes++;
+    }
+    if (prev.seq != 0 && shock == 0)
+    {
+        for (int i = 0; i < 3; i++)
+        {
+            jumps += fabsf(s.imu.acc[i] - prev.imu.acc[i]) > 0.05f * TEST_G;
+            jumps += fabsf(s.imu.gyr[i] - prev.imu.gyr[i]) > 2.0f;
+        }
+    }
+    if (shock > 1)
+    {
+        const float expect = 1.0f + SHOCK_G * sinf(3.14159265f * (float)shock / (SHOCK_SAMPLES + 1));
+        if (fabsf(s.imu.acc[2] / TEST_G - expect) > 0.05f)
+        {
+            printf("shock sample %d: %.3f g at +-%u g, expected %.3f g\n", shock, s.imu.acc[2] / TEST_G,
+                   2u << s.range.accel, expect);
+            shock_errors++;
+        }
+    }
+    prev = s;
+}
+
+static void print_sensor(const char *name, const autorange_sensor_t *as, unsigned base)
+{
+    printf("%s: +-%u, %u switches, %u clips (%u samples), dwell", name, base << as->range,
+           (unsigned)as->switches, (unsigned)as->clips, (unsigned)as->clipped);
+    for (int i = 0; i < AUTORANGE_RANGES; i++)
+    {
+        printf(" %u", (unsigned)as->dwell[i]);
+    }
+    printf("\n");
+}
+
+int main(void)
+{
+    const imu_backend_config_t cfg = {
+        .rate_hz = 100, .accel_range_g = 2, .gyro_range_dps = 2000, .fifo = false,
+    };
+    imu_t imu;
+    uint32_t failed = 0;
+
+    uart_tx_init(&huart2);
+    if (imu_init(&imu) != 0 || imu_configure(&cfg) != 0)
+    {
+        return 1;
+    }
+
+    autorange_config.hold_ms = 200;
+    capture_config.threshold = 2.0f;
+    if (autorange_enable() != 0 || capture_enable() != 0)
+    {
+        printf("enable failed\n");
+        return 1;
+    }
+
+    for (int i = 0; i < 100; i++)
+    {
+        step(0);
+    }
+    imu_backend_sim_shock(SHOCK_G, SHOCK_SAMPLES);
+    for (int i = 1; i <= SHOCK_SAMPLES + 1; i++)
+    {
+        step(i);
+    }
+    for (int i = 0; i < 100; i++)
+    {
+        step(0);
+    }
+
+    autorange_summary_t as;
+    capture_summary_t cs;
+    autorange_get_summary(&as);
+    capture_get_summary(&cs);
+    print_sensor("acc", &as.accel, 2);
+    print_sensor("gyr", &as.gyro, 250);
+    printf("%u tag changes, %u jumps, %u shock errors, %u failed\n", (unsigned)tag_changes,
+           (unsigned)jumps, (unsigned)shock_errors, (unsigned)as.failed);
+    printf("capture %s at sample %u, peak %.2f g\n", capture_trigger_name(cs.trigger),
+           (unsigned)cs.trigger_sample, cs.peak);
+
+    failed += jumps + shock_errors + as.failed;
+    failed += (as.accel.clips != 1 || as.accel.switches != 4 || as.accel.range != 0);
+    failed += (as.gyro.clips != 0 || as.gyro.switches != 3 || as.gyro.range != 0);
+    failed += (tag_changes != as.accel.switches + as.gyro.switches);
+    failed += (cs.state != CAPTURE_FROZEN || fabsf(cs.peak - (1.0f + SHOCK_G)) > 0.1f);
+
+    printf("%s\n", (failed == 0) ? "PASS" : "FAIL");
+    return (failed == 0) ? 0 : 1;
+}
@@ -0,0 +1,40 @@
+/*
+ * dsp_bench_main.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: halvard
+ *
+ *  Description: host runner for the CMSIS-DSP benchmark table
+ *
+ *      ./dsp_bench [reps]
+ *
+ *  Same table as `bench dsp` on target. Cycle figures are host wall time
+ *  scaled to 72 MHz, useful for ranking variants, not as target numbers.
+ */
+
+#include "main.h"
+#include "usart.h"
+#include "uart_tx.h"
+#include "timer_module.h"
+#include "dsp_bench.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+static void bench_out(const char *s)
+{
+    uart_tx_write((const uint8_t *)s, (uint16_t)strlen(s));
+}
+
+int main(int argc, char *argv[])
+{
+    uint32_t reps = (argc > 1) ? (uint32_t)atoi(argv[1]) : 0;
+
+    timer_module_init();
+    uart_tx_init(&huart2);
+
+    int res = dsp_bench_run(bench_out, reps);
+
+    uart_tx_flush();
+    return res;
+}
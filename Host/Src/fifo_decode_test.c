@@ -0,0 +1,207 @@
+/*
+ * fifo_decode_test.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: halvard
+ *
+ *  Description: host test of the word-wise FIFO packet decoder
+ *
+ *      ./fifo_decode_test
+ *
+ *  Random packets are decoded by fifo_decode_*() and by the driver's
+ *  byte-wise expressions, which must agree bit for bit:
+ *
+ *  - 12-byte raw frames and DMP packets with every combination of fields,
+ *    at every buffer alignment, into SoA arrays and the driver's [3] rows;
+ *  - elements of fields a packet doesn't carry are left as they were;
+ *  - end to end, mpu6050_read() and the backend drain on frames pushed into
+ *    the register model's FIFO.
+ *
+ *  Exits 0 if all of that holds.
+ */
+
+#include "fifo_decode.h"
+#include "driver_mpu6050_basic.h"
+#include "imu.h"
+#include "imu_backend_mpu6050.h"
+#include "mpu6050_sim.h"
+#include "timer_module.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define FRAMES      24
+#define SENTINEL    0x5A5A
+
+static uint32_t failed;
+
+/**
+ * @brief The driver's expressions (mpu6050_read(), mpu6050_dmp_read()).
+ */
+static int16_t ref16(const uint8_t *p)
+{
+    return (int16_t)((uint16_t)p[0] << 8) | p[1];
+}
+
+static int32_t ref32(const uint8_t *p)
+{
+    return ((int32_t)p[0] << 24) | ((int32_t)p[1] << 16) | ((int32_t)p[2] << 8) | p[3];
+}
+
+static void fill(uint8_t *buf, size_t len)
+{
+    for (size_t i = 0; i < len; i++)
+    {
+        buf[i] = (uint8_t)rand();
+    }
+}
+
+/**
+ * @brief Decodes frames of buf with the given layout both ways and counts
+ * the elements that differ. fields 0 is a raw frame.
+ */
+static uint32_t compare(const uint8_t *buf, uint16_t frames, uint8_t fields, uint16_t stride)
+{
+    static int16_t acc[3][FRAMES * 3], gyr[3][FRAMES * 3];
+    static int32_t quat[4][FRAMES * 4];
+    const uint16_t quat_stride = (stride == 1) ? 1 : 4;
+    const uint16_t len = fields ? fifo_dmp_packet_bytes(fields) : FIFO_RAW_FRAME_BYTES;
+    const uint8_t motion = fields ? fields : (FIFO_DMP_ACCEL | FIFO_DMP_GYRO);
+    uint32_t diff = 0;
+
+    // Rows of the driver's int16_t (*)[3] are the same array at stride 3
+    fifo_out_t out = {.stride = stride, .quat_stride = quat_stride};
+    for (int c = 0; c < 3; c++)
+    {
+        for (int i = 0; i < FRAMES * 3; i++)
+        {
+            acc[c][i] = gyr[c][i] = SENTINEL;
+        }
+        out.acc[c] = (stride == 1) ? acc[c] : &acc[0][c];
+        out.gyr[c] = (stride == 1) ? gyr[c] : &gyr[0][c];
+    }
+    for (int c = 0; c < 4; c++)
+    {
+        for (int i = 0; i < FRAMES * 4; i++)
+        {
+            quat[c][i] = SENTINEL;
+        }
+        out.quat[c] = (stride == 1) ? quat[c] : &quat[0][c];
+    }
+
+    if (fields)
+    {
+        fifo_decode_dmp(buf, frames, fields, &out);
+    }
+    else
+    {
+        fifo_decode_raw(buf, frames, &out);
+    }
+
+    for (uint16_t j = 0; j < frames; j++)
+    {
+        const uint8_t *p = buf + len * j;
+        if (fields & FIFO_DMP_QUAT)
+        {
+            for (int c = 0; c < 4; c++)
+            {
+                diff += (out.quat[c][j * quat_stride] != ref32(p + 4 * c));
+            }
+            p += 16;
+        }
+        for (int c = 0; c < 3; c++)
+        {
+            const int16_t a = (motion & FIFO_DMP_ACCEL) ? ref16(p + 2 * c) : (int16_t)SENTINEL;
+            diff += (out.acc[c][j * stride] != a);
+        }
+        p += (motion & FIFO_DMP_ACCEL) ? 6 : 0;
+        for (int c = 0; c < 3; c++)
+        {
+            const int16_t g = (motion & FIFO_DMP_GYRO) ? ref16(p + 2 * c) : (int16_t)SENTINEL;
+            diff += (out.gyr[c][j * stride] != g);
+        }
+        if (!(fields & FIFO_DMP_QUAT))
+        {
+            for (int c = 0; c < 4; c++)
+            {
+                diff += (out.quat[c][j * quat_stride] != SENTINEL);
+            }
+        }
+    }
+    return diff;
+}
+
+int main(void)
+{
+    static uint8_t mem[FRAMES * 32 + 4];
+    imu_t imu;
+
+    srand(98);
+
+    // Every layout, alignment and stride, frames 1..FRAMES
+    uint32_t layouts = 0, diff = 0;
+    for (uint8_t fields = 0; fields < 16; fields++)
+    {
+        for (int offset = 0; offset < 4; offset++)
+        {
+            for (uint16_t frames = 1; frames <= FRAMES; frames++)
+            {
+                fill(mem, sizeof(mem));
+                diff += compare(mem + offset, frames, fields, 1);
+                diff += compare(mem + offset, frames, fields, 3);
+            }
+        }
+        layouts++;
+    }
+    printf("decode: %lu layouts, %lu differences\n", (unsigned long)layouts, (unsigned long)diff);
+    failed += (layouts != 16 || diff != 0);
+
+    // End to end through the driver and the backend
+    timer_module_init();
+    const imu_backend_config_t cfg = {
+        .rate_hz = 100, .accel_range_g = 2, .gyro_range_dps = 2000, .fifo = true,
+    };
+    if (imu_init(&imu) != 0 || imu_configure(&cfg) != 0)
+    {
+        printf("init failed\n");
+        return 1;
+    }
+
+    uint8_t frames[FRAMES * FIFO_RAW_FRAME_BYTES];
+    int16_t accel_raw[FRAMES][3], gyro_raw[FRAMES][3];
+    float accel_g[FRAMES][3], gyro_dps[FRAMES][3];
+    uint16_t len = FRAMES;
+    fill(frames, sizeof(frames));
+    mpu6050_sim_fifo_push(frames, sizeof(frames));
+    uint32_t e2e = (mpu6050_read(mpu6050_basic_handle(), accel_raw, accel_g, gyro_raw, gyro_dps, &len) != 0 || len != FRAMES);
+    for (uint16_t j = 0; j < len; j++)
+    {
+        for (int c = 0; c < 3; c++)
+        {
+            e2e += (accel_raw[j][c] != ref16(&frames[j * 12 + 2 * c]));
+            e2e += (gyro_raw[j][c] != ref16(&frames[j * 12 + 6 + 2 * c]));
+            e2e += (accel_g[j][c] != (float)accel_raw[j][c] / 16384.0f);
+        }
+    }
+
+    imu_raw_t raw[FRAMES];
+    uint16_t count = 0;
+    fill(frames, sizeof(frames));
+    mpu6050_sim_fifo_push(frames, sizeof(frames));
+    e2e += (imu_backend_mpu6050_drain(raw, FRAMES, &count) != 0 || count != FRAMES);
+    for (uint16_t j = 0; j < count; j++)
+    {
+        for (int c = 0; c < 3; c++)
+        {
+            e2e += (raw[j].acc[c] != ref16(&frames[j * 12 + 2 * c]));
+            e2e += (raw[j].gyr[c] != ref16(&frames[j * 12 + 6 + 2 * c]));
+        }
+        e2e += (raw[j].temp != 0);
+    }
+    printf("fifo: %u + %u frames, %lu differences\n", (unsigned)len, (unsigned)count, (unsigned long)e2e);
+    failed += (e2e != 0);
+
+    printf("%s\n", (failed == 0) ? "PASS" : "FAIL");
+    return (failed == 0) ? 0 : 1;
+}
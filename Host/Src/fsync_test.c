@@ -0,0 +1,119 @@
+/*
+ * fsync_test.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: halvard
+ *
+ *  Description: host test of FSYNC sample tagging and edge timestamps
+ *
+ *      ./fsync_test
+ *
+ *  The register model latches an FSYNC edge into the TEMP_OUT_L LSB of the
+ *  next sample, the test calls fsync_edge() where the EXTI interrupt would:
+ *
+ *  - an edge 3 ms before a read tags exactly that sample, and the sync
+ *    event carries its sample number and a read - edge of 3 ms;
+ *  - a tag with no MCU edge is an orphan (edge 0);
+ *  - an MCU edge with no tag is dropped as missed after two periods;
+ *  - with FSYNC off no sample is tagged.
+ *
+ *  Exits 0 if all of that holds.
+ */
+
+#include "fsync.h"
+#include "imu.h"
+#include "imu_sample.h"
+#include "main.h"
+#include "mpu6050_sim.h"
+#include "timer_module.h"
+
+#include <stdio.h>
+
+static uint32_t failed;
+
+/**
+ * @brief One 10 ms sample; an edge, if any, comes `edge_ms` before the read.
+ * @return fsync_process() result
+ */
+static int step(bool mcu_edge, bool chip_edge, uint32_t edge_ms)
+{
+    static const int16_t accel[3] = {0, 0, 16384};
+    static const int16_t gyro[3] = {0, 0, 0};
+    imu_t imu;
+
+    HAL_Delay(10 - edge_ms);
+    if (mcu_edge)
+    {
+        fsync_edge(DWT->CYCCNT);
+    }
+    if (chip_edge)
+    {
+        mpu6050_sim_fsync();
+    }
+    HAL_Delay(edge_ms);
+    mpu6050_sim_set_raw(accel, 1000, gyro);
+    if (imu_process(&imu) != 0)
+    {
+        printf("sample read failed\n");
+        failed++;
+        return 0;
+    }
+    return fsync_process(&imu);
+}
+
+static uint32_t run(int samples, bool mcu_edge, bool chip_edge)
+{
+    uint32_t events = 0;
+    for (int i = 0; i < samples; i++)
+    {
+        events += step(mcu_edge && i == 0, chip_edge && i == 0, 3);
+    }
+    return events;
+}
+
+int main(void)
+{
+    imu_t imu;
+    fsync_reader_t reader;
+    fsync_event_t ev;
+    fsync_summary_t s;
+    imu_sample_stats_t stats;
+
+    timer_module_init();
+    if (imu_init(&imu) != 0 || fsync_enable() != 0)
+    {
+        printf("init failed\n");
+        return 1;
+    }
+    fsync_reader_init(&reader);
+
+    // Matched edge
+    run(5, false, false);
+    imu_sample_get_stats(&stats);
+    const uint32_t expect = stats.published + 1;
+    const uint32_t matched = run(5, true, true);
+    const int got = (fsync_read(&reader, &ev) == 0);
+    const float us = got ? (float)(ev.read - ev.edge) / (HOST_CORE_CLOCK_HZ / 1000000u) : 0.0f;
+    printf("edge: %lu events, sample %lu (expected %lu), %.0f us before read\n", (unsigned long)matched,
+           got ? (unsigned long)ev.sample : 0ul, (unsigned long)expect, us);
+    failed += (matched != 1 || !got || ev.sample != expect || ev.edge == 0 || us < 2900.0f || us > 3500.0f);
+
+    // Tag without an MCU edge, MCU edge without a tag
+    const uint32_t orphan = run(3, false, true);
+    const int orphan_got = (fsync_read(&reader, &ev) == 0);
+    failed += (orphan != 1 || !orphan_got || ev.edge != 0);
+    const uint32_t missed = run(3, true, false);
+    fsync_get_summary(&s);
+    printf("edges %lu, events %lu, missed %lu, orphans %lu\n", (unsigned long)s.edges, (unsigned long)s.events,
+           (unsigned long)s.missed, (unsigned long)s.orphans);
+    failed += (missed != 0 || s.edges != 2 || s.events != 2 || s.missed != 1 || s.orphans != 1);
+
+    // Disabled: the chip stops tagging
+    fsync_disable();
+    const uint32_t off = run(3, false, true);
+    printf("disabled: %lu events, temp lsb %u\n", (unsigned long)off, (unsigned)(mpu6050_sim_peek(0x42) & 1));
+    failed += (off != 0 || (mpu6050_sim_peek(0x42) & 1) != 0);
+
+    printf("%s\n", (failed == 0) ? "PASS" : "FAIL");
+    return (failed == 0) ? 0 : 1;
+}
@@ -0,0 +1,196 @@
+/*
+ * hal_shim.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: halvard
+ *
+ *  Description: host implementation of the HAL subset in Host/Inc/stm32f1xx_hal.h
+ *
+ *  Time is the monotonic host clock plus a virtual offset that HAL_Delay()
+ *  and host_advance_us() add to, so blocking waits in the driver cost
+ *  nothing while DWT-based measurements still see real elapsed time.
+ *  HOST_CLOCK_PPM=<n> in the environment makes that clock run n ppm fast
+ *  (negative: slow), like an off-nominal crystal, for the time sync.
+ *  HOST_CLOCK=virtual leaves the host clock out: time only moves through
+ *  HAL_Delay() and host_advance_us(), code costs nothing, and tests that
+ *  check exact intervals or phase times don't see scheduler jitter.
+ */
+
+#include "stm32f1xx_hal.h"
+#include "usart.h"
+#include "i2c.h"
+#include "mpu6050_sim.h"
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// Peripheral handles normally defined by the Cube generated sources
+UART_HandleTypeDef huart2;
+I2C_HandleTypeDef hi2c1;
+
+uint32_t SystemCoreClock = HOST_CORE_CLOCK_HZ;
+CoreDebug_Type host_core_debug;
+volatile uint32_t host_primask = 0;
+volatile uint32_t host_ipsr = 0;
+
+static DWT_Type host_dwt;
+static uint64_t host_dwt_last_cycles = 0;
+static uint64_t host_epoch_ns = 0;
+static uint64_t host_virtual_ns = 0;
+static int64_t host_clock_ppm = 0;
+static bool host_clock_virtual = false;
+
+static void host_uart_stdout(const uint8_t *data, uint16_t len)
+{
+    fwrite(data, 1, len, stdout);
+    fflush(stdout);
+}
+
+static host_uart_sink_t host_uart_sink = host_uart_stdout;
+
+static uint64_t host_now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    uint64_t now = (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+
+    if (host_epoch_ns == 0)
+    {
+        const char *ppm = getenv("HOST_CLOCK_PPM");
+        const char *clock = getenv("HOST_CLOCK");
+        host_clock_ppm = (ppm != NULL) ? strtoll(ppm, NULL, 10) : 0;
+        host_clock_virtual = (clock != NULL && strcmp(clock, "virtual") == 0);
+        host_epoch_ns = now;
+    }
+    if (host_clock_virtual)
+    {
+        return host_virtual_ns;
+    }
+    const int64_t real = (int64_t)(now - host_epoch_ns);
+    return (uint64_t)(real + real * host_clock_ppm / 1000000) + host_virtual_ns;
+}
+
+DWT_Type *host_dwt_sync(void)
+{
+    uint64_t cycles = host_now_ns() * (HOST_CORE_CLOCK_HZ / 1000000U) / 1000U;
+
+    // Only a running counter advances, and a written value acts as offset
+    if (host_dwt.CTRL & DWT_CTRL_CYCCNTENA_Msk)
+    {
+        host_dwt.CYCCNT += (uint32_t)(cycles - host_dwt_last_cycles);
+    }
+    host_dwt_last_cycles = cycles;
+
+    return &host_dwt;
+}
+
+void host_advance_us(uint64_t us)
+{
+    host_virtual_ns += us * 1000U;
+}
+
+uint32_t HAL_GetTick(void)
+{
+    return (uint32_t)(host_now_ns() / 1000000U);
+}
+
+void HAL_Delay(uint32_t Delay)
+{
+    host_advance_us((uint64_t)Delay * 1000U);
+}
+
+void Error_Handler(void)
+{
+    fprintf(stderr, "Error_Handler called\n");
+    exit(1);
+}
+
+// =============================================================================
+// I2C
+// =============================================================================
+
+HAL_StatusTypeDef HAL_I2C_Mem_Read(I2C_HandleTypeDef *hi2c, uint16_t DevAddress,
+                                   uint16_t MemAddress, uint16_t MemAddSize,
+                                   uint8_t *pData, uint16_t Size, uint32_t Timeout)
+{
+    (void)Timeout;
+
+    if (hi2c == NULL || pData == NULL || MemAddSize != I2C_MEMADD_SIZE_8BIT)
+    {
+        return HAL_ERROR;
+    }
+    if (DevAddress != MPU6050_SIM_ADDRESS)
+    {
+        hi2c->ErrorCode = 0x04U;   // HAL_I2C_ERROR_AF, nobody acked
+        return HAL_ERROR;
+    }
+
+    return mpu6050_sim_read((uint8_t)MemAddress, pData, Size) == 0 ? HAL_OK : HAL_ERROR;
+}
+
+HAL_StatusTypeDef HAL_I2C_Mem_Write(I2C_HandleTypeDef *hi2c, uint16_t DevAddress,
+                                    uint16_t MemAddress, uint16_t MemAddSize,
+                                    uint8_t *pData, uint16_t Size, uint32_t Timeout)
+{
+    (void)Timeout;
+
+    if (hi2c == NULL || pData == NULL || MemAddSize != I2C_MEMADD_SIZE_8BIT)
+    {
+        return HAL_ERROR;
+    }
+    if (DevAddress != MPU6050_SIM_ADDRESS)
+    {
+        hi2c->ErrorCode = 0x04U;
+        return HAL_ERROR;
+    }
+
+    return mpu6050_sim_write((uint8_t)MemAddress, pData, Size) == 0 ? HAL_OK : HAL_ERROR;
+}
+
+// =============================================================================
+// UART
+// =============================================================================
+
+void host_uart_set_sink(host_uart_sink_t sink)
+{
+    host_uart_sink = (sink != NULL) ? sink : host_uart_stdout;
+}
+
+HAL_StatusTypeDef HAL_UART_Transmit(UART_HandleTypeDef *huart, const uint8_t *pData,
+                                    uint16_t Size, uint32_t Timeout)
+{
+    (void)Timeout;
+
+    if (huart == NULL || pData == NULL || Size == 0)
+    {
+        return HAL_ERROR;
+    }
+    host_uart_sink(pData, Size);
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_UART_Transmit_IT(UART_HandleTypeDef *huart, const uint8_t *pData,
+                                       uint16_t Size)
+{
+    if (huart == NULL || pData == NULL || Size == 0)
+    {
+        return HAL_ERROR;
+    }
+    host_uart_sink(pData, Size);
+
+    // Completion "interrupt" runs in handler mode, like on target
+    uint32_t ipsr = host_ipsr;
+    host_ipsr = 38U + 16U;   // USART2_IRQn + 16
+    HAL_UART_TxCpltCallback(huart);
+    host_ipsr = ipsr;
+
+    return HAL_OK;
+}
+
+__attribute__((weak)) void HAL_UART_TxCpltCallback(UART_HandleTypeDef *huart)
+{
+    (void)huart;
+}
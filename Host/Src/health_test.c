@@ -0,0 +1,127 @@
+/*
+ * health_test.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: halvard
+ *
+ *  Description: host test of the sensor-health checks
+ *
+ *      ./health_test
+ *
+ *  A sensor at rest with a few LSB of noise is read every 10 ms through
+ *  imu_process(), then faults are injected one at a time:
+ *
+ *  - healthy: after learning no sample is flagged;
+ *  - stuck: the gyro z register freezes, flagged after hltstuck samples;
+ *  - saturated: one accel sample at the rail;
+ *  - noise: the accel noise grows 8 times, the floor leaves the band;
+ *  - rate: one read comes 30 ms late.
+ *
+ *  Each phase prints the samples it flagged and the channels; exits 0 if
+ *  every fault is flagged where it was injected and nowhere else.
+ */
+
+#include "health.h"
+#include "imu.h"
+#include "main.h"
+#include "mpu6050_sim.h"
+#include "timer_module.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+static uint32_t failed;
+
+static int16_t noise(int amp)
+{
+    return (int16_t)(rand() % (2 * amp + 1) - amp);
+}
+
+/**
+ * @brief Reads n samples, returns how many had any of the flags.
+ * @param acc_amp Accel noise, LSB
+ * @param gz      Gyro z register, or INT16_MIN for noise
+ */
+static uint32_t run(imu_t *imu, uint32_t n, uint8_t flags, int acc_amp, int32_t gz)
+{
+    uint32_t hits = 0;
+    for (uint32_t i = 0; i < n; i++)
+    {
+        const int16_t accel[3] = {noise(acc_amp), noise(acc_amp), (int16_t)(16384 + noise(acc_amp))};
+        const int16_t gyro[3] = {noise(4), noise(4), (gz == INT16_MIN) ? noise(4) : (int16_t)gz};
+        mpu6050_sim_set_raw(accel, 0, gyro);
+        HAL_Delay(10);
+        imu_process(imu);
+        hits += ((imu->health & flags) != 0);
+    }
+    return hits;
+}
+
+static void expect(const char *name, uint32_t hits, uint32_t min, uint32_t max)
+{
+    health_summary_t hs;
+    health_get_summary(&hs);
+    printf("%s: %lu flagged, stuck 0x%02X noise 0x%02X, %lu late\n", name, (unsigned long)hits,
+           hs.stuck_mask, hs.noise_mask, (unsigned long)hs.late);
+    failed += (hits < min || hits > max);
+}
+
+int main(void)
+{
+    imu_t imu;
+
+    srand(99);
+    timer_module_init();
+    if (imu_init(&imu) != 0)
+    {
+        printf("init failed\n");
+        return 1;
+    }
+
+    // Learning, then quiet
+    uint32_t hits = run(&imu, health_config.learn, IMU_HEALTH_LEARNING, 8, INT16_MIN);
+    failed += (hits != (uint32_t)health_config.learn);
+    hits = run(&imu, 200, 0xFF, 8, INT16_MIN);
+    expect("healthy", hits, 0, 0);
+
+    // Stuck: flagged from the hltstuck-th unchanged sample on
+    hits = run(&imu, 100, IMU_HEALTH_STUCK, 8, 5);
+    expect("stuck", hits, 100 - health_config.stuck, 100 - health_config.stuck);
+    health_summary_t hs;
+    health_get_summary(&hs);
+    failed += (hs.stuck_mask != (1u << 5) || hs.channel[5].stuck != 1);
+    run(&imu, 50, 0, 8, INT16_MIN);
+
+    // Saturated: one sample, on NED y (sensor x)
+    const int16_t rail[3] = {32767, 0, 16384};
+    const int16_t still[3] = {1, 2, 3};
+    mpu6050_sim_set_raw(rail, 0, still);
+    HAL_Delay(10);
+    imu_process(&imu);
+    hits = (imu.health & IMU_HEALTH_SATURATED) != 0;
+    hits += run(&imu, 10, IMU_HEALTH_SATURATED, 8, INT16_MIN);
+    health_get_summary(&hs);
+    expect("saturated", hits, 1, 1);
+    failed += (hs.channel[1].saturated != 1);
+
+    // Noise: 8x the accel noise
+    hits = run(&imu, 100, IMU_HEALTH_NOISE, 64, INT16_MIN);
+    health_get_summary(&hs);
+    expect("noise", hits, 50, 100);
+    failed += ((hs.noise_mask & 0x07) != 0x07 || (hs.noise_mask & 0x38) != 0);
+    run(&imu, 300, 0, 8, INT16_MIN);
+
+    // Rate: one read 30 ms late
+    HAL_Delay(30);
+    hits = run(&imu, 20, IMU_HEALTH_RATE, 8, INT16_MIN);
+    health_get_summary(&hs);
+    expect("rate", hits, 1, 1);
+    failed += (hs.late != 1 || hs.early != 0 || hs.interval_us != 10000);
+
+    // Everything clears again
+    hits = run(&imu, 100, 0xFF, 8, INT16_MIN);
+    expect("recovered", hits, 0, 0);
+
+    printf("%s\n", (failed == 0) ? "PASS" : "FAIL");
+    return (failed == 0) ? 0 : 1;
+}
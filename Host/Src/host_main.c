@@ -0,0 +1,159 @@
+/*
+ * host_main.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: halvard
+ *
+ *  Description: host entry point running the firmware main loop on stdio
+ *
+ *  stdin stands in for the USART2 RX DMA ring (bytes are written into
+ *  dma_buffer and CNDTR counts down like the circular DMA channel) and the
+ *  console goes to stdout through uart_tx. The IMU is the simulated MPU6050
+ *  (f103rb_host_sim: the synthetic IMU_BACKEND_SIM instead).
+ *  Runs until stdin reaches EOF, so a script can be piped in:
+ *
+ *      printf 'status\r\nlist\r\n' | ./f103rb_host
+ *
+ *  An optional recording file stands in for the REPLAY flash slot, so the
+ *  `replay` command can drive the processing stages from the CLI:
+ *
+ *      printf 'anc on\r\nreplay\r\nanc\r\n' | ./f103rb_host rec.imur
+ */
+
+#include "main.h"
+#include "usart.h"
+#include "uart_tx.h"
+#include "boot.h"
+#include "imu.h"
+#include "imu_replay.h"
+#include "pipeline.h"
+#include "cli.h"
+#include "cli_impl.h"
+#include "util.h"
+
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+uint8_t dma_buffer[DMA_BUFFER_SIZE];
+volatile uint16_t offset = 0;
+DMA_HandleTypeDef hdma_usart2_rx;
+
+static DMA_Channel_TypeDef host_rx_channel = { .CNDTR = DMA_BUFFER_SIZE };
+
+static void cli_start(void)
+{
+    cli_user_init(dma_buffer, DMA_BUFFER_SIZE, &hdma_usart2_rx.Instance->CNDTR);
+}
+
+/**
+ * @brief Moves pending stdin bytes into the RX ring.
+ * @return 0 while stdin is open, 1 after EOF
+ */
+static int host_rx_pump(int timeout_ms)
+{
+    struct pollfd pfd = { .fd = STDIN_FILENO, .events = POLLIN };
+    if (poll(&pfd, 1, timeout_ms) <= 0)
+    {
+        return 0;
+    }
+
+    // cli_update() drains the ring every pass, so never hand it more than
+    // one lap at a time
+    uint8_t chunk[DMA_BUFFER_SIZE / 2];
+    ssize_t n = read(STDIN_FILENO, chunk, sizeof(chunk));
+    if (n <= 0)
+    {
+        return 1;
+    }
+
+    for (ssize_t i = 0; i < n; i++)
+    {
+        uint16_t pos = DMA_BUFFER_SIZE - host_rx_channel.CNDTR;
+        dma_buffer[pos] = chunk[i];
+        host_rx_channel.CNDTR = (pos + 1 == DMA_BUFFER_SIZE) ? DMA_BUFFER_SIZE : host_rx_channel.CNDTR - 1;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Loads a recording into the host replay slot.
+ * @return 0 on success, 1 if the file can't be read
+ */
+static int host_load_replay(const char *path)
+{
+    FILE *f = fopen(path, "rb");
+    if (f == NULL)
+    {
+        return 1;
+    }
+
+    fseek(f, 0, SEEK_END);
+    long len = ftell(f);
+    fseek(f, 0, SEEK_SET);
+
+    // Lives until exit, like the flash slot
+    uint8_t *image = (len > 0) ? malloc((size_t)len) : NULL;
+    int res = (image == NULL || fread(image, 1, (size_t)len, f) != (size_t)len);
+    fclose(f);
+
+    if (res == 0)
+    {
+        imu_replay_set_flash_slot(image, (size_t)len);
+    }
+    return res;
+}
+
+int main(int argc, char *argv[])
+{
+    hdma_usart2_rx.Instance = &host_rx_channel;
+
+    if (argc > 1 && host_load_replay(argv[1]) != 0)
+    {
+        fprintf(stderr, "%s: can't read recording\n", argv[1]);
+        return 1;
+    }
+
+    boot_start();
+    uart_tx_init(&huart2);
+    boot_mark("console");
+
+    boot_defer(cli_start);
+    imu_t imu;
+    if (imu_init(&imu) != 0)
+    {
+        return 1;
+    }
+    boot_run_deferred();
+    boot_mark("imu_init");
+
+    char boot_line[128];
+    boot_format(boot_line, sizeof(boot_line));
+    print("Initialized! %s\r\n", boot_line);
+
+    uint32_t last_time = HAL_GetTick();
+    int eof = 0;
+    while (!eof)
+    {
+        eof = host_rx_pump(1);
+        cli_update();
+
+        if (HAL_GetTick() - last_time < 10)
+        {
+            continue;
+        }
+        last_time += 10;
+
+        if (imu_process(&imu) != 0)
+        {
+            return 1;
+        }
+
+        pipeline_process(&imu);
+    }
+
+    uart_tx_flush();
+    return 0;
+}
@@ -0,0 +1,101 @@
+/*
+ * i2c_trace_test.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: halvard
+ *
+ *  Description: host test of the I2C transaction tracer
+ *
+ *      ./i2c_trace_test
+ *
+ *  Runs single driver calls against the register model and prints what
+ *  each one did on the bus, oldest transaction first:
+ *
+ *  - imu_process() is one 14-byte burst from ACCEL_XOUT_H;
+ *  - mpu6050_set_extern_sync() is a read-modify-write of CONFIG;
+ *  - a transfer nobody acks is recorded as an error.
+ *
+ *  The per-register table must add up to the ring. Exits 0 if all of that
+ *  holds.
+ */
+
+#include "i2c_trace.h"
+#include "driver_mpu6050_basic.h"
+#include "driver_mpu6050_interface.h"
+#include "imu.h"
+#include "timer_module.h"
+
+#include <stdio.h>
+
+static uint32_t failed;
+
+/**
+ * @brief Prints the transactions since the last clear and checks the count.
+ */
+static void expect(const char *name, uint32_t count)
+{
+    i2c_trace_summary_t ts;
+    i2c_trace_record_t r;
+
+    i2c_trace_get_summary(&ts);
+    printf("%s: %lu", name, (unsigned long)ts.count);
+    for (uint32_t age = ts.count; age-- > 0;)
+    {
+        if (i2c_trace_get_record(age, &r) == 0)
+        {
+            printf(" %s 0x%02X x%u%s", (r.flags & I2C_TRACE_WRITE) ? "wr" : "rd", r.reg, (unsigned)r.len,
+                   (r.flags & I2C_TRACE_ERROR) ? " error" : "");
+        }
+    }
+    printf("\n");
+    failed += (ts.count != count);
+    i2c_trace_clear();
+}
+
+int main(void)
+{
+    imu_t imu;
+    uint8_t buf[2];
+
+    timer_module_init();
+    if (imu_init(&imu) != 0)
+    {
+        printf("init failed\n");
+        return 1;
+    }
+
+    i2c_trace_clear();
+    imu_process(&imu);
+    expect("imu_process", 1);
+
+    mpu6050_set_extern_sync(mpu6050_basic_handle(), MPU6050_EXTERN_SYNC_TEMP_OUT_L);
+    mpu6050_set_extern_sync(mpu6050_basic_handle(), MPU6050_EXTERN_SYNC_INPUT_DISABLED);
+    expect("mpu6050_set_extern_sync x2", 4);
+
+    mpu6050_interface_iic_read(0xD2, 0x75, buf, 1);
+    i2c_trace_summary_t ts;
+    i2c_trace_get_summary(&ts);
+    failed += (ts.errors != 1);
+    expect("no ack", 1);
+
+    // Per-register totals against the ring
+    for (int i = 0; i < 5; i++)
+    {
+        imu_process(&imu);
+    }
+    mpu6050_set_extern_sync(mpu6050_basic_handle(), MPU6050_EXTERN_SYNC_INPUT_DISABLED);
+    i2c_trace_get_summary(&ts);
+    uint32_t count = 0, bytes = 0;
+    i2c_trace_stat_t st;
+    for (uint8_t i = 0; i2c_trace_get_stat(i, &st) == 0; i++)
+    {
+        printf("0x%02X %s %lu x %lu bytes\n", st.reg, st.write ? "wr" : "rd", (unsigned long)st.count,
+               (unsigned long)(st.bytes / st.count));
+        count += st.count;
+        bytes += st.bytes;
+    }
+    failed += (ts.regs != 3 || count != ts.count || bytes != ts.bytes || ts.count != 7 || ts.bytes != 72);
+
+    printf("%s\n", (failed == 0) ? "PASS" : "FAIL");
+    return (failed == 0) ? 0 : 1;
+}
@@ -0,0 +1,147 @@
+/*
+ * imu_event_test.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: halvard
+ *
+ *  Description: host test of the sensor event queue behind the driver callbacks
+ *
+ *      ./imu_event_test
+ *
+ *  - the MPU6050 interface callbacks queue tap, orientation, motion and
+ *    FIFO overflow events (and nothing for data ready), stamped with
+ *    HAL_GetTick();
+ *  - two readers see the same events independently, in order;
+ *  - a reader that falls more than the queue behind gets the newest
+ *    IMU_EVENT_QUEUE events and counts the rest as lost;
+ *  - without the DMP the pedometer poll queues nothing.
+ *
+ *  Exits 0 if all of that holds.
+ */
+
+#include "imu_event.h"
+#include "driver_mpu6050.h"
+#include "driver_mpu6050_interface.h"
+#include "main.h"
+
+#include <stdio.h>
+#include <string.h>
+
+static uint32_t failed;
+
+/**
+ * @return Timestamp of the event read
+ */
+static uint32_t expect_line(imu_event_reader_t *reader, const char *name, const char *want)
+{
+    imu_event_t ev;
+    char line[64];
+
+    if (imu_event_read(reader, &ev) != 0)
+    {
+        printf("%s: missing \"%s\"\n", name, want);
+        failed++;
+        return 0;
+    }
+    imu_event_format(&ev, line, sizeof(line));
+    // Skip the timestamp, checked separately
+    const char *text = strstr(line, " ms ");
+    if (text == NULL || strcmp(text + 4, want) != 0)
+    {
+        printf("%s: \"%s\", expected \"%s\"\n", name, line, want);
+        failed++;
+    }
+    return ev.tick;
+}
+
+static void test_callbacks(void)
+{
+    imu_event_reader_t cli, log;
+    imu_event_t ev;
+
+    imu_event_reader_init(&cli);
+    imu_event_reader_init(&log);
+    const uint32_t start = HAL_GetTick();
+
+    mpu6050_interface_dmp_tap_callback(2, MPU6050_DMP_TAP_Z_UP);
+    HAL_Delay(5);
+    mpu6050_interface_dmp_orient_callback(MPU6050_DMP_ORIENT_LANDSCAPE);
+    mpu6050_interface_receive_callback(MPU6050_INTERRUPT_DATA_READY);
+    mpu6050_interface_receive_callback(MPU6050_INTERRUPT_MOTION);
+    mpu6050_interface_receive_callback(MPU6050_INTERRUPT_FIFO_OVERFLOW);
+
+    imu_event_reader_t *readers[2] = {&cli, &log};
+    uint32_t tap = 0, orient = 0;
+    for (int r = 0; r < 2; r++)
+    {
+        const char *name = (r == 0) ? "cli" : "log";
+        tap = expect_line(readers[r], name, "tap z up x2");
+        orient = expect_line(readers[r], name, "orient landscape");
+        expect_line(readers[r], name, "motion");
+        expect_line(readers[r], name, "fifo overflow");
+        if (imu_event_read(readers[r], &ev) == 0)
+        {
+            printf("%s: unexpected event type %u\n", name, (unsigned)ev.type);
+            failed++;
+        }
+    }
+
+    // The orientation came 5 ms after the tap
+    if (tap - start > 1 || orient - tap < 5)
+    {
+        printf("timestamps: tap %lu ms, orient %lu ms after start\n", (unsigned long)(tap - start),
+               (unsigned long)(orient - start));
+        failed++;
+    }
+    printf("callbacks: %lu events queued, orient %lu ms after tap\n", (unsigned long)imu_event_count(),
+           (unsigned long)(orient - tap));
+}
+
+static void test_overflow(void)
+{
+    imu_event_reader_t slow;
+    imu_event_t ev;
+    uint32_t n = 0;
+    uint32_t next_value = 8;
+
+    imu_event_reader_init(&slow);
+    for (uint32_t i = 0; i < IMU_EVENT_QUEUE + 8; i++)
+    {
+        imu_event_push(IMU_EVENT_STEPS, 0, i);
+    }
+    while (imu_event_read(&slow, &ev) == 0)
+    {
+        if (ev.type != IMU_EVENT_STEPS || ev.value != next_value)
+        {
+            failed++;
+        }
+        next_value++;
+        n++;
+    }
+    printf("overflow: %lu read, %lu lost\n", (unsigned long)n, (unsigned long)slow.lost);
+    failed += (n != IMU_EVENT_QUEUE || slow.lost != 8);
+}
+
+static void test_steps_without_dmp(void)
+{
+    imu_event_reader_t reader;
+    imu_event_t ev;
+
+    imu_event_reader_init(&reader);
+    imu_event_config.step_ms = 1;
+    HAL_Delay(2);
+    imu_event_poll_steps();
+    const int none = (imu_event_read(&reader, &ev) != 0);
+    printf("pedometer without dmp: %s\n", none ? "no event" : "event");
+    failed += !none;
+}
+
+int main(void)
+{
+    test_callbacks();
+    test_overflow();
+    test_steps_without_dmp();
+
+    printf("%s\n", (failed == 0) ? "PASS" : "FAIL");
+    return (failed == 0) ? 0 : 1;
+}
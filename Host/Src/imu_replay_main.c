@@ -0,0 +1,87 @@
+/*
+ * imu_replay_main.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: halvard
+ *
+ *  Description: host runner for IMU recordings
+ *
+ *      ./imu_replay <recording.imur> [rt]
+ *
+ *  Plays the recording through imu_process() at max speed (or at the
+ *  recorded rate with "rt") and prints sample count, throughput and the
+ *  CRC-32 of the produced samples, the same line as `replay` on target.
+ */
+
+#include "main.h"
+#include "usart.h"
+#include "uart_tx.h"
+#include "timer_module.h"
+#include "imu_replay.h"
+#include "fmt.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static uint8_t *load_file(const char *path, size_t *size)
+{
+    FILE *f = fopen(path, "rb");
+    if (f == NULL)
+    {
+        return NULL;
+    }
+
+    fseek(f, 0, SEEK_END);
+    long len = ftell(f);
+    fseek(f, 0, SEEK_SET);
+
+    uint8_t *data = (len > 0) ? malloc((size_t)len) : NULL;
+    if (data != NULL && fread(data, 1, (size_t)len, f) != (size_t)len)
+    {
+        free(data);
+        data = NULL;
+    }
+    fclose(f);
+
+    *size = (size_t)len;
+    return data;
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc < 2)
+    {
+        fprintf(stderr, "usage: %s <recording.imur> [rt]\n", argv[0]);
+        return 2;
+    }
+
+    size_t size = 0;
+    uint8_t *image = load_file(argv[1], &size);
+    if (image == NULL || imu_replay_open(image, size) != 0)
+    {
+        fprintf(stderr, "%s: not a valid recording\n", argv[1]);
+        free(image);
+        return 1;
+    }
+
+    timer_module_init();
+    uart_tx_init(&huart2);
+
+    imu_replay_pace_t pace = (argc > 2 && strcmp(argv[2], "rt") == 0) ? IMU_REPLAY_REALTIME : IMU_REPLAY_MAX_SPEED;
+    imu_replay_stats_t stats;
+    imu_t imu;
+    int res = imu_replay_run(&imu, pace, NULL, NULL, &stats);
+    imu_replay_close();
+
+    char line[96];
+    fmt_snprintf(line, sizeof(line), "%lu samples in %lu us, %lu samples/s, crc32 0x%08lx%s\r\n",
+                 (unsigned long)stats.samples, (unsigned long)stats.elapsed_us,
+                 (unsigned long)stats.samples_per_s, (unsigned long)stats.crc,
+                 res != 0 ? " (aborted)" : "");
+    uart_tx_write((const uint8_t *)line, (uint16_t)strlen(line));
+    uart_tx_flush();
+
+    free(image);
+    return res;
+}
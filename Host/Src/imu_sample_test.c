@@ -0,0 +1,219 @@
+/*
+ * imu_sample_test.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: halvard
+ *
+ *  Description: host test of imu_sample publication under preemption
+ *
+ *      ./imu_sample_test [iterations]
+ *
+ *  The preemption hook runs the other side between any two copied words,
+ *  at random, the way an interrupt would:
+ *
+ *  - reader preempted: 0..3 publishes land inside a snapshot; every
+ *    snapshot must be one whole sample, no older than the latest one at
+ *    the call;
+ *  - writer preempted: snapshots taken inside a publish must return the
+ *    previous sample whole, without retrying;
+ *  - single buffer: the same preemption against a plain shared imu_sample_t,
+ *    to show the harness does catch torn reads.
+ *
+ *  Every published sample carries values derived from its sequence number,
+ *  so a mix of two samples is detectable word by word. Exits 0 if the
+ *  double buffer never tore and the single buffer did.
+ */
+
+#include "imu_sample.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static uint32_t rng = 2463534242u;
+static uint32_t published;          // seq of the latest publish
+static uint32_t torn;
+static uint32_t stale;
+static uint32_t nested;             // snapshots/publishes run from the hook
+
+static uint32_t next_random(void)
+{
+    rng ^= rng << 13;
+    rng ^= rng >> 17;
+    rng ^= rng << 5;
+    return rng;
+}
+
+static imu_t sample_of(uint32_t seq)
+{
+    imu_t imu;
+    memset(&imu, 0, sizeof(imu));
+    for (int i = 0; i < 3; i++)
+    {
+        imu.acc[i] = (float)(seq * 8 + i);
+        imu.gyr[i] = (float)(seq * 8 + 3 + i);
+    }
+    return imu;
+}
+
+static int sample_ok(const imu_sample_t *s)
+{
+    imu_t expect = sample_of(s->seq);
+    return memcmp(&s->imu, &expect, sizeof(expect)) == 0 && s->cycles == s->seq * 7;
+}
+
+static void publish(void)
+{
+    static const imu_range_t range = { .accel = 0, .gyro = 3 };
+    published++;
+    imu_t imu = sample_of(published);
+    imu_sample_publish(&imu, &range, published * 7);
+}
+
+// =============================================================================
+// Reader preempted by the writer
+// =============================================================================
+
+static void reader_hook(int writer)
+{
+    if (writer || (next_random() & 3) != 0)
+    {
+        return;
+    }
+    imu_sample_preempt_hook = NULL;     // the ISR runs to completion
+    for (uint32_t n = next_random() & 3; n > 0; n--)
+    {
+        publish();
+        nested++;
+    }
+    imu_sample_preempt_hook = reader_hook;
+}
+
+static void test_reader_preempted(uint32_t iterations)
+{
+    imu_sample_t s;
+
+    imu_sample_reset();
+    published = 0;
+    torn = stale = nested = 0;
+    publish();
+
+    imu_sample_preempt_hook = reader_hook;
+    for (uint32_t i = 0; i < iterations; i++)
+    {
+        const uint32_t latest = published;
+        if (imu_sample_snapshot(&s) != 0 || !sample_ok(&s))
+        {
+            torn++;
+        }
+        else if (s.seq < latest || s.seq > published)
+        {
+            stale++;
+        }
+    }
+    imu_sample_preempt_hook = NULL;
+
+    imu_sample_stats_t stats;
+    imu_sample_get_stats(&stats);
+    printf("reader preempted: %u snapshots, %u publishes inside, %u torn, %u stale, %u retries (max %u)\n",
+           (unsigned)iterations, (unsigned)nested, (unsigned)torn, (unsigned)stale,
+           (unsigned)stats.retries, (unsigned)stats.retries_max);
+}
+
+// =============================================================================
+// Writer preempted by a reader
+// =============================================================================
+
+static void writer_hook(int writer)
+{
+    if (!writer || (next_random() % 3) != 0)
+    {
+        return;
+    }
+    imu_sample_t s;
+    imu_sample_preempt_hook = NULL;
+    nested++;
+    // publish() counted the sample being written; the reader gets the one before
+    if (imu_sample_snapshot(&s) != 0 || !sample_ok(&s))
+    {
+        torn++;
+    }
+    else if (s.seq != published - 1)
+    {
+        stale++;
+    }
+    imu_sample_preempt_hook = writer_hook;
+}
+
+static void test_writer_preempted(uint32_t iterations)
+{
+    imu_sample_reset();
+    published = 0;
+    torn = stale = nested = 0;
+    publish();
+
+    imu_sample_preempt_hook = writer_hook;
+    for (uint32_t i = 0; i < iterations; i++)
+    {
+        publish();
+    }
+    imu_sample_preempt_hook = NULL;
+
+    imu_sample_stats_t stats;
+    imu_sample_get_stats(&stats);
+    printf("writer preempted: %u snapshots inside %u publishes, %u torn, %u stale, %u retries\n",
+           (unsigned)nested, (unsigned)iterations, (unsigned)torn, (unsigned)stale,
+           (unsigned)stats.retries);
+}
+
+// =============================================================================
+// Single buffer, same preemption
+// =============================================================================
+
+static imu_sample_t single;
+
+static void test_single_buffer(uint32_t iterations)
+{
+    torn = 0;
+    nested = 0;
+    for (uint32_t seq = 1; seq <= iterations; seq++)
+    {
+        imu_sample_t s = { .imu = sample_of(seq), .range = { .accel = 0, .gyro = 3 }, .seq = seq, .cycles = seq * 7 };
+        for (size_t w = 0; w < sizeof(s); w += sizeof(uint32_t))
+        {
+            memcpy((uint8_t *)&single + w, (const uint8_t *)&s + w, sizeof(uint32_t));
+            if ((next_random() % 3) == 0)
+            {
+                imu_sample_t copy = single;
+                nested++;
+                torn += !sample_ok(&copy);
+            }
+        }
+    }
+    printf("single buffer: %u snapshots inside %u writes, %u torn\n",
+           (unsigned)nested, (unsigned)iterations, (unsigned)torn);
+}
+
+int main(int argc, char *argv[])
+{
+    uint32_t iterations = (argc > 1) ? (uint32_t)atoi(argv[1]) : 100000;
+    uint32_t failed = 0;
+
+    test_reader_preempted(iterations);
+    failed += torn + stale;
+    test_writer_preempted(iterations);
+    failed += torn + stale;
+    imu_sample_stats_t stats;
+    imu_sample_get_stats(&stats);
+    failed += stats.retries;
+
+    test_single_buffer(iterations);
+    if (torn == 0)
+    {
+        printf("single buffer never tore, the test can't see tearing\n");
+        failed++;
+    }
+
+    printf("%s\n", (failed == 0) ? "PASS" : "FAIL");
+    return (failed == 0) ? 0 : 1;
+}
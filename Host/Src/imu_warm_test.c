@@ -0,0 +1,91 @@
+/*
+ * imu_warm_test.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: halvard
+ *
+ *  Description: host test of the MPU6050 warm-restart fast path
+ *
+ *      ./imu_warm_test
+ *
+ *  imu_init() is called again on the same register model, like after an
+ *  MCU-only reset (the warm image lives in RAM the reset doesn't clear):
+ *
+ *  - the first init is cold: device reset, full configuration, delays;
+ *  - the second finds the configuration unchanged and only attaches: the
+ *    id, two configuration bursts and the range cache, no writes, no
+ *    delay, and samples read as before;
+ *  - after a configuration change (sample rate divider) or a power cycle
+ *    of the sensor the next init is cold again.
+ *
+ *  Exits 0 if all of that holds.
+ */
+
+#include "imu.h"
+#include "imu_backend_mpu6050.h"
+#include "i2c_trace.h"
+#include "main.h"
+#include "mpu6050_sim.h"
+#include "timer_module.h"
+
+#include <math.h>
+#include <stdio.h>
+
+static uint32_t failed;
+
+/**
+ * @brief One init, checked for the path it took.
+ */
+static void init(const char *name, bool expect_warm)
+{
+    imu_t imu;
+    i2c_trace_summary_t ts;
+    uint32_t writes = 0;
+
+    i2c_trace_clear();
+    const uint32_t start = HAL_GetTick();
+    const int res = imu_init(&imu);
+    const uint32_t ms = HAL_GetTick() - start;
+    i2c_trace_get_summary(&ts);
+    i2c_trace_stat_t st;
+    for (uint8_t i = 0; i2c_trace_get_stat(i, &st) == 0; i++)
+    {
+        writes += st.write ? st.count : 0;
+    }
+
+    const bool warm = imu_backend_mpu6050_warm();
+    printf("%s: %s, %lu ms, %lu transactions, %lu writes\n", name, warm ? "warm" : "cold", (unsigned long)ms,
+           (unsigned long)ts.count, (unsigned long)writes);
+    failed += (res != 0 || warm != expect_warm);
+    failed += warm ? (ms > 2 || writes != 0) : (ms < 100 || writes == 0);
+
+    // Samples come through as before either way (sensor x is NED y)
+    const int16_t accel[3] = {0, 0, 16384};
+    const int16_t gyro[3] = {164, 0, 0};
+    mpu6050_sim_set_raw(accel, 0, gyro);
+    if (imu_process(&imu) != 0 || fabsf(fabsf(imu.acc[2]) - 9.81f) > 0.1f || fabsf(imu.gyr[1] - 10.0f) > 0.01f)
+    {
+        printf("%s: sample %.2f m/s^2 %.2f dps\n", name, imu.acc[2], imu.gyr[1]);
+        failed++;
+    }
+}
+
+int main(void)
+{
+    timer_module_init();
+
+    init("power-up", false);
+    init("mcu reset", true);
+    init("mcu reset", true);
+
+    const uint8_t div = 9;
+    mpu6050_sim_write(0x19, &div, 1);
+    init("changed rate", false);
+
+    mpu6050_sim_reset();
+    init("power cycle", false);
+    init("mcu reset", true);
+
+    printf("%s\n", (failed == 0) ? "PASS" : "FAIL");
+    return (failed == 0) ? 0 : 1;
+}
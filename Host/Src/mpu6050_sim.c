@@ -0,0 +1,276 @@
+/*
+ * mpu6050_sim.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: halvard
+ *
+ *  Description: MPU6050 register model behind the host I2C shim
+ */
+
+#include "mpu6050_sim.h"
+
+#include <string.h>
+
+#define REG_ACCEL_XOUT_H    0x3B
+#define REG_INT_STATUS      0x3A
+#define REG_CONFIG          0x1A
+#define REG_FIFO_EN         0x23
+#define REG_SIGNAL_PATH_RST 0x68
+#define REG_USER_CTRL       0x6A
+#define REG_PWR_MGMT_1      0x6B
+#define REG_BANK_SEL        0x6D
+#define REG_MEM_START_ADDR  0x6E
+#define REG_MEM_R_W         0x6F
+#define REG_FIFO_COUNTH     0x72
+#define REG_FIFO_COUNTL     0x73
+#define REG_FIFO_R_W        0x74
+#define REG_WHO_AM_I        0x75
+
+#define REG_COUNT           0x80
+#define DMP_MEM_SIZE        (8 * 256)
+
+#define USER_CTRL_FIFO_EN    (1 << 6)
+#define USER_CTRL_FIFO_RESET (1 << 2)
+#define USER_CTRL_SELF_CLEAR 0x0F   // DMP, FIFO, I2C master and sig cond resets
+#define PWR_MGMT_1_RESET     (1 << 7)
+#define INT_STATUS_FIFO_OFLOW (1 << 4)
+
+static uint8_t sim_regs[REG_COUNT];
+static uint8_t sim_dmp_mem[DMP_MEM_SIZE];
+static uint8_t sim_fifo[MPU6050_SIM_FIFO_SIZE];
+static uint16_t sim_fifo_head = 0;   // read position
+static uint16_t sim_fifo_count = 0;
+static int sim_ready = 0;
+static int sim_fsync = 0;           // FSYNC edge latched since the last sample
+
+static void sim_power_on(void)
+{
+    // The outputs keep following the (simulated) physical input over a reset
+    uint8_t outputs[14];
+    memcpy(outputs, &sim_regs[REG_ACCEL_XOUT_H], sizeof(outputs));
+    memset(sim_regs, 0, sizeof(sim_regs));
+    memcpy(&sim_regs[REG_ACCEL_XOUT_H], outputs, sizeof(outputs));
+    sim_regs[REG_PWR_MGMT_1] = 0x40;   // sleep
+    sim_regs[REG_WHO_AM_I] = 0x68;
+    sim_fifo_head = 0;
+    sim_fifo_count = 0;
+    sim_fsync = 0;
+}
+
+static void sim_ensure_ready(void)
+{
+    if (!sim_ready)
+    {
+        mpu6050_sim_reset();
+    }
+}
+
+static void sim_store_be16(uint8_t reg, int16_t value)
+{
+    sim_regs[reg] = (uint8_t)((uint16_t)value >> 8);
+    sim_regs[reg + 1] = (uint8_t)value;
+}
+
+void mpu6050_sim_reset(void)
+{
+    static const int16_t accel[3] = {0, 0, 16384};
+    static const int16_t gyro[3] = {0, 0, 0};
+
+    sim_ready = 1;
+    sim_power_on();
+    memset(sim_dmp_mem, 0, sizeof(sim_dmp_mem));
+    mpu6050_sim_set_raw(accel, 0, gyro);
+}
+
+uint16_t mpu6050_sim_fifo_push(const uint8_t *data, uint16_t len)
+{
+    sim_ensure_ready();
+
+    uint16_t accepted = 0;
+    while (accepted < len && sim_fifo_count < MPU6050_SIM_FIFO_SIZE)
+    {
+        sim_fifo[(sim_fifo_head + sim_fifo_count) % MPU6050_SIM_FIFO_SIZE] = data[accepted];
+        sim_fifo_count++;
+        accepted++;
+    }
+    if (accepted < len)
+    {
+        sim_regs[REG_INT_STATUS] |= INT_STATUS_FIFO_OFLOW;
+    }
+    sim_regs[REG_FIFO_COUNTH] = (uint8_t)(sim_fifo_count >> 8);
+    sim_regs[REG_FIFO_COUNTL] = (uint8_t)sim_fifo_count;
+
+    return accepted;
+}
+
+void mpu6050_sim_set_raw(const int16_t accel[3], int16_t temp, const int16_t gyro[3])
+{
+    sim_ensure_ready();
+
+    for (int i = 0; i < 3; i++)
+    {
+        sim_store_be16((uint8_t)(REG_ACCEL_XOUT_H + 2 * i), accel[i]);
+        sim_store_be16((uint8_t)(REG_ACCEL_XOUT_H + 8 + 2 * i), gyro[i]);
+    }
+    sim_store_be16(REG_ACCEL_XOUT_H + 6, temp);
+
+    // EXT_SYNC_SET: the latched FSYNC level replaces the LSB of one output
+    static const uint8_t sync_reg[8] = {0, 0x42, 0x44, 0x46, 0x48, 0x3C, 0x3E, 0x40};
+    const uint8_t sync = (sim_regs[REG_CONFIG] >> 3) & 0x07;
+    if (sync != 0)
+    {
+        sim_regs[sync_reg[sync]] = (uint8_t)((sim_regs[sync_reg[sync]] & 0xFE) | sim_fsync);
+        sim_fsync = 0;
+    }
+    sim_regs[REG_INT_STATUS] |= 0x01;   // data ready
+
+    if ((sim_regs[REG_USER_CTRL] & USER_CTRL_FIFO_EN) == 0)
+    {
+        return;
+    }
+
+    // FIFO order follows the register order of the enabled sources
+    uint8_t en = sim_regs[REG_FIFO_EN];
+    if (en & (1 << 3))
+    {
+        mpu6050_sim_fifo_push(&sim_regs[REG_ACCEL_XOUT_H], 6);
+    }
+    if (en & (1 << 7))
+    {
+        mpu6050_sim_fifo_push(&sim_regs[REG_ACCEL_XOUT_H + 6], 2);
+    }
+    for (int i = 0; i < 3; i++)
+    {
+        if (en & (1 << (6 - i)))
+        {
+            mpu6050_sim_fifo_push(&sim_regs[REG_ACCEL_XOUT_H + 8 + 2 * i], 2);
+        }
+    }
+}
+
+void mpu6050_sim_fsync(void)
+{
+    sim_ensure_ready();
+    sim_fsync = 1;
+}
+
+static uint8_t sim_read_byte(uint8_t reg)
+{
+    if (reg == REG_FIFO_R_W)
+    {
+        if (sim_fifo_count == 0)
+        {
+            return 0xFF;
+        }
+        uint8_t b = sim_fifo[sim_fifo_head];
+        sim_fifo_head = (sim_fifo_head + 1) % MPU6050_SIM_FIFO_SIZE;
+        sim_fifo_count--;
+        sim_regs[REG_FIFO_COUNTH] = (uint8_t)(sim_fifo_count >> 8);
+        sim_regs[REG_FIFO_COUNTL] = (uint8_t)sim_fifo_count;
+        return b;
+    }
+    if (reg == REG_MEM_R_W)
+    {
+        uint16_t addr = (uint16_t)(((sim_regs[REG_BANK_SEL] & 0x07) << 8) | sim_regs[REG_MEM_START_ADDR]);
+        sim_regs[REG_MEM_START_ADDR]++;
+        return sim_dmp_mem[addr];
+    }
+    if (reg == REG_INT_STATUS)
+    {
+        uint8_t status = sim_regs[REG_INT_STATUS];
+        sim_regs[REG_INT_STATUS] = 0;   // cleared on read
+        return status;
+    }
+    return sim_regs[reg];
+}
+
+static void sim_write_byte(uint8_t reg, uint8_t value)
+{
+    switch (reg)
+    {
+        case REG_WHO_AM_I:
+        case REG_INT_STATUS:
+        case REG_FIFO_COUNTH:
+        case REG_FIFO_COUNTL:
+            return;   // read only
+        case REG_FIFO_R_W:
+            mpu6050_sim_fifo_push(&value, 1);
+            return;
+        case REG_MEM_R_W:
+        {
+            uint16_t addr = (uint16_t)(((sim_regs[REG_BANK_SEL] & 0x07) << 8) | sim_regs[REG_MEM_START_ADDR]);
+            sim_regs[REG_MEM_START_ADDR]++;
+            sim_dmp_mem[addr] = value;
+            return;
+        }
+        case REG_PWR_MGMT_1:
+            if (value & PWR_MGMT_1_RESET)
+            {
+                sim_power_on();
+                return;
+            }
+            break;
+        case REG_USER_CTRL:
+            if (value & USER_CTRL_FIFO_RESET)
+            {
+                sim_fifo_head = 0;
+                sim_fifo_count = 0;
+                sim_regs[REG_FIFO_COUNTH] = 0;
+                sim_regs[REG_FIFO_COUNTL] = 0;
+            }
+            value &= (uint8_t)~USER_CTRL_SELF_CLEAR;
+            break;
+        case REG_SIGNAL_PATH_RST:
+            value = 0;
+            break;
+        default:
+            if (reg >= REG_ACCEL_XOUT_H && reg < REG_ACCEL_XOUT_H + 14)
+            {
+                return;   // sensor outputs are read only
+            }
+            break;
+    }
+    sim_regs[reg] = value;
+}
+
+uint8_t mpu6050_sim_read(uint8_t reg, uint8_t *buf, uint16_t len)
+{
+    sim_ensure_ready();
+
+    for (uint16_t i = 0; i < len; i++)
+    {
+        // FIFO and DMP memory windows stream from a single register
+        uint8_t r = (reg == REG_FIFO_R_W || reg == REG_MEM_R_W) ? reg : (uint8_t)(reg + i);
+        if (r >= REG_COUNT)
+        {
+            return 1;
+        }
+        buf[i] = sim_read_byte(r);
+    }
+
+    return 0;
+}
+
+uint8_t mpu6050_sim_write(uint8_t reg, const uint8_t *buf, uint16_t len)
+{
+    sim_ensure_ready();
+
+    for (uint16_t i = 0; i < len; i++)
+    {
+        uint8_t r = (reg == REG_FIFO_R_W || reg == REG_MEM_R_W) ? reg : (uint8_t)(reg + i);
+        if (r >= REG_COUNT)
+        {
+            return 1;
+        }
+        sim_write_byte(r, buf[i]);
+    }
+
+    return 0;
+}
+
+uint8_t mpu6050_sim_peek(uint8_t reg)
+{
+    sim_ensure_ready();
+
+    return (reg < REG_COUNT) ? sim_regs[reg] : 0;
+}
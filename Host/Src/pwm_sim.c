@@ -0,0 +1,52 @@
+/*
+ * pwm_sim.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: halvard
+ *
+ *  Description: host stand-in for the TIM3 PWM output (host build only)
+ *
+ *  Keeps the compare value pwm.c would have written, quantised to the same
+ *  1 us ticks, so pwm_duty() reads back exactly what the target would.
+ */
+
+#include "pwm.h"
+
+static uint32_t pwm_period;
+static uint32_t pwm_compare[PWM_CHANNELS];
+
+int pwm_init(uint32_t freq_hz)
+{
+    if (freq_hz < 16 || freq_hz > 100000)
+    {
+        return 1;
+    }
+
+    pwm_period = PWM_TICK_HZ / freq_hz;
+    for (int ch = 0; ch < PWM_CHANNELS; ch++)
+    {
+        pwm_compare[ch] = 0;
+    }
+    return 0;
+}
+
+void pwm_set(int channel, float duty)
+{
+    if (channel < 0 || channel >= PWM_CHANNELS || pwm_period == 0)
+    {
+        return;
+    }
+
+    duty = (duty < 0.0f) ? 0.0f : ((duty > 1.0f) ? 1.0f : duty);
+    pwm_compare[channel] = (uint32_t)(duty * (float)pwm_period + 0.5f);
+}
+
+float pwm_duty(int channel)
+{
+    if (channel < 0 || channel >= PWM_CHANNELS || pwm_period == 0)
+    {
+        return 0.0f;
+    }
+
+    return (float)pwm_compare[channel] / (float)pwm_period;
+}
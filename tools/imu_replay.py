@@ -0,0 +1,191 @@
+#!/usr/bin/env python3
+"""
+imu_replay.py - create and inspect IMU replay recordings (.imur)
+
+Recordings hold raw MPU6050 register frames (ACCEL_XOUT_H..GYRO_ZOUT_L, 14
+bytes, big endian) behind a 16-byte header; see Core/Inc/imu_replay.h.
+
+Usage:
+    imu_replay.py synth <out.imur> [--frames N] [--rate HZ] [--seed S]
+                        [--accel-range 0-3] [--gyro-range 0-3]
+                        [--broadband G] [--delay SAMPLES] [--am HZ]
+                        [--shock FRAME[:G]]
+    imu_replay.py info <file.imur>
+    imu_replay.py extract <console.log|-> <out.imur>
+
+'synth' produces a deterministic recording (integer LCG, no random module),
+so the same arguments always give the same bytes and the replay checksum
+can be used as a regression value. The file can be played on the host
+(build/imu_replay out.imur) or programmed into the target's replay slot:
+    st-flash write out.imur 0x0801E000
+
+'extract' cuts an event capture (`capture dump`, see Core/Inc/capture.h)
+out of a console log, checks its CRC and writes it as a recording.
+"""
+
+import argparse
+import math
+import re
+import struct
+import sys
+import zlib
+
+MAGIC = b'IMUR'
+VERSION = 1
+FRAME_SIZE = 14
+HEADER = struct.Struct('<4sBBBBHHI')
+SLOT_SIZE = 8 * 1024
+
+ACCEL_LSB = (16384.0, 8192.0, 4096.0, 2048.0)
+GYRO_LSB = (131.0, 65.5, 32.8, 16.4)
+
+
+def clamp16(v):
+    return max(-32768, min(32767, int(round(v))))
+
+
+def synth(args):
+    seed = args.seed & 0xFFFFFFFF
+
+    def noise():
+        nonlocal seed
+        seed = (seed * 1664525 + 1013904223) & 0xFFFFFFFF
+        return (seed >> 16) / 65536.0 - 0.5
+
+    # Broadband vibration (low-passed noise from a second LCG, so the
+    # default recording does not depend on it)
+    bb_seed = (args.seed * 2654435761) & 0xFFFFFFFF
+    bb_state = 0.0
+    broadband = []
+    for i in range(args.frames):
+        bb_seed = (bb_seed * 1664525 + 1013904223) & 0xFFFFFFFF
+        bb_state += 0.5 * (((bb_seed >> 16) / 65536.0 - 0.5) - bb_state)
+        broadband.append(args.broadband * 6.0 * bb_state)
+
+    def vib(i, scale_12hz):
+        t = (i - args.delay) / args.rate
+        j = i - args.delay
+        bb = broadband[j] if 0 <= j < len(broadband) else 0.0
+        if args.am:
+            # Defect-rate amplitude modulation of the carrier
+            scale_12hz *= 1.0 + 0.8 * math.sin(2 * math.pi * args.am * t)
+        return scale_12hz * math.sin(2 * math.pi * 12.0 * t) + bb
+
+    a_lsb = ACCEL_LSB[args.accel_range]
+    g_lsb = GYRO_LSB[args.gyro_range]
+    frames = bytearray()
+    for i in range(args.frames):
+        t = i / args.rate
+        # Gravity on +z with a slow tilt, machine vibration (reaching z
+        # args.delay samples after x), sensor noise
+        tilt = 0.2 * math.sin(2 * math.pi * 0.25 * t)
+        ax = math.sin(tilt) + 0.05 * math.sin(2 * math.pi * 12.0 * t) + (broadband[i] if args.broadband else 0.0) + 0.01 * noise()
+        ay = 0.02 * math.sin(2 * math.pi * 7.0 * t) + 0.01 * noise()
+        az = math.cos(tilt) + vib(i, 0.03) + 0.01 * noise()
+        gx = 2.0 * math.sin(2 * math.pi * 3.0 * t) + 0.2 * noise()
+        gy = 0.2 * 2 * math.pi * 0.25 * math.cos(2 * math.pi * 0.25 * t) * 180 / math.pi + 0.2 * noise()
+        gz = 0.5 + 0.2 * noise()
+        if args.shock is not None:
+            # Half-sine impact on z over 3 samples
+            k = i - args.shock[0] + 1
+            if 0 <= k <= 2:
+                az += args.shock[1] * math.sin(math.pi * (k + 0.5) / 3)
+        temp = clamp16((25.0 - 36.53) * 340.0)
+        frames += struct.pack('>7h',
+                              clamp16(ax * a_lsb), clamp16(ay * a_lsb), clamp16(az * a_lsb),
+                              temp,
+                              clamp16(gx * g_lsb), clamp16(gy * g_lsb), clamp16(gz * g_lsb))
+
+    header = HEADER.pack(MAGIC, VERSION, args.accel_range, args.gyro_range, FRAME_SIZE,
+                         args.rate, 0, args.frames)
+    with open(args.out, 'wb') as f:
+        f.write(header + frames)
+
+    size = len(header) + len(frames)
+    print('%s: %d frames at %d Hz, %d bytes' % (args.out, args.frames, args.rate, size))
+    if size > SLOT_SIZE:
+        print('note: larger than the %d byte target replay slot (host only)' % SLOT_SIZE)
+    return 0
+
+
+def info(args):
+    with open(args.file, 'rb') as f:
+        data = f.read()
+    if len(data) < HEADER.size:
+        print('%s: too short' % args.file, file=sys.stderr)
+        return 1
+    magic, version, a_rng, g_rng, frame_size, rate, _, count = HEADER.unpack_from(data)
+    if magic != MAGIC or version != VERSION or frame_size != FRAME_SIZE:
+        print('%s: not a version %d recording' % (args.file, VERSION), file=sys.stderr)
+        return 1
+    have = (len(data) - HEADER.size) // FRAME_SIZE
+    print('frames      %d (%d present)' % (count, have))
+    print('rate        %d Hz (%.1f s)' % (rate, count / rate if rate else 0.0))
+    print('accel range +-%dg' % (2 << a_rng))
+    print('gyro range  +-%d dps' % (250 << g_rng))
+    return 0 if have >= count else 1
+
+
+def extract(args):
+    data = sys.stdin.buffer.read() if args.log == '-' else open(args.log, 'rb').read()
+    m = re.search(rb'capture: (\d+) bytes\r\n', data)
+    if m is None:
+        print('%s: no capture found' % args.log, file=sys.stderr)
+        return 1
+    size = int(m.group(1))
+    blob = data[m.end():m.end() + size]
+    if len(blob) != size or size < HEADER.size + 4:
+        print('%s: capture truncated (%d of %d bytes)' % (args.log, len(blob), size), file=sys.stderr)
+        return 1
+    image, crc = blob[:-4], struct.unpack('<I', blob[-4:])[0]
+    if zlib.crc32(image) != crc:
+        print('%s: capture CRC mismatch' % args.log, file=sys.stderr)
+        return 1
+    with open(args.out, 'wb') as f:
+        f.write(image)
+    count = HEADER.unpack_from(image)[7]
+    print('%s: %d frames, crc %08x ok' % (args.out, count, crc))
+    return 0
+
+
+def shock(arg):
+    frame, _, peak = arg.partition(':')
+    return int(frame), float(peak) if peak else 6.0
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    sub = ap.add_subparsers(dest='cmd', required=True)
+
+    s = sub.add_parser('synth', help='write a deterministic synthetic recording')
+    s.add_argument('out')
+    s.add_argument('--frames', type=int, default=500)
+    s.add_argument('--rate', type=int, default=100)
+    s.add_argument('--seed', type=int, default=1)
+    s.add_argument('--accel-range', type=int, choices=range(4), default=0)
+    s.add_argument('--gyro-range', type=int, choices=range(4), default=3)
+    s.add_argument('--broadband', type=float, default=0.0,
+                   help='rms [g] of broadband vibration shared by x and z')
+    s.add_argument('--delay', type=int, default=0,
+                   help='samples by which the vibration reaches z after x')
+    s.add_argument('--am', type=float, default=0.0,
+                   help='amplitude modulation [Hz] of the 12 Hz vibration on z')
+    s.add_argument('--shock', type=shock, default=None,
+                   help='half-sine impact on z peaking at FRAME, G [g] (default 6)')
+    s.set_defaults(func=synth)
+
+    i = sub.add_parser('info', help='print the header of a recording')
+    i.add_argument('file')
+    i.set_defaults(func=info)
+
+    e = sub.add_parser('extract', help='cut an event capture out of a console log')
+    e.add_argument('log', help="console output, '-' for stdin")
+    e.add_argument('out')
+    e.set_defaults(func=extract)
+
+    args = ap.parse_args()
+    return args.func(args)
+
+
+if __name__ == '__main__':
+    sys.exit(main())
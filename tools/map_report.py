@@ -0,0 +1,312 @@
+#!/usr/bin/env python3
+"""
+map_report.py - RAM/flash usage report and budget check from a GNU ld map file
+
+Parses the map file produced when linking with STM32F103RBTX_FLASH.ld and
+prints usage per memory region, output section, module (object file), module
+group and per named buffer. Budgets are read from a plain text file (see
+mem_budget.cfg); the script exits non-zero when any budget is exceeded, so it
+can run as a post-build step and fail the build.
+
+Usage:
+    map_report.py <file.map> [--budget mem_budget.cfg] [--top N] [--min-symbol BYTES]
+"""
+
+import argparse
+import os
+import re
+import sys
+from collections import defaultdict
+
+RE_REGION = re.compile(r'^(\S+)\s+0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+)(?:\s+(\S+))?\s*$')
+RE_OUT_FULL = re.compile(r'^(\.\S+|COMMON)\s+0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+)(?:\s+load address 0x([0-9a-fA-F]+))?')
+RE_OUT_NAME = re.compile(r'^(\.\S+)\s*$')
+RE_IN_FULL = re.compile(r'^ (\.\S+|COMMON|\*fill\*)\s+0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+)(?:\s+(\S.*))?$')
+RE_IN_NAME = re.compile(r'^ (\.\S+|COMMON)\s*$')
+RE_CONT = re.compile(r'^\s+0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+)(?:\s+load address 0x([0-9a-fA-F]+))?(?:\s+(\S.*))?$')
+RE_SYMBOL = re.compile(r'^\s+0x([0-9a-fA-F]+)\s+([A-Za-z_][A-Za-z0-9_$.]*)\s*$')
+
+# Input section prefixes that carry the symbol name (-ffunction/-fdata-sections
+# and the mem_sections.h placement macros)
+SYMBOL_SECTION_PREFIXES = ('.text.', '.rodata.', '.data.', '.bss.',
+                           '.ram_buffers.', '.scratch.', '.RamFunc.')
+
+CMSIS_TABLE_MODULES = ('arm_common_tables', 'arm_const_structs', 'arm_mve_tables')
+
+
+class Region:
+    def __init__(self, name, origin, length):
+        self.name = name
+        self.origin = origin
+        self.length = length
+
+    def contains(self, addr):
+        return self.origin <= addr < self.origin + self.length
+
+
+class InputSection:
+    def __init__(self, out_name, name, addr, size, path):
+        self.out_name = out_name
+        self.name = name
+        self.addr = addr
+        self.size = size
+        self.path = path
+        self.symbols = []
+
+
+def module_of(path):
+    """Short module name for an object path or archive member."""
+    if path is None:
+        return '(linker)'
+    path = path.strip()
+    m = re.match(r'^(.*?)\((.*)\)$', path)
+    if m:
+        return os.path.basename(m.group(1))
+    base = os.path.basename(path)
+    return os.path.splitext(base)[0]
+
+
+def group_of(path):
+    """Coarse grouping used for the summary and for 'group' budgets."""
+    if path is None:
+        return 'linker'
+    p = path.replace('\\', '/')
+    mod = module_of(path)
+    if '.a(' in p or p.endswith('.a'):
+        return 'libs'
+    if mod in CMSIS_TABLE_MODULES:
+        return 'cmsis-tables'
+    if '/CMSIS/DSP/' in p:
+        return 'cmsis-dsp'
+    if '/STM32F1xx_HAL_Driver/' in p:
+        return 'hal'
+    if '/Startup/' in p or mod.startswith('system_stm32'):
+        return 'startup'
+    if '/Core/' in p or p.startswith('Core/'):
+        return 'core'
+    if '/Host/' in p:
+        return 'host'
+    return 'other'
+
+
+def parse_map(lines):
+    regions = []
+    outputs = []          # (name, addr, size, lma)
+    inputs = []
+
+    # Memory Configuration table
+    i = 0
+    while i < len(lines) and not lines[i].startswith('Memory Configuration'):
+        i += 1
+    i += 1
+    while i < len(lines) and not lines[i].startswith('Linker script and memory map'):
+        m = RE_REGION.match(lines[i])
+        if m and m.group(1) not in ('Name', '*default*'):
+            regions.append(Region(m.group(1), int(m.group(2), 16), int(m.group(3), 16)))
+        i += 1
+
+    current_out = None
+    pending_out = None
+    pending_in = None
+    last_input = None
+
+    for line in lines[i:]:
+        line = line.rstrip('\n')
+
+        if pending_out is not None:
+            m = RE_CONT.match(line)
+            if m:
+                lma = int(m.group(3), 16) if m.group(3) else None
+                outputs.append((pending_out, int(m.group(1), 16), int(m.group(2), 16), lma))
+                current_out = pending_out
+            pending_out = None
+            continue
+
+        if pending_in is not None:
+            m = RE_CONT.match(line)
+            pending_name = pending_in
+            pending_in = None
+            if m and current_out is not None:
+                last_input = InputSection(current_out, pending_name, int(m.group(1), 16),
+                                          int(m.group(2), 16), m.group(4))
+                inputs.append(last_input)
+                continue
+
+        if line.startswith('.') or line.startswith('COMMON'):
+            m = RE_OUT_FULL.match(line)
+            if m:
+                lma = int(m.group(4), 16) if m.group(4) else None
+                outputs.append((m.group(1), int(m.group(2), 16), int(m.group(3), 16), lma))
+                current_out = m.group(1)
+                last_input = None
+                continue
+            m = RE_OUT_NAME.match(line)
+            if m:
+                pending_out = m.group(1)
+                continue
+            current_out = None
+            continue
+
+        if line.startswith(' ') and not line.startswith('  ') and current_out is not None:
+            m = RE_IN_FULL.match(line)
+            if m:
+                if m.group(1) == '*fill*':
+                    last_input = InputSection(current_out, '*fill*', int(m.group(2), 16),
+                                              int(m.group(3), 16), None)
+                else:
+                    last_input = InputSection(current_out, m.group(1), int(m.group(2), 16),
+                                              int(m.group(3), 16), m.group(4))
+                inputs.append(last_input)
+                continue
+            m = RE_IN_NAME.match(line)
+            if m:
+                pending_in = m.group(1)
+                continue
+
+        m = RE_SYMBOL.match(line)
+        if m and last_input is not None:
+            last_input.symbols.append((int(m.group(1), 16), m.group(2)))
+
+    return regions, outputs, inputs
+
+
+def region_for(regions, addr):
+    for r in regions:
+        if r.contains(addr):
+            return r.name
+    return None
+
+
+def symbol_name(sec):
+    for prefix in SYMBOL_SECTION_PREFIXES:
+        if sec.name.startswith(prefix):
+            return sec.name[len(prefix):]
+    if len(sec.symbols) == 1:
+        return sec.symbols[0][1]
+    return None
+
+
+def load_budgets(path):
+    budgets = []
+    with open(path) as f:
+        for lineno, line in enumerate(f, 1):
+            line = line.split('#', 1)[0].strip()
+            if not line:
+                continue
+            parts = line.split()
+            if len(parts) != 3:
+                raise ValueError('%s:%d: expected "<kind> <name> <bytes>"' % (path, lineno))
+            kind, name, limit = parts
+            if kind not in ('region', 'section', 'group', 'module', 'symbol'):
+                raise ValueError('%s:%d: unknown kind "%s"' % (path, lineno, kind))
+            budgets.append((kind, name, int(limit, 0)))
+    return budgets
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument('map')
+    ap.add_argument('--budget', help='budget file, exit 1 if any entry is exceeded')
+    ap.add_argument('--top', type=int, default=15, help='modules shown per region (default 15)')
+    ap.add_argument('--min-symbol', type=int, default=128,
+                    help='list named buffers/functions at least this big (default 128)')
+    args = ap.parse_args()
+
+    with open(args.map, errors='replace') as f:
+        lines = f.readlines()
+    regions, outputs, inputs = parse_map(lines)
+    if not regions or not outputs:
+        print('map_report: %s does not look like a GNU ld map file' % args.map, file=sys.stderr)
+        return 2
+
+    # Usage per region. Sections with a load address also occupy flash.
+    region_used = defaultdict(int)
+    section_size = {}
+    section_regions = {}
+    for name, addr, size, lma in outputs:
+        r = region_for(regions, addr)
+        if r is None or size == 0:
+            continue
+        section_size[name] = section_size.get(name, 0) + size
+        regs = [r]
+        region_used[r] += size
+        if lma is not None and lma != addr:
+            lr = region_for(regions, lma)
+            if lr is not None and lr != r:
+                region_used[lr] += size
+                regs.append(lr)
+        section_regions[name] = regs
+
+    module_usage = defaultdict(lambda: defaultdict(int))
+    group_usage = defaultdict(lambda: defaultdict(int))
+    symbols = defaultdict(int)
+    symbol_region = {}
+    for sec in inputs:
+        if sec.size == 0:
+            continue
+        for r in section_regions.get(sec.out_name, []):
+            module_usage[r][module_of(sec.path)] += sec.size
+            group_usage[r][group_of(sec.path)] += sec.size
+        name = symbol_name(sec)
+        if name is not None:
+            symbols[name] += sec.size
+            symbol_region[name] = region_for(regions, sec.addr)
+
+    print('=== Memory regions ===')
+    for r in regions:
+        used = region_used.get(r.name, 0)
+        pct = 100.0 * used / r.length if r.length else 0.0
+        print('%-8s %8d / %8d bytes  %5.1f%%' % (r.name, used, r.length, pct))
+
+    print('\n=== Output sections ===')
+    for name, addr, size, lma in outputs:
+        if size == 0 or name not in section_regions:
+            continue
+        print('%-20s 0x%08x %8d  %s' % (name, addr, size, '+'.join(section_regions[name])))
+
+    for r in regions:
+        if r.name not in group_usage:
+            continue
+        print('\n=== %s by group ===' % r.name)
+        for g, size in sorted(group_usage[r.name].items(), key=lambda kv: -kv[1]):
+            print('%-20s %8d' % (g, size))
+        print('\n=== %s top %d modules ===' % (r.name, args.top))
+        ranked = sorted(module_usage[r.name].items(), key=lambda kv: -kv[1])
+        for mod, size in ranked[:args.top]:
+            print('%-32s %8d' % (mod, size))
+
+    print('\n=== Symbols >= %d bytes ===' % args.min_symbol)
+    for name, size in sorted(symbols.items(), key=lambda kv: -kv[1]):
+        if size < args.min_symbol:
+            break
+        print('%-40s %8d  %s' % (name, size, symbol_region.get(name) or '?'))
+
+    if not args.budget:
+        return 0
+
+    failures = 0
+    print('\n=== Budgets (%s) ===' % args.budget)
+    for kind, name, limit in load_budgets(args.budget):
+        if kind == 'region':
+            used = region_used.get(name, 0)
+        elif kind == 'section':
+            used = section_size.get(name, 0)
+        elif kind in ('group', 'module'):
+            # "RAM:cli" limits one region, plain "cli" sums all of them
+            usage = group_usage if kind == 'group' else module_usage
+            region, _, key = name.rpartition(':')
+            used = sum(usage[r].get(key, 0) for r in usage if not region or r == region)
+        else:
+            used = symbols.get(name, 0)
+        ok = used <= limit
+        failures += 0 if ok else 1
+        print('%-4s %-8s %-28s %8d / %8d' % ('ok' if ok else 'FAIL', kind, name, used, limit))
+
+    if failures:
+        print('\nmap_report: %d budget(s) exceeded' % failures, file=sys.stderr)
+        return 1
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,241 @@
+#!/usr/bin/env python3
+"""
+timesync.py - sync the device clock to the host over the console UART
+
+Runs NTP-style exchanges with the `sync` command (see Core/Inc/timesync.h)
+against the host's monotonic clock, then checks the result end to end:
+
+  - host side, the same clock filter and offset/skew fit as the device, so
+    the two estimates can be compared;
+  - the device's own estimate (`sync` summary);
+  - imulog lines, which the device stamps with the host time of each read
+    once locked: their age on arrival must be small and never negative
+    beyond the sync precision.
+
+Usage:
+    timesync.py <port> [--baud 115200] [options]
+    timesync.py [options] --exec <cmd> [args...]
+
+'--exec' runs the command on a pty, as a stand-in for the serial port:
+    HOST_CLOCK_PPM=500 timesync.py --exec build/f103rb_host
+makes the host build's clock 500 ppm fast, which the skew must show
+(--expect-skew 500).
+
+On a real port the serialisation time of the request (after t1) and of the
+reply (before t4) is taken out at --baud, so only the turnaround and driver
+latencies are left in the delay. Exits 0 if the device locked and every
+check passed.
+"""
+
+import argparse
+import os
+import re
+import select
+import struct
+import subprocess
+import sys
+import termios
+import time
+import tty
+import zlib
+
+FRAME = struct.Struct('<QQQI')      # t1, t2, t3, crc32 over the three
+WINDOW = 32                         # TIMESYNC_WINDOW
+
+
+def now_us():
+    return time.monotonic_ns() // 1000
+
+
+class Link:
+    """Byte stream to the device, with the host time each chunk arrived."""
+
+    def __init__(self, fd, proc=None):
+        self.fd = fd
+        self.proc = proc
+        self.buf = b''
+
+    @classmethod
+    def serial(cls, port, baud):
+        fd = os.open(port, os.O_RDWR | os.O_NOCTTY)
+        tty.setraw(fd)
+        attrs = termios.tcgetattr(fd)
+        speed = getattr(termios, 'B%d' % baud)
+        attrs[4] = attrs[5] = speed
+        termios.tcsetattr(fd, termios.TCSANOW, attrs)
+        return cls(fd)
+
+    @classmethod
+    def spawn(cls, cmd):
+        master, slave = os.openpty()
+        tty.setraw(slave)
+        proc = subprocess.Popen(cmd, stdin=slave, stdout=slave, close_fds=True)
+        os.close(slave)
+        return cls(master, proc)
+
+    def write(self, data):
+        os.write(self.fd, data)
+
+    def expect(self, pattern, extra=0, timeout=2.0):
+        """
+        Reads until pattern matches and extra more bytes follow it.
+        Returns (match, extra bytes, host time of the last chunk) or None.
+        """
+        deadline = time.monotonic() + timeout
+        arrived = now_us()
+        while True:
+            m = re.search(pattern, self.buf)
+            if m is not None and len(self.buf) >= m.end() + extra:
+                tail = self.buf[m.end():m.end() + extra]
+                self.buf = self.buf[m.end() + extra:]
+                return m, tail, arrived
+            left = deadline - time.monotonic()
+            if left <= 0 or not select.select([self.fd], [], [], left)[0]:
+                return None
+            try:
+                chunk = os.read(self.fd, 4096)
+            except OSError:
+                return None
+            arrived = now_us()
+            if not chunk:
+                return None
+            self.buf += chunk
+
+    def close(self):
+        if self.proc is not None:
+            self.proc.terminate()
+            self.proc.wait()
+        os.close(self.fd)
+
+
+def fit(exchanges, gate):
+    """
+    Offset at the newest exchange, skew, rms and exchanges used, as
+    timesync_fit() computes them over the last WINDOW exchanges.
+    """
+    window = exchanges[-WINDOW:]
+    dmin = min(e[2] for e in window)
+    used = [e for e in window if e[2] <= dmin + gate]
+    at0, off0 = exchanges[-1][0], exchanges[-1][1]
+    xs = [e[0] - at0 for e in used]
+    ys = [e[1] - off0 for e in used]
+    mx, my = sum(xs) / len(xs), sum(ys) / len(ys)
+    vxx = sum((x - mx) ** 2 for x in xs)
+    skew = sum((x - mx) * (y - my) for x, y in zip(xs, ys)) / vxx if len(used) >= 2 and vxx > 1.0 else 0.0
+    at_newest = my - skew * mx
+    rms = (sum((y - at_newest - skew * x) ** 2 for x, y in zip(xs, ys)) / len(used)) ** 0.5
+    return off0 + at_newest, skew, rms, len(used), dmin
+
+
+def run(args, link):
+    char_us = 10e6 / args.baud if args.baud else 0.0
+
+    link.write(b'\r\nset imulog 0\r\nset syncgate %d\r\nsync reset\r\n' % args.gate)
+    if link.expect(rb'SYNC reset\r\n', timeout=5.0) is None:
+        print('no answer to "sync reset"', file=sys.stderr)
+        return 1
+
+    exchanges = []
+    t4 = None
+    for seq in range(1, args.exchanges + 1):
+        line = b'sync %d %d' % (seq, now_us()) + (b' %d' % t4 if t4 is not None else b'') + b'\r\n'
+        # t1 is when the last byte is out, which the device is waiting for
+        t1 = now_us() + int(len(line) * char_us)
+        line = b'sync %d %d' % (seq, t1) + (b' %d' % t4 if t4 is not None else b'') + b'\r\n'
+        link.write(line)
+
+        r = link.expect(rb'sync %d: 24 bytes\r\n' % seq, FRAME.size)
+        if r is None:
+            print('no reply to sync %d' % seq, file=sys.stderr)
+            return 1
+        m, tail, arrived = r
+        echo1, t2, t3, crc = FRAME.unpack(tail)
+        if zlib.crc32(tail[:24]) != crc or echo1 != t1:
+            print('sync %d: bad frame' % seq, file=sys.stderr)
+            t4 = None
+            continue
+        # ... and t4 when the first byte of the reply came in
+        t4 = arrived - int((len(m.group(0)) + FRAME.size) * char_us)
+        offset = int(((t2 - t1) + (t3 - t4)) / 2)     # truncated, as on the device
+        delay = (t4 - t1) - (t3 - t2)
+        exchanges.append(((t2 + t3) // 2, offset, max(delay, 0)))
+        time.sleep(args.interval)
+
+    # The device has seen every t4 but the last
+    offset, skew, rms, used, dmin = fit(exchanges[:-1], args.gate)
+    delays = sorted(e[2] for e in exchanges)
+    print('%d exchanges, delay min %d us median %d us max %d us'
+          % (len(exchanges), delays[0], delays[len(delays) // 2], delays[-1]))
+    print('host:   offset %d us, skew %+.1f ppm, rms %.1f us, %d in the gate'
+          % (offset, skew * 1e6, rms, used))
+
+    link.write(b'sync\r\n')
+    r = link.expect(rb'SYNC (\w+), (\d+) exchanges.*\r\noffset (-?\d+) us, skew ([-+][0-9.]+) ppm, '
+                    rb'rms ([0-9.]+) us\r\n')
+    if r is None:
+        print('no sync summary', file=sys.stderr)
+        return 1
+    m = r[0]
+    locked = m.group(1) == b'locked'
+    d_skew, d_rms = float(m.group(4)), float(m.group(5))
+    print('device: offset %d us, skew %+.1f ppm, rms %.1f us, %s after %d exchanges'
+          % (int(m.group(3)), d_skew, d_rms, m.group(1).decode(), int(m.group(2))))
+
+    # Half the smallest round trip bounds the asymmetry error, plus the
+    # scatter of the fit
+    precision = dmin / 2 + 2 * rms
+    print('precision +-%.0f us' % precision)
+
+    ok = locked and abs(d_skew - skew * 1e6) < 1.0
+    if args.expect_skew is not None:
+        ok = ok and abs(d_skew - args.expect_skew) <= args.skew_tolerance
+
+    if args.telemetry > 0 and locked:
+        link.write(b'set imulog 1\r\n')
+        ages = []
+        while len(ages) < args.telemetry:
+            r = link.expect(rb'@(\d+) [^\r]*\r\n')
+            if r is None:
+                break
+            ages.append(r[2] - int(r[0].group(1)))
+        link.write(b'set imulog 0\r\n')
+        if ages:
+            print('telemetry: %d samples stamped in host time, age %d..%d us'
+                  % (len(ages), min(ages), max(ages)))
+        ok = ok and len(ages) == args.telemetry and min(ages) >= -precision and max(ages) <= args.max_age
+
+    print('sync ok' if ok else 'sync FAILED')
+    return 0 if ok else 1
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument('port', nargs='?', help='serial device of the console UART')
+    ap.add_argument('--baud', type=int, default=115200, help='port speed, 0 for no serialisation correction')
+    ap.add_argument('--exchanges', type=int, default=40)
+    ap.add_argument('--interval', type=float, default=0.05, help='seconds between exchanges')
+    ap.add_argument('--gate', type=int, default=200, help='syncgate, us')
+    ap.add_argument('--telemetry', type=int, default=20, help='imulog lines to check, 0 skips')
+    ap.add_argument('--max-age', type=int, default=20000, help='us a stamped sample may take to arrive')
+    ap.add_argument('--expect-skew', type=float, default=None, help='ppm the device clock is known to be off')
+    ap.add_argument('--skew-tolerance', type=float, default=100.0, help='ppm')
+    ap.add_argument('--exec', nargs=argparse.REMAINDER, dest='cmd', help='run the device on a pty instead')
+    args = ap.parse_args()
+
+    if args.cmd:
+        # A pty has no line rate
+        args.baud = 0
+        link = Link.spawn(args.cmd)
+    elif args.port:
+        link = Link.serial(args.port, args.baud)
+    else:
+        ap.error('need a port or --exec')
+
+    try:
+        return run(args, link)
+    finally:
+        link.close()
+
+
+if __name__ == '__main__':
+    sys.exit(main())